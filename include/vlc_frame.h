@@ -594,6 +594,16 @@ static inline vlc_frame_t *vlc_frame_ChainGather( vlc_frame_t *p_list )
  */
 VLC_API vlc_fifo_t *vlc_fifo_New(void) VLC_USED VLC_MALLOC;
 
+/**
+ * Creates a FIFO queue of blocks with a lock-free input.
+ *
+ * This is a vlc_fifo_New() FIFO, where one producer thread at a time can
+ * also queue blocks with vlc_fifo_TryQueue() without taking the lock.
+ *
+ * @return the FIFO or NULL on memory error
+ */
+VLC_API vlc_fifo_t *vlc_fifo_NewSPSC(void) VLC_USED VLC_MALLOC;
+
 /**
  * Delete a FIFO created by vlc_fifo_New().
  *
@@ -710,6 +720,27 @@ static inline void vlc_fifo_WaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar)
  */
 VLC_API void vlc_fifo_QueueUnlocked(vlc_fifo_t *fifo, vlc_frame_t *block);
 
+/**
+ * Queues a block without locking the FIFO.
+ *
+ * The block is appended to the lock-free ring of a FIFO created with
+ * vlc_fifo_NewSPSC(). It is accounted for immediately and is moved to the
+ * queue by the next consumer holding the lock. A consumer waiting after
+ * vlc_fifo_DequeueUnlocked() returned NULL is woken up, other consumers
+ * are not signaled.
+ *
+ * Only one thread may call this function at a time.
+ *
+ * @param fifo queue created with vlc_fifo_NewSPSC()
+ * @param block a single block (not a chain)
+ * @param max_bytes size the queue must not exceed with this block
+ * @retval true if the block was queued
+ * @retval false if the ring is full, the size limit would be exceeded or
+ * the FIFO has no ring, the block is left to the caller
+ */
+VLC_API bool vlc_fifo_TryQueue(vlc_fifo_t *fifo, vlc_frame_t *block,
+                               size_t max_bytes) VLC_USED;
+
 /**
  * Dequeues the first block from a locked FIFO, if any.
  *
@@ -791,10 +822,10 @@ VLC_API bool vlc_fifo_Held(const vlc_fifo_t *fifo) VLC_USED;
  */
 #define vlc_fifo_Assert(fifo) assert(vlc_fifo_Held(fifo))
 
-VLC_USED static inline bool vlc_fifo_IsEmpty(const vlc_fifo_t *fifo)
-{
-    return vlc_queue_IsEmpty(vlc_fifo_queue(fifo));
-}
+/**
+ * Checks whether a FIFO is empty, including its lock-free ring.
+ */
+VLC_API bool vlc_fifo_IsEmpty(const vlc_fifo_t *fifo) VLC_USED;
 
 static inline void vlc_fifo_Cleanup(void *fifo)
 {
@@ -159,12 +159,27 @@ VLC_API void vlc_tracer_Destroy(struct vlc_tracer *tracer);
 
 VLC_API void vlc_tracer_TraceWithTs(struct vlc_tracer *tracer, vlc_tick_t ts,
                                     const struct vlc_tracer_trace *trace);
+#ifndef __cplusplus
 #define vlc_tracer_TraceWithTs(tracer, ts, ...) \
     (vlc_tracer_TraceWithTs)(tracer, ts, &(const struct vlc_tracer_trace) { \
         .entries = (const struct vlc_tracer_entry[]) { \
             __VA_ARGS__ \
         } \
     })
+#else
+/* No compound literals in C++ */
+template <typename... Entries>
+static inline void vlc_tracer_TraceEntriesWithTs(struct vlc_tracer *tracer,
+                                                 vlc_tick_t ts,
+                                                 Entries... entries)
+{
+    const struct vlc_tracer_entry array[] = { entries... };
+    const struct vlc_tracer_trace trace = { array };
+    (vlc_tracer_TraceWithTs)(tracer, ts, &trace);
+}
+#define vlc_tracer_TraceWithTs(tracer, ts, ...) \
+    vlc_tracer_TraceEntriesWithTs(tracer, ts, __VA_ARGS__)
+#endif
 
 #define vlc_tracer_Trace(tracer, ...) \
     vlc_tracer_TraceWithTs(tracer, vlc_tick_now(), __VA_ARGS__)
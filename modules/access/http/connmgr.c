@@ -25,6 +25,7 @@
 #include <assert.h>
 #include <vlc_common.h>
 #include <vlc_network.h>
+#include <vlc_threads.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
 #include "transport.h"
@@ -103,6 +104,8 @@ struct vlc_http_mgr
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
     struct vlc_http_conn *conn;
+    bool multiplexed; /**< Whether conn carries concurrent streams */
+    vlc_mutex_t lock;
 };
 
 static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
@@ -117,36 +120,49 @@ static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
 {
     assert(mgr->conn == conn);
     mgr->conn = NULL;
+    mgr->multiplexed = false;
 
     vlc_http_conn_release(conn);
 }
 
+static void vlc_http_mgr_set(struct vlc_http_mgr *mgr,
+                             struct vlc_http_conn *conn, bool multiplexed)
+{
+    if (mgr->conn != NULL)
+        vlc_http_mgr_release(mgr, mgr->conn);
+
+    mgr->conn = conn;
+    mgr->multiplexed = multiplexed;
+}
+
 static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
-                                        const char *host, unsigned port,
-                                        const struct vlc_http_msg *req,
-                                        bool payload)
+struct vlc_http_stream *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
+                                           const char *host, unsigned port,
+                                           const struct vlc_http_msg *req,
+                                           bool payload,
+                                           struct vlc_http_conn **restrict connp)
 {
     struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
     if (conn == NULL)
         return NULL;
 
     struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
-    if (stream != NULL)
-    {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
+    if (stream == NULL)
+    {   /* Get rid of closing or reset connection */
+        vlc_http_mgr_release(mgr, conn);
+        return NULL;
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
-    return NULL;
+
+    *connp = conn;
+    return stream;
 }
 
-static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
-                                              const char *host, unsigned port,
-                                              const struct vlc_http_msg *req,
-                                              bool idempotent, bool payload)
+static struct vlc_http_stream *vlc_https_request(struct vlc_http_mgr *mgr,
+                                                 const char *host, unsigned port,
+                                                 const struct vlc_http_msg *req,
+                                                 bool idempotent, bool payload,
+                                                 struct vlc_http_conn **restrict connp,
+                                                 bool *restrict reused)
 {
     vlc_tls_t *tls;
     bool http2 = true;
@@ -167,10 +183,13 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
          * the nonidempotent request was processed if the connection fails
          * before the response is received.
          */
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
-        if (resp != NULL)
-            return resp; /* existing connection reused */
+        struct vlc_http_stream *stream = vlc_http_mgr_reuse(mgr, host, port,
+                                                            req, payload, connp);
+        if (stream != NULL)
+        {
+            *reused = true;
+            return stream; /* existing connection reused */
+        }
     }
 
     char *proxy = vlc_http_proxy_find(host, port, true);
@@ -206,27 +225,30 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    vlc_http_mgr_set(mgr, conn, http2);
+    *reused = false;
+    return vlc_http_mgr_reuse(mgr, host, port, req, payload, connp);
 }
 
-static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
-                                             const char *host, unsigned port,
-                                             const struct vlc_http_msg *req,
-                                             bool idempotent, bool payload)
+static struct vlc_http_stream *vlc_http_request(struct vlc_http_mgr *mgr,
+                                                const char *host, unsigned port,
+                                                const struct vlc_http_msg *req,
+                                                bool idempotent, bool payload,
+                                                struct vlc_http_conn **restrict connp,
+                                                bool *restrict reused)
 {
     if (mgr->creds != NULL && mgr->conn != NULL)
         return NULL; /* switch from HTTPS to HTTP not implemented */
 
     if (idempotent)
     {
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
-        if (resp != NULL)
-            return resp;
+        struct vlc_http_stream *stream = vlc_http_mgr_reuse(mgr, host, port,
+                                                            req, payload, connp);
+        if (stream != NULL)
+        {
+            *reused = true;
+            return stream;
+        }
     }
 
     struct vlc_http_conn *conn;
@@ -256,18 +278,10 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
     if (stream == NULL)
         return NULL;
 
-    struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
-    if (resp == NULL)
-    {
-        vlc_http_conn_release(conn);
-        return NULL;
-    }
-
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
-    return resp;
+    vlc_http_mgr_set(mgr, conn, false);
+    *connp = conn;
+    *reused = false;
+    return stream;
 }
 
 struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
@@ -278,8 +292,44 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     if (port && vlc_http_port_blocked(port))
         return NULL;
 
-    return (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m,
-                                                          idempotent, payload);
+    for (unsigned attempt = 0;; attempt++)
+    {
+        struct vlc_http_conn *conn;
+        bool reused = false;
+
+        vlc_mutex_lock(&mgr->lock);
+        struct vlc_http_stream *stream =
+            (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m,
+                                                           idempotent, payload,
+                                                           &conn, &reused);
+        vlc_mutex_unlock(&mgr->lock);
+
+        if (stream == NULL)
+            return NULL;
+
+        /* Wait for the response without the lock, so that concurrent requests
+         * can share a multiplexed connection. */
+        struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
+        if (resp != NULL)
+            return resp;
+
+        /* Get rid of closing or reset connection */
+        vlc_mutex_lock(&mgr->lock);
+        if (mgr->conn == conn)
+            vlc_http_mgr_release(mgr, conn);
+        vlc_mutex_unlock(&mgr->lock);
+
+        if (!reused || attempt > 0)
+            return NULL; /* otherwise retry once with a new connection */
+    }
+}
+
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *mgr)
+{
+    vlc_mutex_lock(&mgr->lock);
+    bool multiplexed = mgr->multiplexed;
+    vlc_mutex_unlock(&mgr->lock);
+    return multiplexed;
 }
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
@@ -299,6 +349,8 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->creds = NULL;
     mgr->jar = jar;
     mgr->conn = NULL;
+    mgr->multiplexed = false;
+    vlc_mutex_init(&mgr->lock);
     return mgr;
 }
 
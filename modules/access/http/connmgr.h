@@ -57,6 +57,17 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *);
 
+/**
+ * Checks for a multiplexed connection
+ *
+ * The connection manager can be shared by several threads. Concurrent
+ * requests only share a single connection if it is multiplexed (HTTP/2),
+ * otherwise each request replaces the current connection.
+ *
+ * @return true if the current connection is multiplexed
+ */
+bool vlc_http_mgr_is_multiplexed(struct vlc_http_mgr *);
+
 /**
  * Creates an HTTP connection manager
  *
@@ -36,6 +36,7 @@
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
 #include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/HybridAdaptationLogic.hpp"
 #include "logic/BufferingLogic.hpp"
 #include "tools/Debug.hpp"
 #ifdef ADAPTIVE_DEBUGGING_LOGIC
@@ -43,6 +44,7 @@
 #endif
 #include <vlc_stream.h>
 #include <vlc_demux.h>
+#include <vlc_tracer.h>
 #include <vlc_threads.h>
 
 #include <algorithm>
@@ -74,6 +76,8 @@ PlaylistManager::PlaylistManager( demux_t *p_demux_,
     b_preparsing = false;
     nextPlaylistupdate = 0;
     demux.pcr_syncpoint = TimestampSynchronizationPoint::RandomAccess;
+    stall.b_started = false;
+    stall.start = VLC_TICK_INVALID;
     vlc_mutex_init(&demux.lock);
     vlc_cond_init(&demux.cond);
     vlc_mutex_init(&cached.lock);
@@ -126,6 +130,7 @@ bool PlaylistManager::setupPeriod()
                                                          &synchronizationReferences);
             if(!tracker)
                 continue;
+            tracker->setPrefetchCount(var_InheritInteger(p_demux, "adaptive-prefetch"));
 
             AbstractStream *st = streamFactory->create(p_demux, set->getStreamFormat(),
                                                        tracker);
@@ -373,6 +378,13 @@ bool PlaylistManager::setPosition(vlc_tick_t mediatime, double pos, bool accurat
         ret = false;
     }
 
+    /* rebuffering after seek is not a stall */
+    if(ret)
+    {
+        stall.b_started = false;
+        stall.start = VLC_TICK_INVALID;
+    }
+
     if(accurate && ret && streampos.times.continuous >= VLC_TICK_0)
     {
         es_out_Control(p_demux->out, ES_OUT_SET_NEXT_DISPLAY_TIME,
@@ -515,6 +527,14 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
         }
         break;
     case AbstractStream::Status::Buffering:
+        /* ran out of data after playback started */
+        if(stall.b_started && stall.start == VLC_TICK_INVALID)
+        {
+            stall.start = vlc_tick_now();
+            struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(p_demux));
+            if(tracer)
+                vlc_tracer_TraceEvent(tracer, "ADAPTIVE", "demux", "stall_begin");
+        }
         vlc_mutex_lock(&demux.lock);
         vlc_cond_timedwait(&demux.cond, &demux.lock, vlc_tick_now() + VLC_TICK_FROM_MS(50));
         vlc_mutex_unlock(&demux.lock);
@@ -528,6 +548,18 @@ int PlaylistManager::doDemux(vlc_tick_t increment)
         vlc_mutex_unlock(&demux.lock);
         break;
     case AbstractStream::Status::Demuxed:
+        stall.b_started = true;
+        if(stall.start != VLC_TICK_INVALID)
+        {
+            struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(p_demux));
+            if(tracer)
+                vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                         VLC_TRACE("id", "demux"),
+                                         VLC_TRACE("event", "stall_end"),
+                                         VLC_TRACE_TICK_NS("duration", vlc_tick_now() - stall.start),
+                                         VLC_TRACE_END);
+            stall.start = VLC_TICK_INVALID;
+        }
         vlc_mutex_lock(&demux.lock);
         if( demux.times.continuous != VLC_TICK_INVALID && barrier.continuous != demux.times.continuous )
         {
@@ -686,8 +718,14 @@ int PlaylistManager::doControl(int i_query, va_list args)
         }
 
         case DEMUX_GET_PTS_DELAY:
-            *va_arg (args, vlc_tick_t *) = VLC_TICK_FROM_SEC(1);
+        {
+            /* Low latency: don't add more than our own buffering */
+            vlc_tick_t delay = VLC_TICK_FROM_SEC(1);
+            if(bufferingLogic)
+                delay = std::min(delay, bufferingLogic->getMinBuffering(playlist) / 2);
+            *va_arg (args, vlc_tick_t *) = delay;
             break;
+        }
 
         default:
             return VLC_EGENERIC;
@@ -896,6 +934,15 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             logic = noplogic;
             break;
         }
+        case AbstractAdaptationLogic::LogicType::Hybrid:
+        {
+            HybridAdaptationLogic *hybridlogic =
+                    new (std::nothrow) HybridAdaptationLogic(obj);
+            if(hybridlogic)
+                conn->setDownloadRateObserver(hybridlogic);
+            logic = hybridlogic;
+            break;
+        }
         case AbstractAdaptationLogic::LogicType::Predictive:
         {
             AbstractAdaptationLogic *predictivelogic =
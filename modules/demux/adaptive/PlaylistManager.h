@@ -126,6 +126,13 @@ namespace adaptive
                 vlc_cond_t  cond;
             } demux;
 
+            /* playback stalls, demux thread only */
+            struct
+            {
+                bool        b_started;
+                vlc_tick_t  start;
+            } stall;
+
             /* buffering process */
             time_t                               nextPlaylistupdate;
             int                                  failedupdates;
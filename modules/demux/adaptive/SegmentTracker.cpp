@@ -32,6 +32,8 @@
 #include "logic/AbstractAdaptationLogic.h"
 #include "logic/BufferingLogic.hpp"
 
+#include <vlc_tracer.h>
+
 #include <cassert>
 #include <limits>
 
@@ -142,6 +144,9 @@ SegmentTracker::SegmentTracker(SharedResources *res,
     adaptationSet = adaptSet;
     synchronizationReferences = refs;
     format = StreamFormat::Type::Unknown;
+    prefetchCount = 0;
+    bufferingLevel.current = 0;
+    bufferingLevel.maximum = 0;
 }
 
 SegmentTracker::~SegmentTracker()
@@ -264,30 +269,10 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
     }
     else /* continuing, or seek */
     {
-        if(!adaptationSet->isSegmentAligned() || !pos.init_sent || !pos.index_sent)
-            switch_allowed = false;
-
-        if(switch_allowed)
+        if(switch_allowed && isSwitchAllowed(pos))
         {
-            Position temp;
-            temp.rep = logic->getNextRepresentation(adaptationSet, pos.rep);
-            if(temp.rep && temp.rep != pos.rep)
-            {
-                /* Convert our segment number if we need to */
-                temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
-
-                /* Ensure ephemere content is updated/loaded */
-                if(temp.rep->needsUpdate(temp.number))
-                    temp.rep->scheduleNextUpdate(temp.number, temp.rep->runLocalUpdates(resources));
-
-                /* could have been std::numeric_limits<uint64_t>::max() if not found because not avail */
-                if(!temp.isValid()) /* try again */
-                    temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
-
-                /* cancel switch that would go past playlist */
-                if(temp.isValid() && temp.rep->getMinAheadTime(temp.number) == 0)
-                    temp = Position();
-            }
+            Position temp = getSwitchPosition(pos,
+                                logic->getNextRepresentation(adaptationSet, pos.rep));
             if(temp.isValid())
                 pos = temp;
         }
@@ -335,6 +320,73 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
     return ChunkEntry(segmentChunk, pos, startTime, duration, displayTime);
 }
 
+bool SegmentTracker::isSwitchAllowed(const Position &pos) const
+{
+    return adaptationSet->isSegmentAligned() && pos.init_sent && pos.index_sent;
+}
+
+SegmentTracker::Position
+SegmentTracker::getSwitchPosition(const Position &pos, BaseRepresentation *rep) const
+{
+    Position temp;
+    temp.rep = rep;
+    if(temp.rep && temp.rep != pos.rep)
+    {
+        /* Convert our segment number if we need to */
+        temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
+
+        /* Ensure ephemere content is updated/loaded */
+        if(temp.rep->needsUpdate(temp.number))
+            temp.rep->scheduleNextUpdate(temp.number, temp.rep->runLocalUpdates(resources));
+
+        /* could have been std::numeric_limits<uint64_t>::max() if not found because not avail */
+        if(!temp.isValid()) /* try again */
+            temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
+
+        /* cancel switch that would go past playlist */
+        if(temp.isValid() && temp.rep->getMinAheadTime(temp.number) == 0)
+            temp = Position();
+    }
+    return temp;
+}
+
+void SegmentTracker::prefetchChunks()
+{
+    if(!prefetchCount || !next.isValid())
+        return;
+
+    /* The chunk returned to the demuxer is not in the sequence,
+       so we prefetch up to prefetchCount chunks ahead of it */
+    Position pos = next;
+    vlc_tick_t ahead = 0;
+    for(const ChunkEntry &entry : chunkssequence)
+    {
+        ahead += entry.duration;
+        pos = entry.pos;
+        ++pos;
+    }
+
+    while(chunkssequence.size() < prefetchCount)
+    {
+        /* do not download past the buffering limit */
+        if(bufferingLevel.maximum &&
+           bufferingLevel.current + ahead >= bufferingLevel.maximum)
+            break;
+
+        /* Representation is only switched when dequeuing */
+        ChunkEntry entry = prepareChunk(false, pos);
+        if(!entry.isValid())
+        {
+            delete entry.chunk;
+            break;
+        }
+        ahead += entry.duration;
+        pos = entry.pos;
+        ++pos;
+        chunkssequence.push_back(entry);
+    }
+}
+
 void SegmentTracker::resetChunksSequence()
 {
     while(!chunkssequence.empty())
@@ -354,6 +406,18 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed)
         ChunkEntry chunk = prepareChunk(switch_allowed, next);
         chunkssequence.push_back(chunk);
     }
+    else if(switch_allowed && next.isValid() && isSwitchAllowed(next))
+    {
+        /* Prefetched chunks were prepared for the current representation,
+           drop them if the logic wants to switch */
+        Position temp = getSwitchPosition(next,
+                            logic->getNextRepresentation(adaptationSet, next.rep));
+        if(temp.isValid() && temp.rep != chunkssequence.front().pos.rep)
+        {
+            resetChunksSequence();
+            chunkssequence.push_back(prepareChunk(false, temp));
+        }
+    }
 
     ChunkEntry chunk = chunkssequence.front();
     if(!chunk.isValid())
@@ -438,6 +502,8 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed)
     if(!b_gap)
         ++next;
 
+    prefetchChunks();
+
     return returnedChunk;
 }
 
@@ -579,11 +645,18 @@ void SegmentTracker::notifyBufferingState(bool enabled) const
 }
 
 void SegmentTracker::notifyBufferingLevel(vlc_tick_t min, vlc_tick_t max,
-                                          vlc_tick_t current, vlc_tick_t target) const
+                                          vlc_tick_t current, vlc_tick_t target)
 {
+    bufferingLevel.current = current;
+    bufferingLevel.maximum = max;
     notify(BufferingLevelChangedEvent(adaptationSet->getID(), min, max, current, target));
 }
 
+void SegmentTracker::setPrefetchCount(unsigned count)
+{
+    prefetchCount = count;
+}
+
 void SegmentTracker::registerListener(SegmentTrackerListenerInterface *listener)
 {
     listeners.push_back(listener);
@@ -616,7 +689,86 @@ bool SegmentTracker::updateSelected()
 
 void SegmentTracker::notify(const TrackerEvent &event) const
 {
+    trace(event);
     std::list<SegmentTrackerListenerInterface *>::const_iterator it;
     for(it=listeners.begin();it != listeners.end(); ++it)
         (*it)->trackerEvent(event);
 }
+
+void SegmentTracker::trace(const TrackerEvent &event) const
+{
+    BasePlaylist *playlist = adaptationSet ? adaptationSet->getPlaylist() : nullptr;
+    vlc_object_t *p_obj = playlist ? playlist->getVLCObject() : nullptr;
+    struct vlc_tracer *tracer = p_obj ? vlc_object_get_tracer(p_obj) : nullptr;
+    if(!tracer)
+        return;
+
+    const std::string id = adaptationSet->getID().str();
+    switch(event.getType())
+    {
+        case TrackerEvent::Type::RepresentationSwitch:
+        {
+            const RepresentationSwitchEvent &ev =
+                    static_cast<const RepresentationSwitchEvent &>(event);
+            if(!ev.next)
+                break;
+            const std::string prev = ev.prev ? ev.prev->getID().str() : std::string();
+            vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                     VLC_TRACE("id", id.c_str()),
+                                     VLC_TRACE("event", "switch"),
+                                     VLC_TRACE("representation", ev.next->getID().str().c_str()),
+                                     VLC_TRACE("bandwidth", (int64_t) ev.next->getBandwidth()),
+                                     VLC_TRACE("previous", prev.c_str()),
+                                     VLC_TRACE_END);
+            break;
+        }
+        case TrackerEvent::Type::SegmentChange:
+        {
+            const SegmentChangedEvent &ev =
+                    static_cast<const SegmentChangedEvent &>(event);
+            vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                     VLC_TRACE("id", id.c_str()),
+                                     VLC_TRACE("event", "segment"),
+                                     VLC_TRACE("sequence", (int64_t) ev.sequence),
+                                     VLC_TRACE_TICK_NS("start", ev.starttime),
+                                     VLC_TRACE_TICK_NS("duration", ev.duration),
+                                     VLC_TRACE_END);
+            break;
+        }
+        case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &ev =
+                    static_cast<const BufferingLevelChangedEvent &>(event);
+            vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                     VLC_TRACE("id", id.c_str()),
+                                     VLC_TRACE("event", "buffer"),
+                                     VLC_TRACE_TICK_NS("level", ev.current),
+                                     VLC_TRACE_TICK_NS("target", ev.target),
+                                     VLC_TRACE_TICK_NS("min", ev.minimum),
+                                     VLC_TRACE_TICK_NS("max", ev.maximum),
+                                     VLC_TRACE_END);
+            break;
+        }
+        case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &ev =
+                    static_cast<const BufferingStateUpdatedEvent &>(event);
+            vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                     VLC_TRACE("id", id.c_str()),
+                                     VLC_TRACE("event", ev.enabled ? "buffering_on" : "buffering_off"),
+                                     VLC_TRACE_END);
+            break;
+        }
+        case TrackerEvent::Type::Discontinuity:
+            vlc_tracer_TraceEvent(tracer, "ADAPTIVE", id.c_str(), "discontinuity");
+            break;
+        case TrackerEvent::Type::SegmentGap:
+            vlc_tracer_TraceEvent(tracer, "ADAPTIVE", id.c_str(), "gap");
+            break;
+        case TrackerEvent::Type::RepresentationUpdateFailed:
+            vlc_tracer_TraceEvent(tracer, "ADAPTIVE", id.c_str(), "update_failed");
+            break;
+        default:
+            break;
+    }
+}
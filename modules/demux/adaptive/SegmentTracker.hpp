@@ -233,7 +233,8 @@ namespace adaptive
             bool getSynchronizationReference(uint64_t, vlc_tick_t, SynchronizationReference &) const;
             void updateSynchronizationReference(uint64_t, const Times &);
             void notifyBufferingState(bool) const;
-            void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t, vlc_tick_t) const;
+            void notifyBufferingLevel(vlc_tick_t, vlc_tick_t, vlc_tick_t, vlc_tick_t);
+            void setPrefetchCount(unsigned);
             void registerListener(SegmentTrackerListenerInterface *);
             bool updateSelected();
             bool bufferingAvailable() const;
@@ -253,14 +254,24 @@ namespace adaptive
             };
             std::list<ChunkEntry> chunkssequence;
             ChunkEntry prepareChunk(bool switch_allowed, Position pos) const;
+            Position getSwitchPosition(const Position &, BaseRepresentation *) const;
+            bool isSwitchAllowed(const Position &) const;
+            void prefetchChunks();
             void resetChunksSequence();
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
+            void trace(const TrackerEvent &) const;
             bool first;
             bool initializing;
             Position current;
             Position next;
             StreamFormat format;
+            unsigned prefetchCount;
+            struct
+            {
+                vlc_tick_t current;
+                vlc_tick_t maximum;
+            } bufferingLevel;
             SharedResources *resources;
             SynchronizationReferences *synchronizationReferences;
             AbstractAdaptationLogic *logic;
@@ -81,6 +81,23 @@ static void Close   (vlc_object_t *);
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using HTTP access instead of custom HTTP code")
 
+#define ADAPT_MAXDOWNLOADS_TEXT N_("Maximum simultaneous downloads")
+#define ADAPT_MAXDOWNLOADS_LONGTEXT N_("Number of segments that can be downloaded in parallel")
+
+#define ADAPT_MAXHOSTCONNS_TEXT N_("Maximum connections per host")
+#define ADAPT_MAXHOSTCONNS_LONGTEXT N_("Limits parallel segment downloads from a same host (0 for no limit)")
+
+#define ADAPT_RANGESPLIT_TEXT N_("Parallel byte ranges per segment")
+#define ADAPT_RANGESPLIT_LONGTEXT N_("Splits segments of known size into several " \
+                                     "byte ranges downloaded in parallel (1 to disable)")
+
+#define ADAPT_DISKCACHE_TEXT N_("Segments disk cache size (MiB)")
+#define ADAPT_DISKCACHE_LONGTEXT N_("Keeps downloaded segments on disk for later " \
+                                    "playbacks (0 to disable)")
+
+#define ADAPT_PREFETCH_TEXT N_("Segments prefetch")
+#define ADAPT_PREFETCH_LONGTEXT N_("Number of segments requested ahead of the demuxed one")
+
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
@@ -88,6 +105,7 @@ static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::LogicType::Default,
                                 AbstractAdaptationLogic::LogicType::Predictive,
                                 AbstractAdaptationLogic::LogicType::NearOptimal,
+                                AbstractAdaptationLogic::LogicType::Hybrid,
                                 AbstractAdaptationLogic::LogicType::RateBased,
                                 AbstractAdaptationLogic::LogicType::FixedRate,
                                 AbstractAdaptationLogic::LogicType::AlwaysLowest,
@@ -97,6 +115,7 @@ static const char *const ppsz_logics_values[] = {
                                 "",
                                 "predictive",
                                 "nearoptimal",
+                                "hybrid",
                                 "rate",
                                 "fixedrate",
                                 "lowest",
@@ -105,6 +124,7 @@ static const char *const ppsz_logics_values[] = {
 static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Predictive"),
                                            N_("Near Optimal"),
+                                           N_("Buffer and Throughput Hybrid"),
                                            N_("Bandwidth Adaptive"),
                                            N_("Fixed Bandwidth"),
                                            N_("Lowest Bandwidth/Quality"),
@@ -141,6 +161,16 @@ vlc_module_begin ()
         add_integer( "adaptive-maxbuffer",
                      MS_FROM_VLC_TICK(AbstractBufferingLogic::DEFAULT_MAX_BUFFERING),
                      ADAPT_MAXBUFFER_TEXT, nullptr )
+        add_integer_with_range( "adaptive-maxdownloads", 3, 1, 16,
+                     ADAPT_MAXDOWNLOADS_TEXT, ADAPT_MAXDOWNLOADS_LONGTEXT )
+        add_integer_with_range( "adaptive-maxhostconns", 2, 0, 16,
+                     ADAPT_MAXHOSTCONNS_TEXT, ADAPT_MAXHOSTCONNS_LONGTEXT )
+        add_integer_with_range( "adaptive-rangesplit", 1, 1, 16,
+                     ADAPT_RANGESPLIT_TEXT, ADAPT_RANGESPLIT_LONGTEXT )
+        add_integer( "adaptive-diskcache", 0,
+                     ADAPT_DISKCACHE_TEXT, ADAPT_DISKCACHE_LONGTEXT )
+        add_integer_with_range( "adaptive-prefetch", 1, 0, 8,
+                     ADAPT_PREFETCH_TEXT, ADAPT_PREFETCH_LONGTEXT )
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT )
             change_integer_list(rgi_latency, ppsz_latency)
         set_callbacks( Open, Close )
@@ -282,12 +312,12 @@ static PlaylistManager * HandleDash(demux_t *p_demux, DOMParser &xmlParser,
                                     const std::string & playlisturl,
                                     AbstractAdaptationLogic::LogicType logic)
 {
-    if(!xmlParser.reset(p_demux->s) || !xmlParser.parse(true))
+    if(!xmlParser.reset(p_demux->s) || !xmlParser.parse(true, "Period"))
     {
         msg_Err(p_demux, "Cannot parse MPD");
         return nullptr;
     }
-    IsoffMainParser mpdparser(xmlParser.getRootNode(), VLC_OBJECT(p_demux),
+    IsoffMainParser mpdparser(&xmlParser, VLC_OBJECT(p_demux),
                               p_demux->s, playlisturl);
     MPD *p_playlist = mpdparser.parse();
     if(p_playlist == nullptr)
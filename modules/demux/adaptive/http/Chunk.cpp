@@ -32,15 +32,31 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_tracer.h>
 
 #include <algorithm>
 
 using namespace adaptive::http;
 using vlc::threads::mutex_locker;
 
+static const char * ChunkTypeName(ChunkType type)
+{
+    switch(type)
+    {
+        case ChunkType::Segment:  return "segment";
+        case ChunkType::Init:     return "init";
+        case ChunkType::Index:    return "index";
+        case ChunkType::Playlist: return "playlist";
+        case ChunkType::Key:      return "key";
+        default:                  return "unknown";
+    }
+}
+
 AbstractChunkSource::AbstractChunkSource(ChunkType t, const BytesRange &range)
 {
     type = t;
+    priority = (t == ChunkType::Segment) ? ChunkPriority::Normal : ChunkPriority::High;
+    storable = true;
     contentLength = 0;
     requeststatus = RequestStatus::Success;
     bytesRange = range;
@@ -78,6 +94,26 @@ ChunkType AbstractChunkSource::getChunkType() const
     return type;
 }
 
+ChunkPriority AbstractChunkSource::getPriority() const
+{
+    return priority;
+}
+
+void AbstractChunkSource::setPriority(ChunkPriority p)
+{
+    priority = p;
+}
+
+bool AbstractChunkSource::isStorable() const
+{
+    return storable;
+}
+
+void AbstractChunkSource::setStorable(bool b)
+{
+    storable = b;
+}
+
 AbstractChunk::AbstractChunk(AbstractChunkSource *source_)
 {
     bytesRead = 0;
@@ -155,6 +191,7 @@ HTTPChunkSource::HTTPChunkSource(const std::string& url, AbstractConnectionManag
 {
     prepared = false;
     eof = false;
+    ratereport = true;
     sourceid = id;
     setUseAccess(access);
     setIdentifier(url, range);
@@ -240,7 +277,7 @@ block_t * HTTPChunkSource::read(size_t readsize)
             eof = true;
             downloadEndTime = vlc_tick_now();
         }
-        if(ret && connection->getBytesRead() &&
+        if(ret && connection->getBytesRead() && ratereport &&
            downloadEndTime > requestStartTime && type == ChunkType::Segment)
         {
             connManager->updateDownloadRate(sourceid,
@@ -258,6 +295,11 @@ void HTTPChunkSource::recycle()
     delete this;
 }
 
+const ConnectionParams & HTTPChunkSource::getConnectionParams() const
+{
+    return params;
+}
+
 StorageID HTTPChunkSource::makeStorageID(const std::string &s, const BytesRange &r)
 {
     return std::to_string(r.getStartByte())+ std::to_string(r.getEndByte()) + '@' + s;
@@ -386,15 +428,39 @@ void HTTPChunkBufferedSource::release()
 
 void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
+    vlc_object_t *p_obj = connManager->getVLCObject();
+    struct vlc_tracer *tracer = p_obj ? vlc_object_get_tracer(p_obj) : nullptr;
     {
         mutex_locker locker {lock};
+        const bool b_requesting = !prepared;
+        if(b_requesting && tracer)
+            vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                     VLC_TRACE("id", sourceid.str().c_str()),
+                                     VLC_TRACE("event", "request"),
+                                     VLC_TRACE("chunk", ChunkTypeName(type)),
+                                     VLC_TRACE("url", getConnectionParams().getUrl().c_str()),
+                                     VLC_TRACE_END);
         if(!prepare())
         {
             done = true;
             eof = true;
             avail.signal();
+            if(tracer)
+                vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                         VLC_TRACE("id", sourceid.str().c_str()),
+                                         VLC_TRACE("event", "request_failed"),
+                                         VLC_TRACE("chunk", ChunkTypeName(type)),
+                                         VLC_TRACE_END);
             return;
         }
+        if(b_requesting && tracer)
+            vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                     VLC_TRACE("id", sourceid.str().c_str()),
+                                     VLC_TRACE("event", "response"),
+                                     VLC_TRACE("chunk", ChunkTypeName(type)),
+                                     VLC_TRACE_TICK_NS("ttfb", responseTime - requestStartTime),
+                                     VLC_TRACE("length", (int64_t) contentLength),
+                                     VLC_TRACE_END);
 
         if(readsize < HTTPChunkSource::CHUNK_SIZE)
             readsize = HTTPChunkSource::CHUNK_SIZE;
@@ -416,14 +482,29 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t time;
         vlc_tick_t latency;
     } rate = {0,0,0};
+    bool b_complete = false;
+
+    /* Chunked/low latency bodies are produced on the fly,
+     * so hand out data as soon as it arrives */
+    ssize_t ret = connection->readPartial(p_block->p_buffer, readsize);
+    if(ret > 0 && (size_t) ret < readsize / 2)
+    {
+        block_t *p_small = block_Alloc(ret);
+        if(p_small)
+        {
+            memcpy(p_small->p_buffer, p_block->p_buffer, ret);
+            block_Release(p_block);
+            p_block = p_small;
+        }
+    }
 
-    ssize_t ret = connection->read(p_block->p_buffer, readsize);
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = nullptr;
         mutex_locker locker {lock};
         done = true;
+        b_complete = (ret == 0 && buffered && (!contentLength || buffered == contentLength));
         downloadEndTime = vlc_tick_now();
         rate.size = buffered;
         rate.time = downloadEndTime - requestStartTime;
@@ -441,9 +522,10 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
             p_read = p_block;
             inblockreadoffset = 0;
         }
-        if((size_t) ret < readsize)
+        if(contentLength && buffered == contentLength)
         {
             done = true;
+            b_complete = true;
             downloadEndTime = vlc_tick_now();
             rate.size = buffered;
             rate.time = downloadEndTime - requestStartTime;
@@ -452,11 +534,52 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         avail.signal();
     }
 
-    if(rate.size && rate.time && type == ChunkType::Segment)
+    if(rate.size && rate.time && tracer)
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                                 VLC_TRACE("id", sourceid.str().c_str()),
+                                 VLC_TRACE("event", "downloaded"),
+                                 VLC_TRACE("chunk", ChunkTypeName(type)),
+                                 VLC_TRACE("bytes", (int64_t) rate.size),
+                                 VLC_TRACE_TICK_NS("duration", rate.time),
+                                 VLC_TRACE_TICK_NS("ttfb", rate.latency),
+                                 VLC_TRACE("complete", (int64_t) b_complete),
+                                 VLC_TRACE_END);
+
+    if(rate.size && rate.time && ratereport && type == ChunkType::Segment)
     {
         connManager->updateDownloadRate(sourceid, rate.size,
                                         rate.time, rate.latency);
     }
+
+    /* chain is no longer modified once done */
+    if(b_complete)
+        connManager->sourceCompleted(this);
+}
+
+void HTTPChunkBufferedSource::fill(block_t *p_data, const std::string &type)
+{
+    mutex_locker locker {lock};
+    block_ChainProperties(p_data, nullptr, &buffered, nullptr);
+    p_head = p_data;
+    p_read = p_data;
+    pp_tail = &p_head;
+    while(*pp_tail)
+        pp_tail = &(*pp_tail)->p_next;
+    inblockreadoffset = 0;
+    contentLength = buffered;
+    contentType = type;
+    prepared = true;
+    done = true;
+}
+
+std::string HTTPChunkBufferedSource::getContentType() const
+{
+    {
+        mutex_locker locker {lock};
+        if(!connection)
+            return contentType;
+    }
+    return HTTPChunkSource::getContentType();
 }
 
 bool HTTPChunkBufferedSource::hasMoreData() const
@@ -524,7 +647,7 @@ block_t * HTTPChunkBufferedSource::read(size_t readsize)
         copied += toconsume;
         readsize -= toconsume;
         inblockreadoffset += toconsume;
-        if(inblockreadoffset >= p_head->i_buffer)
+        if(inblockreadoffset >= p_read->i_buffer)
         {
             p_read = p_read->p_next;
             inblockreadoffset = 0;
@@ -540,6 +663,173 @@ block_t * HTTPChunkBufferedSource::read(size_t readsize)
     return p_block;
 }
 
+HTTPChunkSplitSource::HTTPChunkSplitSource(const std::string &url,
+                                           AbstractConnectionManager *manager,
+                                           const adaptive::ID &id,
+                                           const BytesRange &range, unsigned count) :
+    AbstractChunkSource(ChunkType::Segment, range),
+    connManager(manager),
+    sourceid(id),
+    current(0),
+    consumed(0),
+    eof(false)
+{
+    storeid = HTTPChunkSource::makeStorageID(url, range);
+    /* BytesRange end is inclusive */
+    contentLength = range.getEndByte() - range.getStartByte() + 1;
+
+    if(count < 1)
+        count = 1;
+    const size_t partsize = contentLength / count;
+    size_t start = range.getStartByte();
+    for(unsigned i=0; i<count; i++)
+    {
+        const size_t end = (i == count - 1) ? range.getEndByte()
+                                            : start + partsize - 1;
+        HTTPChunkBufferedSource *part =
+            new HTTPChunkBufferedSource(url, manager, id, ChunkType::Segment,
+                                        BytesRange(start, end));
+        /* rate and storage are only meaningful for the whole segment */
+        part->ratereport = false;
+        part->setStorable(false);
+        parts.push_back(part);
+        start = end + 1;
+    }
+}
+
+HTTPChunkSplitSource::~HTTPChunkSplitSource()
+{
+    for(HTTPChunkBufferedSource *part : parts)
+        delete part;
+}
+
+std::string HTTPChunkSplitSource::getContentType() const
+{
+    return parts.front()->getContentType();
+}
+
+RequestStatus HTTPChunkSplitSource::getRequestStatus() const
+{
+    for(const HTTPChunkBufferedSource *part : parts)
+    {
+        mutex_locker locker {part->lock};
+        if(part->requeststatus != RequestStatus::Success)
+            return part->requeststatus;
+    }
+    return RequestStatus::Success;
+}
+
+bool HTTPChunkSplitSource::hasMoreData() const
+{
+    return !eof;
+}
+
+size_t HTTPChunkSplitSource::getBytesRead() const
+{
+    return consumed;
+}
+
+void HTTPChunkSplitSource::recycle()
+{
+    delete this;
+}
+
+void HTTPChunkSplitSource::reportRate()
+{
+    size_t size = 0;
+    vlc_tick_t start = VLC_TICK_MAX;
+    vlc_tick_t response = VLC_TICK_MAX;
+    vlc_tick_t end = 0;
+    for(const HTTPChunkBufferedSource *part : parts)
+    {
+        mutex_locker locker {part->lock};
+        if(!part->done || !part->prepared)
+            return;
+        size += part->buffered;
+        start = std::min(start, part->requestStartTime);
+        response = std::min(response, part->responseTime);
+        end = std::max(end, part->downloadEndTime);
+    }
+    if(size && end > start)
+        connManager->updateDownloadRate(sourceid, size, end - start, response - start);
+}
+
+bool HTTPChunkSplitSource::isPartComplete(const HTTPChunkBufferedSource *part) const
+{
+    const BytesRange &range = part->getBytesRange();
+    mutex_locker locker {part->lock};
+    /* BytesRange end is inclusive */
+    return part->done &&
+           part->buffered == range.getEndByte() - range.getStartByte() + 1;
+}
+
+void HTTPChunkSplitSource::nextPart()
+{
+    /* Skipping a failed part would leave a hole in the segment. The
+     * segment ends there instead, as a failed single request does. */
+    if(isPartComplete(parts[current]))
+        current++;
+    else
+        current = parts.size();
+}
+
+block_t * HTTPChunkSplitSource::readBlock()
+{
+    while(current < parts.size())
+    {
+        HTTPChunkBufferedSource *part = parts[current];
+        block_t *p_block = part->readBlock();
+        if(p_block && p_block->i_buffer)
+        {
+            consumed += p_block->i_buffer;
+            return p_block;
+        }
+        if(p_block)
+            block_Release(p_block);
+        if(!p_block || !part->hasMoreData())
+            nextPart();
+    }
+
+    if(eof)
+        return nullptr;
+    eof = true;
+    reportRate();
+    return block_Alloc(0);
+}
+
+block_t * HTTPChunkSplitSource::read(size_t readsize)
+{
+    block_t *p_chain = nullptr;
+    block_t **pp_last = &p_chain;
+    size_t copied = 0;
+
+    while(copied < readsize && current < parts.size())
+    {
+        block_t *p_block = parts[current]->read(readsize - copied);
+        const size_t got = p_block ? p_block->i_buffer : 0;
+        if(got)
+        {
+            copied += got;
+            block_ChainLastAppend(&pp_last, p_block);
+        }
+        else if(p_block)
+        {
+            block_Release(p_block);
+        }
+        if(copied < readsize) /* part has been exhausted */
+            nextPart();
+    }
+
+    consumed += copied;
+    if(current == parts.size() && !eof)
+    {
+        eof = true;
+        reportRate();
+    }
+
+    return p_chain ? block_ChainGather(p_chain) : nullptr;
+}
+
 HTTPChunk::HTTPChunk(const std::string &url, AbstractConnectionManager *manager,
                      const adaptive::ID &id, ChunkType type, const BytesRange &range):
     AbstractChunk(manager->makeSource(url, id, type, range))
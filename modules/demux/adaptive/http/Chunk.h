@@ -27,6 +27,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "BytesRange.hpp"
 #include "ConnectionParams.hpp"
@@ -53,6 +54,13 @@ namespace adaptive
             Key,
         };
 
+        enum class ChunkPriority
+        {
+            High,
+            Normal,
+            Low,
+        };
+
         class ChunkInterface
         {
             public:
@@ -76,6 +84,10 @@ namespace adaptive
                 const BytesRange &  getBytesRange   () const;
                 ChunkType           getChunkType    () const;
                 const StorageID &   getStorageID    () const;
+                ChunkPriority       getPriority     () const;
+                void                setPriority     (ChunkPriority);
+                bool                isStorable      () const;
+                void                setStorable     (bool);
                 std::string getContentType  () const override;
                 RequestStatus getRequestStatus() const override;
                 virtual void        recycle() = 0;
@@ -85,6 +97,8 @@ namespace adaptive
                 virtual ~AbstractChunkSource();
                 StorageID           storeid;
                 ChunkType           type;
+                ChunkPriority       priority;
+                bool                storable; /* can go to the disk cache */
                 RequestStatus       requeststatus;
                 size_t              contentLength;
                 BytesRange          bytesRange;
@@ -118,6 +132,7 @@ namespace adaptive
                                 public BackendPrefInterface
         {
             friend class HTTPConnectionManager;
+            friend class HTTPChunkSplitSource;
 
             public:
                 virtual ~HTTPChunkSource();
@@ -128,6 +143,7 @@ namespace adaptive
                 size_t      getBytesRead    () const  override;
                 std::string getContentType  () const  override;
                 void        recycle() override;
+                const ConnectionParams & getConnectionParams() const;
 
                 static const size_t CHUNK_SIZE = 32768;
                 static StorageID makeStorageID(const std::string &, const BytesRange &);
@@ -145,6 +161,7 @@ namespace adaptive
                 size_t              consumed; /* read pointer */
                 bool                prepared;
                 bool                eof;
+                bool                ratereport;
                 ID                  sourceid;
                 vlc_tick_t          requestStartTime;
                 vlc_tick_t          responseTime;
@@ -158,6 +175,7 @@ namespace adaptive
         class HTTPChunkBufferedSource : public HTTPChunkSource
         {
             friend class HTTPConnectionManager;
+            friend class HTTPChunkSplitSource;
             friend class Downloader;
 
             public:
@@ -165,6 +183,7 @@ namespace adaptive
                 block_t *  readBlock       ()  override;
                 block_t *  read            (size_t)  override;
                 bool       hasMoreData     () const  override;
+                std::string getContentType () const  override;
                 void        recycle() override;
 
             protected:
@@ -172,6 +191,7 @@ namespace adaptive
                                         const ID &, ChunkType, const BytesRange &,
                                         bool = false);
                 void               bufferize(size_t);
+                void               fill(block_t *, const std::string &);
                 bool               isDone() const;
                 void               hold();
                 void               release();
@@ -186,6 +206,41 @@ namespace adaptive
                 bool                eof;
                 vlc::threads::condition_variable avail;
                 bool                held;
+                std::string         contentType; /* when filled from storage */
+        };
+
+        /* Downloads a known size segment as several byte ranges
+         * in parallel and reassembles them in order */
+        class HTTPChunkSplitSource : public AbstractChunkSource
+        {
+            friend class HTTPConnectionManager;
+
+            public:
+                virtual ~HTTPChunkSplitSource();
+                block_t *   readBlock       ()  override;
+                block_t *   read            (size_t)  override;
+                bool        hasMoreData     () const  override;
+                size_t      getBytesRead    () const  override;
+                std::string getContentType  () const  override;
+                RequestStatus getRequestStatus() const override;
+                void        recycle() override;
+
+                static const size_t MIN_PART_SIZE = 1 << 20;
+
+            protected:
+                HTTPChunkSplitSource(const std::string &url, AbstractConnectionManager *,
+                                     const ID &, const BytesRange &, unsigned);
+
+            private:
+                void                reportRate();
+                bool                isPartComplete(const HTTPChunkBufferedSource *) const;
+                void                nextPart();
+                std::vector<HTTPChunkBufferedSource *> parts;
+                AbstractConnectionManager *connManager;
+                ID                  sourceid;
+                size_t              current; /* part being read */
+                size_t              consumed;
+                bool                eof;
         };
 
         class HTTPChunk : public AbstractChunk
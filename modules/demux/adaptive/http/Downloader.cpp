@@ -25,34 +25,35 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned workers_, unsigned maxperhost_)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
-    cancel_current = false;
+    workers = workers_ ? workers_ : 1;
+    /* 0 means only bounded by the number of workers */
+    maxperhost = maxperhost_ ? std::min(maxperhost_, workers) : workers;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread, static_cast<void *>(this)))
+    while(thread_handles.size() < workers)
     {
-        return false;
+        vlc_thread_t thread_handle;
+        if(vlc_clone(&thread_handle, downloaderThread, static_cast<void *>(this)))
+            break;
+        thread_handles.push_back(thread_handle);
     }
-    thread_handle_valid = true;
-    return true;
+    return !thread_handles.empty();
 }
 
 Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
+    for(vlc_thread_t &thread_handle : thread_handles)
         vlc_join(thread_handle, nullptr);
 }
 
@@ -60,23 +61,28 @@ void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
     source->hold();
-    chunks.push_back(source);
+    /* keep queue ordered by priority, FIFO for same priority */
+    auto it = std::find_if(chunks.begin(), chunks.end(),
+                           [source](const HTTPChunkBufferedSource *s)
+                           { return s->getPriority() > source->getPriority(); });
+    chunks.insert(it, source);
     wait_cond.signal();
 }
 
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    while (isActive(source))
     {
-        cancel_current = true;
+        if(std::find(cancelled.begin(), cancelled.end(), source) == cancelled.end())
+            cancelled.push_back(source);
         updated_cond.wait(lock);
     }
 
@@ -87,6 +93,33 @@ void Downloader::cancel(HTTPChunkBufferedSource *source)
     }
 }
 
+bool Downloader::isActive(const HTTPChunkBufferedSource *source) const
+{
+    return std::find(current.begin(), current.end(), source) != current.end();
+}
+
+std::string Downloader::getHostKey(const HTTPChunkBufferedSource *source)
+{
+    const ConnectionParams &params = source->getConnectionParams();
+    return params.getHostname() + ':' + std::to_string(params.getPort());
+}
+
+HTTPChunkBufferedSource * Downloader::getNextSource() const
+{
+    for(HTTPChunkBufferedSource *source : chunks)
+    {
+        if(isActive(source))
+            continue;
+        const std::string host = getHostKey(source);
+        unsigned count = std::count_if(current.begin(), current.end(),
+                                       [&host](const HTTPChunkBufferedSource *s)
+                                       { return getHostKey(s) == host; });
+        if(count < maxperhost)
+            return source;
+    }
+    return nullptr;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
     vlc_thread_set_name("vlc-adapt-dl");
@@ -101,7 +134,8 @@ void Downloader::Run()
     {
         lock.lock();
 
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source;
+        while(!killed && !(source = getNextSource()))
             wait_cond.wait(lock);
 
         if(killed)
@@ -110,18 +144,25 @@ void Downloader::Run()
             break;
         }
 
-        current = chunks.front();
-        lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
-        lock.lock();
-        if(current->isDone() || cancel_current)
+        current.push_back(source);
+
+        bool b_stop;
+        do
         {
-            chunks.pop_front();
-            current->release();
-        }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
+            lock.unlock();
+            source->bufferize(HTTPChunkSource::CHUNK_SIZE);
+            lock.lock();
+            b_stop = source->isDone() || killed ||
+                     std::find(cancelled.begin(), cancelled.end(), source) != cancelled.end();
+        } while(!b_stop);
+
+        chunks.remove(source);
+        source->release();
+        cancelled.remove(source);
+        current.remove(source);
+        updated_cond.broadcast();
+        /* a host slot might have been freed */
+        wait_cond.broadcast();
         lock.unlock();
     }
 }
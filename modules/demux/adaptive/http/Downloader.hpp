@@ -26,6 +26,8 @@
 #include <vlc_threads.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <vector>
+#include <string>
 
 namespace adaptive
 {
@@ -36,7 +38,7 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1, unsigned = 0);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
@@ -46,15 +48,19 @@ namespace adaptive
                 static void * downloaderThread(void *);
                 void Run();
                 void kill();
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNextSource() const;
+                bool isActive(const HTTPChunkBufferedSource *) const;
+                static std::string getHostKey(const HTTPChunkBufferedSource *);
+                std::vector<vlc_thread_t> thread_handles;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
+                unsigned     workers;
+                unsigned     maxperhost;
                 bool         killed;
-                bool         cancel_current;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::list<HTTPChunkBufferedSource *> current; /* being downloaded */
+                std::list<HTTPChunkBufferedSource *> cancelled;
         };
 
     }
@@ -90,14 +90,15 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
      public:
         LibVLCHTTPSource(vlc_object_t *p_object, struct vlc_http_cookie_jar_t *jar)
         {
-            http_mgr = vlc_http_mgr_create(p_object, jar);
+            own_mgr = vlc_http_mgr_create(p_object, jar);
+            http_mgr = own_mgr;
             http_res = nullptr;
             totalRead = 0;
         }
         virtual ~LibVLCHTTPSource()
         {
-            if(http_mgr)
-                vlc_http_mgr_destroy(http_mgr);
+            if(own_mgr)
+                vlc_http_mgr_destroy(own_mgr);
         }
         block_t *readNextBlock() override
         {
@@ -185,6 +186,8 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
 
         static const struct vlc_http_resource_cbs callbacks;
         size_t totalRead;
+        struct vlc_http_mgr *own_mgr;
+        /* own one, or shared with the other connections */
         struct vlc_http_mgr *http_mgr;
         BytesRange range;
 
@@ -239,9 +242,76 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPManagers::LibVLCHTTPManagers(AuthStorage *auth)
+{
+    authStorage = auth;
+    vlc_mutex_init(&lock);
+}
+
+LibVLCHTTPManagers::~LibVLCHTTPManagers()
+{
+    for(auto &origin : origins)
+        if(origin.second.mgr)
+            vlc_http_mgr_destroy(origin.second.mgr);
+}
+
+std::string LibVLCHTTPManagers::getOrigin(const ConnectionParams &params)
+{
+    return params.getScheme() + "://" + params.getHostname() + ":" +
+           std::to_string(params.getPort());
+}
+
+struct vlc_http_mgr * LibVLCHTTPManagers::acquire(vlc_object_t *p_object,
+                                                  const ConnectionParams &params)
+{
+    /* cleartext is always HTTP/1.1 */
+    if(params.getScheme() != "https")
+        return nullptr;
+
+    vlc_mutex_locker locker(&lock);
+    Origin &origin = origins[getOrigin(params)];
+    switch(origin.state)
+    {
+        case State::Unknown:
+            /* a single request sets up the session and tells
+               if the server is multiplexing */
+            if(!origin.mgr &&
+               !(origin.mgr = vlc_http_mgr_create(p_object, authStorage->getJar())))
+                return nullptr;
+            origin.state = State::Probing;
+            return origin.mgr;
+        case State::Multiplexed:
+            return origin.mgr;
+        case State::Probing:
+        case State::Serial:
+        default:
+            return nullptr;
+    }
+}
+
+void LibVLCHTTPManagers::report(const ConnectionParams &params,
+                                struct vlc_http_mgr *mgr, bool b_success)
+{
+    const bool b_multiplexed = b_success && vlc_http_mgr_is_multiplexed(mgr);
+
+    vlc_mutex_locker locker(&lock);
+    auto it = origins.find(getOrigin(params));
+    if(it == origins.end() || it->second.mgr != mgr)
+        return;
+    Origin &origin = it->second;
+    if(b_multiplexed)
+        origin.state = State::Multiplexed;
+    else if(b_success)
+        origin.state = State::Serial; /* HTTP/1.1 server */
+    else if(origin.state == State::Probing)
+        origin.state = State::Unknown; /* will probe again */
+}
+
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
+                                           LibVLCHTTPManagers *managers_)
     : AbstractConnection( p_object_ )
 {
+    managers = managers_;
     source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
@@ -293,7 +363,7 @@ bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
 RequestStatus LibVLCHTTPConnection::request(const std::string &path,
                                             const BytesRange &range)
 {
-    if(source->http_mgr == nullptr)
+    if(source->own_mgr == nullptr)
         return RequestStatus::GenericError;
 
     reset();
@@ -301,6 +371,10 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     /* Set new path for this query */
     params.setPath(path);
 
+    struct vlc_http_mgr *shared_mgr = managers ? managers->acquire(p_object, params)
+                                               : nullptr;
+    source->http_mgr = shared_mgr ? shared_mgr : source->own_mgr;
+
     if(range.isValid())
         msg_Dbg(p_object, "Retrieving %s @%zu-%zu", params.getUrl().c_str(),
                            range.getStartByte(), range.getEndByte());
@@ -308,7 +382,11 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
         msg_Dbg(p_object, "Retrieving %s", params.getUrl().c_str());
 
     if(source->create(params.getUrl().c_str(), useragent,referer, range))
+    {
+        if(shared_mgr)
+            managers->report(params, shared_mgr, false);
         return RequestStatus::GenericError;
+    }
 
     struct vlc_credential crd;
     struct vlc_url_t crd_url;
@@ -323,12 +401,16 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     }
     else if (ret == -EINTR)
     {
+        if(shared_mgr)
+            managers->report(params, shared_mgr, false);
         vlc_credential_clean(&crd);
         vlc_UrlClean(&crd_url);
         return RequestStatus::GenericError;
     }
 
     int status = vlc_http_res_get_status(source->http_res);
+    if(shared_mgr)
+        managers->report(params, shared_mgr, status >= 0);
     if (status < 0)
     {
         vlc_credential_clean(&crd);
@@ -424,6 +506,13 @@ ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
     return read;
 }
 
+ssize_t LibVLCHTTPConnection::readPartial(void *p_buffer, size_t len)
+{
+    ssize_t read = vlc_stream_ReadPartial(stream, p_buffer, len);
+    bytesRead = source->totalRead;
+    return read;
+}
+
 void LibVLCHTTPConnection::setUsed( bool b )
 {
     available = !b;
@@ -539,6 +628,34 @@ ssize_t StreamUrlConnection::read(void *p_buffer, size_t len)
     return ret;
 }
 
+ssize_t StreamUrlConnection::readPartial(void *p_buffer, size_t len)
+{
+    if( !p_streamurl )
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    ssize_t ret = vlc_stream_ReadPartial(p_streamurl, p_buffer, len);
+    if(ret > 0)
+        bytesRead += ret;
+
+    if(ret <= 0 || contentLength == bytesRead) /* set EOF */
+    {
+        reset();
+        return ret;
+    }
+
+    return ret;
+}
+
 void StreamUrlConnection::setUsed( bool b )
 {
     available = !b;
@@ -547,7 +664,7 @@ void StreamUrlConnection::setUsed( bool b )
 }
 
 LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
-    : AbstractConnectionFactory()
+    : AbstractConnectionFactory(), managers( auth )
 {
     authStorage = auth;
 }
@@ -558,7 +675,7 @@ AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+    return new LibVLCHTTPConnection(p_object, authStorage, &managers);
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
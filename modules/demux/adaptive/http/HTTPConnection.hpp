@@ -28,8 +28,12 @@
 #include "ConnectionParams.hpp"
 #include "BytesRange.hpp"
 #include <vlc_common.h>
+#include <vlc_threads.h>
+#include <map>
 #include <string>
 
+struct vlc_http_mgr;
+
 namespace adaptive
 {
     class ChunksSourceStream;
@@ -52,6 +56,8 @@ namespace adaptive
                 virtual RequestStatus request(const std::string& path,
                                               const BytesRange & = BytesRange()) = 0;
                 virtual ssize_t read        (void *p_buffer, size_t len) = 0;
+                /* returns as soon as some data is available */
+                virtual ssize_t readPartial (void *p_buffer, size_t len) = 0;
 
                 virtual size_t  getContentLength() const;
                 virtual size_t  getBytesRead() const;
@@ -72,21 +78,56 @@ namespace adaptive
 
        class LibVLCHTTPSource;
 
+       /* Shares one libvlc http manager per HTTPS origin, so the concurrent
+        * requests get multiplexed over a single HTTP/2 connection.
+        * Origins which did not negotiate HTTP/2 keep using a
+        * connection per request. */
+       class LibVLCHTTPManagers
+       {
+            public:
+               LibVLCHTTPManagers(AuthStorage *);
+               ~LibVLCHTTPManagers();
+               struct vlc_http_mgr * acquire(vlc_object_t *, const ConnectionParams &);
+               void report(const ConnectionParams &, struct vlc_http_mgr *, bool);
+
+            private:
+               enum class State
+               {
+                   Unknown,
+                   Probing,
+                   Multiplexed,
+                   Serial,
+               };
+               class Origin
+               {
+                   public:
+                       struct vlc_http_mgr *mgr = nullptr;
+                       State state = State::Unknown;
+               };
+               static std::string getOrigin(const ConnectionParams &);
+               AuthStorage *authStorage;
+               std::map<std::string, Origin> origins;
+               vlc_mutex_t lock;
+       };
+
        class LibVLCHTTPConnection : public AbstractConnection
        {
             public:
-               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *);
+               LibVLCHTTPConnection(vlc_object_t *, AuthStorage *,
+                                    LibVLCHTTPManagers * = nullptr);
                virtual ~LibVLCHTTPConnection();
                bool    canReuse     (const ConnectionParams &) const override;
                RequestStatus request(const std::string& path,
                                      const BytesRange & = BytesRange()) override;
                ssize_t read         (void *p_buffer, size_t len) override;
+               ssize_t readPartial  (void *p_buffer, size_t len) override;
                void    setUsed      ( bool ) override;
 
             private:
                void reset();
                std::string useragent;
                std::string referer;
+               LibVLCHTTPManagers *managers;
                LibVLCHTTPSource *source;
                ChunksSourceStream *sourceStream;
                stream_t *stream;
@@ -103,6 +144,7 @@ namespace adaptive
                 RequestStatus request(const std::string& path,
                                       const BytesRange & = BytesRange()) override;
                 ssize_t read        (void *p_buffer, size_t len) override;
+                ssize_t readPartial (void *p_buffer, size_t len) override;
 
                 void    setUsed( bool ) override;
 
@@ -127,6 +169,7 @@ namespace adaptive
                AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
            private:
                AuthStorage *authStorage;
+               LibVLCHTTPManagers managers;
        };
 
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
@@ -29,10 +29,13 @@
 #include "HTTPConnection.hpp"
 #include "ConnectionParams.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include "../tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
+#include <vlc_configuration.h>
 
+#include <algorithm>
 #include <cassert>
 
 using namespace adaptive::http;
@@ -62,11 +65,21 @@ void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid,
     }
 }
 
+void AbstractConnectionManager::sourceCompleted(AbstractChunkSource *)
+{
+
+}
+
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
 {
     rateObserver = obs;
 }
 
+vlc_object_t * AbstractConnectionManager::getVLCObject() const
+{
+    return p_object;
+}
+
 void AbstractConnectionManager::deleteSource(AbstractChunkSource *source)
 {
     delete source;
@@ -77,12 +90,30 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    int64_t workers = var_InheritInteger(p_object, "adaptive-maxdownloads");
+    int64_t perhost = var_InheritInteger(p_object, "adaptive-maxhostconns");
+    downloader = new Downloader(VLC_CLIP(workers, 1, 16), VLC_CLIP(perhost, 0, 16));
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
     cache_total = 0;
     cache_max = 1 << 19;
+    splitparts = VLC_CLIP(var_InheritInteger(p_object, "adaptive-rangesplit"), 1, 16);
+    diskcache = nullptr;
+    int64_t diskcache_max = var_InheritInteger(p_object, "adaptive-diskcache");
+    char *psz_cachedir = diskcache_max > 0 ? config_GetUserDir(VLC_CACHE_DIR) : nullptr;
+    if(psz_cachedir)
+    {
+        diskcache = new SegmentCache(p_object,
+                                     std::string(psz_cachedir) + DIR_SEP "adaptive",
+                                     (size_t) diskcache_max << 20);
+        free(psz_cachedir);
+        if(!diskcache->init())
+        {
+            delete diskcache;
+            diskcache = nullptr;
+        }
+    }
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
@@ -99,6 +130,7 @@ HTTPConnectionManager::~HTTPConnectionManager   ()
     }
     delete downloader;
     delete downloaderhp;
+    delete diskcache;
     this->closeAllConnections();
     while(!factories.empty())
     {
@@ -172,6 +204,32 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
                                                        const ID &id, ChunkType type,
                                                        const BytesRange &range)
 {
+    if(diskcache && isStorable(type))
+    {
+        std::string contenttype;
+        block_t *p_data = diskcache->get(HTTPChunkSource::makeStorageID(url, range),
+                                         &contenttype);
+        if(p_data)
+        {
+            HTTPChunkBufferedSource *source =
+                    new HTTPChunkBufferedSource(url, this, id, type, range);
+            source->fill(p_data, contenttype);
+            CacheDebug(msg_Dbg(p_object, "Disk cache GET '%s'",
+                               source->getStorageID().c_str()));
+            return source;
+        }
+    }
+
+    if(type == ChunkType::Segment && splitparts > 1 &&
+       range.isValid() && range.getEndByte() > range.getStartByte())
+    {
+        const size_t size = range.getEndByte() - range.getStartByte() + 1;
+        const size_t count = std::min<size_t>(splitparts,
+                                              size / HTTPChunkSplitSource::MIN_PART_SIZE);
+        if(count > 1)
+            return new HTTPChunkSplitSource(url, this, id, range, count);
+    }
+
     StorageID storageid = HTTPChunkSource::makeStorageID(url, range);
     switch(type)
     {
@@ -238,6 +296,32 @@ void HTTPConnectionManager::recycleSource(AbstractChunkSource *source)
         deleteSource(source);
 }
 
+bool HTTPConnectionManager::isStorable(ChunkType type)
+{
+    switch(type)
+    {
+        case ChunkType::Segment:
+        case ChunkType::Init:
+        case ChunkType::Index:
+            return true;
+        case ChunkType::Key:
+        case ChunkType::Playlist:
+        default:
+            return false;
+    }
+}
+
+void HTTPConnectionManager::sourceCompleted(AbstractChunkSource *source)
+{
+    HTTPChunkBufferedSource *buf = dynamic_cast<HTTPChunkBufferedSource *>(source);
+    if(!diskcache || !buf || !buf->isStorable() ||
+       !isStorable(buf->getChunkType()) ||
+       buf->getStorageID().empty())
+        return;
+    diskcache->put(buf->getStorageID(), buf->getContentType(), buf->p_head);
+    CacheDebug(msg_Dbg(p_object, "Disk cache PUT '%s'", buf->getStorageID().c_str()));
+}
+
 Downloader * HTTPConnectionManager::getDownloadQueue(const AbstractChunkSource *source) const
 {
     switch(source->getChunkType())
@@ -255,6 +339,17 @@ Downloader * HTTPConnectionManager::getDownloadQueue(const AbstractChunkSource *
 
 void HTTPConnectionManager::start(AbstractChunkSource *source)
 {
+    HTTPChunkSplitSource *split = dynamic_cast<HTTPChunkSplitSource *>(source);
+    if(split)
+    {
+        for(HTTPChunkBufferedSource *part : split->parts)
+        {
+            part->setPriority(split->getPriority());
+            start(part);
+        }
+        return;
+    }
+
     HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
     if(src && !src->isDone())
         getDownloadQueue(src)->schedule(src);
@@ -262,6 +357,14 @@ void HTTPConnectionManager::start(AbstractChunkSource *source)
 
 void HTTPConnectionManager::cancel(AbstractChunkSource *source)
 {
+    HTTPChunkSplitSource *split = dynamic_cast<HTTPChunkSplitSource *>(source);
+    if(split)
+    {
+        for(HTTPChunkBufferedSource *part : split->parts)
+            cancel(part);
+        return;
+    }
+
     HTTPChunkBufferedSource *src = dynamic_cast<HTTPChunkBufferedSource *>(source);
     if(src)
         getDownloadQueue(src)->cancel(src);
@@ -45,6 +45,7 @@ namespace adaptive
         class Downloader;
         class AbstractChunkSource;
         class HTTPChunkBufferedSource;
+        class SegmentCache;
         enum class ChunkType;
 
         class AbstractConnectionManager : public IDownloadRateObserver
@@ -64,7 +65,9 @@ namespace adaptive
 
                 virtual void updateDownloadRate(const ID &, size_t,
                                                 vlc_tick_t, vlc_tick_t) override;
+                virtual void sourceCompleted(AbstractChunkSource *);
                 void setDownloadRateObserver(IDownloadRateObserver *);
+                vlc_object_t * getVLCObject() const;
 
             protected:
                 void deleteSource(AbstractChunkSource *);
@@ -89,6 +92,7 @@ namespace adaptive
 
                 void start(AbstractChunkSource *)  override;
                 void cancel(AbstractChunkSource *)  override;
+                void sourceCompleted(AbstractChunkSource *) override;
                 void         setLocalConnectionsAllowed();
                 void         addFactory(AbstractConnectionFactory *);
 
@@ -102,9 +106,12 @@ namespace adaptive
                 bool                                                localAllowed;
                 AbstractConnection * reuseConnection(ConnectionParams &);
                 Downloader * getDownloadQueue(const AbstractChunkSource *) const;
+                static bool isStorable(ChunkType);
                 std::list<HTTPChunkBufferedSource *> cache;
                 size_t cache_total;
                 size_t cache_max;
+                unsigned splitparts;
+                SegmentCache *diskcache;
         };
     }
 }
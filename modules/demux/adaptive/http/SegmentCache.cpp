@@ -0,0 +1,300 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+using namespace adaptive::http;
+using vlc::threads::mutex_locker;
+
+static const char cache_magic[8] = { 'V','L','C','S','E','G','C','1' };
+static const char cache_suffix[] = ".seg";
+static const char cache_temp_suffix[] = ".seg.tmp";
+
+/* header: magic, 16 bits id length, 16 bits type length, id, type */
+static const size_t cache_header_size = sizeof(cache_magic) + 4;
+
+SegmentCache::SegmentCache(vlc_object_t *obj, const std::string &dir_, size_t max)
+{
+    p_object = obj;
+    dir = dir_;
+    maxsize = max;
+    total = 0;
+}
+
+SegmentCache::~SegmentCache()
+{
+}
+
+std::string SegmentCache::getName(const StorageID &id) const
+{
+    vlc_hash_md5_t md5;
+    uint8_t digest[VLC_HASH_MD5_DIGEST_SIZE];
+    char hex[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_Init(&md5);
+    vlc_hash_md5_Update(&md5, id.c_str(), id.length());
+    vlc_hash_md5_Finish(&md5, digest, sizeof(digest));
+    vlc_hex_encode_binary(digest, sizeof(digest), hex);
+    return std::string(hex) + cache_suffix;
+}
+
+std::string SegmentCache::getPath(const std::string &name) const
+{
+    return dir + DIR_SEP + name;
+}
+
+bool SegmentCache::init()
+{
+    if(vlc_mkdir_parent(dir.c_str(), 0700) && errno != EEXIST)
+    {
+        msg_Warn(p_object, "cannot create segment cache directory %s", dir.c_str());
+        return false;
+    }
+
+    vlc_DIR *d = vlc_opendir(dir.c_str());
+    if(!d)
+        return false;
+
+    struct stamped
+    {
+        Entry entry;
+        time_t mtime;
+    };
+    std::vector<stamped> found;
+    const size_t suffixlen = sizeof(cache_suffix) - 1;
+    const size_t tempsuffixlen = sizeof(cache_temp_suffix) - 1;
+    const char *psz_name;
+    while((psz_name = vlc_readdir(d)))
+    {
+        const std::string name(psz_name);
+        /* left over by an interrupted put() */
+        if(name.length() > tempsuffixlen &&
+           !name.compare(name.length() - tempsuffixlen, tempsuffixlen, cache_temp_suffix))
+        {
+            vlc_unlink(getPath(name).c_str());
+            continue;
+        }
+        if(name.length() <= suffixlen ||
+           name.compare(name.length() - suffixlen, suffixlen, cache_suffix))
+            continue;
+        struct stat st;
+        if(vlc_stat(getPath(name).c_str(), &st) || !S_ISREG(st.st_mode))
+            continue;
+        stamped s;
+        s.entry.name = name;
+        s.entry.size = st.st_size;
+        s.mtime = st.st_mtime;
+        found.push_back(s);
+    }
+    vlc_closedir(d);
+
+    std::sort(found.begin(), found.end(),
+              [](const stamped &a, const stamped &b) { return a.mtime > b.mtime; });
+
+    std::vector<std::string> evicted;
+    {
+        mutex_locker locker {lock};
+        for(const stamped &s : found)
+        {
+            entries.push_back(s.entry);
+            total += s.entry.size;
+        }
+        evicted = evict(0);
+        msg_Dbg(p_object, "segment cache %s: %zu entries, %zu bytes",
+                dir.c_str(), entries.size(), total);
+    }
+    remove(evicted);
+    return true;
+}
+
+/* Drops the least recently used entries and returns their names,
+ * for removal once unlocked. Called with the lock held. */
+std::vector<std::string> SegmentCache::evict(size_t needed)
+{
+    std::vector<std::string> evicted;
+    while(!entries.empty() && total + needed > maxsize)
+    {
+        const Entry &entry = entries.back();
+        evicted.push_back(entry.name);
+        total -= entry.size;
+        entries.pop_back();
+    }
+    return evicted;
+}
+
+/* A concurrent put() of an evicted entry can lose its new file here.
+ * get() then fails to read it and drops the entry. */
+void SegmentCache::remove(const std::vector<std::string> &names) const
+{
+    for(const std::string &name : names)
+        vlc_unlink(getPath(name).c_str());
+}
+
+std::list<SegmentCache::Entry>::iterator SegmentCache::find(const std::string &name)
+{
+    return std::find_if(entries.begin(), entries.end(),
+                        [&name](const Entry &e){ return e.name == name; });
+}
+
+block_t * SegmentCache::get(const StorageID &id, std::string *contenttype)
+{
+    const std::string name = getName(id);
+    const std::string path = getPath(name);
+
+    {
+        mutex_locker locker {lock};
+        if(find(name) == entries.end())
+            return nullptr;
+    }
+
+    block_t *p_block = block_FilePath(path.c_str(), false);
+    bool b_valid = false;
+    if(p_block && p_block->i_buffer >= cache_header_size &&
+       !memcmp(p_block->p_buffer, cache_magic, sizeof(cache_magic)))
+    {
+        const size_t idlen = GetWBE(&p_block->p_buffer[sizeof(cache_magic)]);
+        const size_t typelen = GetWBE(&p_block->p_buffer[sizeof(cache_magic) + 2]);
+        const size_t hdrlen = cache_header_size + idlen + typelen;
+        if(p_block->i_buffer > hdrlen &&
+           id.compare(0, std::string::npos,
+                      (const char *) &p_block->p_buffer[cache_header_size], idlen) == 0)
+        {
+            contenttype->assign((const char *) &p_block->p_buffer[cache_header_size + idlen],
+                                typelen);
+            p_block->p_buffer += hdrlen;
+            p_block->i_buffer -= hdrlen;
+            b_valid = true;
+        }
+    }
+
+    {
+        /* the entry might have been evicted while reading */
+        mutex_locker locker {lock};
+        auto it = find(name);
+        if(b_valid)
+        {
+            if(it != entries.end())
+                entries.splice(entries.begin(), entries, it);
+        }
+        else if(it != entries.end())
+        {
+            /* unreadable, truncated or colliding entry */
+            total -= it->size;
+            entries.erase(it);
+        }
+        else
+        {
+            /* already removed */
+            if(p_block)
+                block_Release(p_block);
+            return nullptr;
+        }
+    }
+
+    if(!b_valid)
+    {
+        if(p_block)
+            block_Release(p_block);
+        vlc_unlink(path.c_str());
+        return nullptr;
+    }
+
+#ifdef HAVE_UTIMENSAT
+    /* init() restores the LRU order from modification times */
+    utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+#endif
+    return p_block;
+}
+
+void SegmentCache::put(const StorageID &id, const std::string &contenttype,
+                       const block_t *p_chain)
+{
+    size_t datasize;
+    block_ChainProperties(p_chain, nullptr, &datasize, nullptr);
+    if(!datasize || id.length() > UINT16_MAX || contenttype.length() > UINT16_MAX)
+        return;
+
+    const size_t size = cache_header_size + id.length() + contenttype.length() + datasize;
+    if(size > maxsize)
+        return;
+
+    const std::string name = getName(id);
+    const std::string path = getPath(name);
+    const std::string temppath = path + ".tmp";
+
+    {
+        mutex_locker locker {lock};
+        if(writing.count(name) || find(name) != entries.end())
+            return;
+        writing.insert(name);
+    }
+
+    bool b_error = true;
+    int fd = vlc_open(temppath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if(fd != -1)
+    {
+        uint8_t header[cache_header_size];
+        memcpy(header, cache_magic, sizeof(cache_magic));
+        SetWBE(&header[sizeof(cache_magic)], id.length());
+        SetWBE(&header[sizeof(cache_magic) + 2], contenttype.length());
+
+        b_error = vlc_write(fd, header, sizeof(header)) != (ssize_t) sizeof(header) ||
+                  vlc_write(fd, id.c_str(), id.length()) != (ssize_t) id.length() ||
+                  vlc_write(fd, contenttype.c_str(), contenttype.length())
+                       != (ssize_t) contenttype.length();
+        for(const block_t *p_block = p_chain; p_block && !b_error; p_block = p_block->p_next)
+            b_error = vlc_write(fd, p_block->p_buffer, p_block->i_buffer) != (ssize_t) p_block->i_buffer;
+        vlc_close(fd);
+
+        if(b_error || vlc_rename(temppath.c_str(), path.c_str()))
+        {
+            vlc_unlink(temppath.c_str());
+            b_error = true;
+        }
+    }
+
+    std::vector<std::string> evicted;
+    {
+        mutex_locker locker {lock};
+        writing.erase(name);
+        if(b_error)
+            return;
+        evicted = evict(size);
+        entries.push_front({name, size});
+        total += size;
+    }
+    remove(evicted);
+}
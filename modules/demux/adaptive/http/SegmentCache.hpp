@@ -0,0 +1,71 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include "Chunk.h"
+
+#include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace adaptive
+{
+    namespace http
+    {
+        /* Bounded LRU storage of downloaded segments, one file per
+         * StorageID, persisting across sessions. The lock only protects
+         * the index, files are read and written outside of it. */
+        class SegmentCache
+        {
+            public:
+                SegmentCache(vlc_object_t *, const std::string &, size_t);
+                ~SegmentCache();
+                bool init();
+                block_t * get(const StorageID &, std::string *);
+                void put(const StorageID &, const std::string &, const block_t *);
+
+            private:
+                struct Entry
+                {
+                    std::string name;
+                    size_t size;
+                };
+                std::string getName(const StorageID &) const;
+                std::string getPath(const std::string &) const;
+                std::vector<std::string> evict(size_t);
+                void remove(const std::vector<std::string> &) const;
+                std::list<Entry>::iterator find(const std::string &);
+                vlc_object_t *p_object;
+                std::string dir;
+                size_t maxsize;
+                size_t total;
+                std::list<Entry> entries; /* most recently used first */
+                std::set<std::string> writing; /* put() in progress */
+                vlc::threads::mutex lock;
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
@@ -26,6 +26,10 @@
 #endif
 
 #include "AbstractAdaptationLogic.h"
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+
+#include <vlc_tracer.h>
 
 #include <limits>
 
@@ -47,6 +51,26 @@ void AbstractAdaptationLogic::updateDownloadRate    (const adaptive::ID &, size_
 {
 }
 
+void AbstractAdaptationLogic::traceDecision(const BaseAdaptationSet *adaptSet,
+                                            const BaseRepresentation *rep,
+                                            const char *reason, uint64_t bps,
+                                            vlc_tick_t level) const
+{
+    struct vlc_tracer *tracer = p_obj ? vlc_object_get_tracer(p_obj) : nullptr;
+    if(!tracer || !rep)
+        return;
+
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", "ADAPTIVE"),
+                             VLC_TRACE("id", adaptSet->getID().str().c_str()),
+                             VLC_TRACE("event", "decision"),
+                             VLC_TRACE("representation", rep->getID().str().c_str()),
+                             VLC_TRACE("bandwidth", (int64_t) rep->getBandwidth()),
+                             VLC_TRACE("reason", reason),
+                             VLC_TRACE("estimated", (int64_t) bps),
+                             VLC_TRACE_TICK_NS("buffer", level),
+                             VLC_TRACE_END);
+}
+
 void AbstractAdaptationLogic::setMaxDeviceResolution (int w, int h)
 {
     maxwidth = (w > 0) ? w : std::numeric_limits<int>::max();
@@ -62,9 +62,14 @@ namespace adaptive
                     FixedRate,
                     Predictive,
                     NearOptimal,
+                    Hybrid,
                 };
 
             protected:
+                /* exports the decision and what drove it to the tracer */
+                void traceDecision(const BaseAdaptationSet *, const BaseRepresentation *,
+                                   const char *, uint64_t,
+                                   vlc_tick_t = VLC_TICK_INVALID) const;
                 vlc_object_t *p_obj;
                 int maxwidth;
                 int maxheight;
@@ -37,6 +37,7 @@ using namespace adaptive::playlist;
 using namespace adaptive::logic;
 
 const vlc_tick_t AbstractBufferingLogic::BUFFERING_LOWEST_LIMIT = VLC_TICK_FROM_SEC(2);
+const vlc_tick_t AbstractBufferingLogic::LOWLATENCY_LOWEST_LIMIT = VLC_TICK_FROM_MS(500);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MIN_BUFFERING = VLC_TICK_FROM_SEC(6);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_MAX_BUFFERING = VLC_TICK_FROM_SEC(30);
 const vlc_tick_t AbstractBufferingLogic::DEFAULT_LIVE_BUFFERING = VLC_TICK_FROM_SEC(15);
@@ -102,7 +103,13 @@ uint64_t DefaultBufferingLogic::getStartSegmentNumber(BaseRepresentation *rep) c
 vlc_tick_t DefaultBufferingLogic::getMinBuffering(const BasePlaylist *p) const
 {
     if(isLowLatency(p))
+    {
+        /* Only go below our lowest limit when the playlist asks for it */
+        if(p->getMinBuffering())
+            return VLC_CLIP(p->getMinBuffering(), LOWLATENCY_LOWEST_LIMIT,
+                            BUFFERING_LOWEST_LIMIT);
         return BUFFERING_LOWEST_LIMIT;
+    }
 
     vlc_tick_t buffering = userMinBuffering ? userMinBuffering
                                             : DEFAULT_MIN_BUFFERING;
@@ -315,9 +322,10 @@ uint64_t DefaultBufferingLogic::getLiveStartSegmentNumber(BaseRepresentation *re
             }
         }
 
+        /* Low latency live edge can be read while being produced */
+        const uint64_t safetyedgeoffset = back->isComplete() ? SAFETY_BUFFERING_EDGE_OFFSET : 0;
         uint64_t safeedgenumber = back->getSequenceNumber() -
-                        std::min((uint64_t)list.size() - 1,
-                                 (uint64_t)SAFETY_BUFFERING_EDGE_OFFSET);
+                        std::min((uint64_t)list.size() - 1, safetyedgeoffset);
         uint64_t safestartnumber = availableliststartnumber;
 
         for(unsigned i=0; i<SAFETY_EXPURGING_OFFSET; i++)
@@ -0,0 +1,320 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Buffer and throughput hybrid, after
+ * BOLA: Near-Optimal Bitrate Adaptation for Online Videos
+ * http://arxiv.org/abs/1601.06748
+ * and the robust throughput estimate of
+ * A Control-Theoretic Approach for Dynamic Adaptive Video Streaming over HTTP
+ * https://dl.acm.org/doi/10.1145/2829988.2787486
+ *
+ * Below the minimum buffering, or while starting, the robust throughput
+ * estimate alone picks the representation. Above it, the BOLA choice is
+ * capped by the highest rate that keeps the buffer over the minimum for
+ * a download horizon of the buffering target (one step MPC), and only
+ * steps up when the estimated throughput sustains the new rate (BOLA-O).
+ */
+
+#define minimumBufferS VLC_TICK_FROM_SEC(6)  /* Qmin */
+#define lowestBufferS  VLC_TICK_FROM_SEC(2)
+#define bufferTargetS  VLC_TICK_FROM_SEC(30) /* Qmax */
+
+HybridContext::HybridContext()
+    : buffering_min( minimumBufferS )
+    , buffering_level( 0 )
+    , buffering_target( bufferTargetS )
+    , predicted( 0 )
+{ }
+
+void HybridContext::push(unsigned bps)
+{
+    if(predicted)
+    {
+        if(errors.size() >= HybridAdaptationLogic::HISTORY_SIZE)
+            errors.pop_front();
+        errors.push_back(std::fabs((float)predicted - bps) / bps);
+    }
+    if(samples.size() >= HybridAdaptationLogic::HISTORY_SIZE)
+        samples.pop_front();
+    samples.push_back(bps);
+
+    /* harmonic mean of past samples */
+    double sum = 0;
+    for(unsigned s : samples)
+        sum += 1.0 / s;
+    predicted = samples.size() / sum;
+}
+
+unsigned HybridContext::getEstimate() const
+{
+    if(samples.empty())
+        return 0;
+    /* discount by the worst recent prediction error */
+    float maxerror = 0;
+    if(!errors.empty())
+        maxerror = *std::max_element(errors.begin(), errors.end());
+    return predicted / (1.0 + maxerror);
+}
+
+HybridAdaptationLogic::HybridAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+    , currentBps( 0 )
+    , usedBps( 0 )
+{
+    vlc_mutex_init(&lock);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+}
+
+BaseRepresentation *
+HybridAdaptationLogic::getBufferBasedRep(BaseAdaptationSet *adaptSet, RepresentationSelector &selector,
+                                         const HybridContext &ctx) const
+{
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+
+    /* utilities are log(S/Smin), so umin == 0 */
+    const float Smin = lowest->getBandwidth() ? lowest->getBandwidth() : 1;
+    const float umax = std::log(highest->getBandwidth() / Smin);
+    const float Qmin = secf_from_vlc_tick(ctx.buffering_min);
+    const float Qmax = std::max<float>(secf_from_vlc_tick(ctx.buffering_target), Qmin + 1);
+    const float gammaP = 1.0 + umax / (Qmax / Qmin - 1.0);
+    const float Vd = (Qmin - 1.0) / gammaP;
+    const float Q = secf_from_vlc_tick(ctx.buffering_level);
+
+    BaseRepresentation *ret = nullptr;
+    BaseRepresentation *prev = nullptr;
+    float argmax = 0;
+    for(BaseRepresentation *rep = lowest;
+                            rep && rep != prev; rep = selector.higher(adaptSet, rep))
+    {
+        const float S = rep->getBandwidth() ? rep->getBandwidth() : 1;
+        float arg = ( Vd * (std::log(S / Smin) + gammaP) - Q ) / S;
+        if(ret == nullptr || argmax <= arg)
+        {
+            ret = rep;
+            argmax = arg;
+        }
+        prev = rep;
+    }
+    return ret;
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet, BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+    if(lowest == nullptr || highest == nullptr)
+        return nullptr;
+
+    if(lowest == highest)
+        return lowest;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridContext>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end())
+    {
+        vlc_mutex_unlock(&lock);
+        traceDecision(adaptSet, lowest, "unknown", 0);
+        return lowest;
+    }
+    HybridContext ctxcopy = (*it).second;
+
+    const unsigned bps = getAvailableBw(currentBps, prevRep);
+
+    vlc_mutex_unlock(&lock);
+
+    BaseRepresentation *m;
+    const char *reason;
+    if(prevRep == nullptr || ctxcopy.buffering_level < ctxcopy.buffering_min)
+    {
+        /* Starting or draining, only trust throughput */
+        reason = prevRep ? "draining" : "startup";
+        m = selector.select(adaptSet, bps);
+        if(prevRep == nullptr && m == lowest)
+        {
+            /* Handle HLS specific cases where the lowest is audio only. Try to pick first A+V */
+            BaseRepresentation *n = selector.higher(adaptSet, m);
+            if(m != n  && m->getCodecs().size() == 1 && n->getCodecs().size() > 1)
+                m = n;
+        }
+    }
+    else
+    {
+        m = getBufferBasedRep(adaptSet, selector, ctxcopy);
+        reason = "buffer";
+
+        /* Highest rate still keeping the buffer above minimum after
+         * downloading a horizon of target duration at estimated rate */
+        const double horizon = std::max(secf_from_vlc_tick(ctxcopy.buffering_target), 1.0);
+        const double margin = secf_from_vlc_tick(ctxcopy.buffering_level - ctxcopy.buffering_min);
+        BaseRepresentation *mpc = selector.select(adaptSet, bps * (1.0 + margin / horizon));
+        if(mpc->getBandwidth() < m->getBandwidth())
+        {
+            m = mpc;
+            reason = "throughput";
+        }
+
+        /* Only step up when throughput sustains it, one representation at a time */
+        if(m->getBandwidth() > prevRep->getBandwidth())
+        {
+            BaseRepresentation *n = selector.select(adaptSet, bps);
+            reason = "step_up";
+            if(n->getBandwidth() <= prevRep->getBandwidth())
+            {
+                m = prevRep;
+                reason = "hold";
+            }
+            else if(n->getBandwidth() < m->getBandwidth())
+                m = n;
+            n = selector.higher(adaptSet, prevRep);
+            if(n->getBandwidth() < m->getBandwidth())
+                m = n;
+        }
+    }
+
+    BwDebug( msg_Info(p_obj, "buffering level %.2f%% rep %" PRIu64 " kBps %u kBps",
+             (float) 100 * ctxcopy.buffering_level / ctxcopy.buffering_target,
+             m->getBandwidth()/8000, bps / 8000); );
+
+    traceDecision(adaptSet, m, reason, bps, ctxcopy.buffering_level);
+
+    return m;
+}
+
+unsigned HybridAdaptationLogic::getAvailableBw(unsigned i_bw, const BaseRepresentation *curRep) const
+{
+    unsigned i_remain = i_bw;
+    if(i_remain > usedBps)
+        i_remain -= usedBps;
+    else
+        i_remain = 0;
+    if(curRep)
+        i_remain += curRep->getBandwidth();
+    return i_remain > i_bw ? i_bw : i_remain;
+}
+
+unsigned HybridAdaptationLogic::getMaxCurrentBw() const
+{
+    unsigned i_max_bitrate = 0;
+    for(std::map<ID, HybridContext>::const_iterator it = streams.begin();
+                                                    it != streams.end(); ++it)
+        i_max_bitrate = std::max(i_max_bitrate, ((*it).second).getEstimate());
+    return i_max_bitrate;
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
+                                               vlc_tick_t time, vlc_tick_t)
+{
+    if(unlikely(time == 0))
+        return;
+    const unsigned bps = CLOCK_FREQ * dlsize * 8 / time;
+    if(bps == 0)
+        return;
+
+    vlc_mutex_locker locker(&lock);
+    std::map<ID, HybridContext>::iterator it = streams.find(id);
+    if(it != streams.end())
+        (*it).second.push(bps);
+    currentBps = getMaxCurrentBw();
+}
+
+void HybridAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::RepresentationSwitch:
+        {
+            const RepresentationSwitchEvent &event =
+                    static_cast<const RepresentationSwitchEvent &>(ev);
+            vlc_mutex_locker locker(&lock);
+            if(event.prev)
+                usedBps -= event.prev->getBandwidth();
+            if(event.next)
+                usedBps += event.next->getBandwidth();
+            BwDebug(msg_Info(p_obj, "New total bandwidth usage %u kBps", (usedBps / 8000)));
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_locker locker(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                    streams.insert(std::pair<ID, HybridContext>(id, HybridContext()));
+            }
+            else
+            {
+                std::map<ID, HybridContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+                currentBps = getMaxCurrentBw();
+            }
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_locker locker(&lock);
+            /* only track streams which are enabled */
+            std::map<ID, HybridContext>::iterator it = streams.find(id);
+            if(it != streams.end())
+            {
+                HybridContext &ctx = (*it).second;
+                ctx.buffering_level = event.current;
+                ctx.buffering_target = event.target;
+                ctx.buffering_min = std::max(event.minimum, lowestBufferS);
+            }
+        }
+        break;
+
+    default:
+            break;
+    }
+}
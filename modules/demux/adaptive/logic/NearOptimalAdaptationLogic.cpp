@@ -103,7 +103,8 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     if(it == streams.end())
     {
         vlc_mutex_unlock(&lock);
-        return selector.lowest(adaptSet);
+        traceDecision(adaptSet, lowest, "unknown", 0);
+        return lowest;
     }
     NearOptimalContext ctxcopy = (*it).second;
 
@@ -115,8 +116,10 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     const float Vd = (secf_from_vlc_tick(ctxcopy.buffering_min) - 1.0) / (umin + gammaP);
 
     BaseRepresentation *m;
+    const char *reason;
     if(prevRep == nullptr) /* Starting */
     {
+        reason = "startup";
         m = selector.select(adaptSet, bps);
         if(m == lowest)
         {
@@ -131,8 +134,10 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
         /* noted m* */
         m = getNextQualityIndex(adaptSet, selector, gammaP - umin /* umin == Sm, utility = std::log(S/Sm) */,
                                 Vd, secf_from_vlc_tick(ctxcopy.buffering_level));
+        reason = "buffer";
         if(m->getBandwidth() < prevRep->getBandwidth()) /* m*[n] < m*[n-1] */
         {
+            reason = "buffer_throughput";
             BaseRepresentation *mp = selector.select(adaptSet, bps); /* m' */
             if(mp->getBandwidth() <= m->getBandwidth())
             {
@@ -153,6 +158,8 @@ BaseRepresentation *NearOptimalAdaptationLogic::getNextRepresentation(BaseAdapta
     BwDebug( msg_Info(p_obj, "buffering level %.2f%% rep %" PRId64 " kBps %u kBps",
              (float) 100 * ctxcopy.buffering_level / ctxcopy.buffering_target, m->getBandwidth()/8000, bps / 8000); );
 
+    traceDecision(adaptSet, m, reason, bps, ctxcopy.buffering_level);
+
     return m;
 }
 
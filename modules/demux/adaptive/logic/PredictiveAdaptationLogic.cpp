@@ -75,6 +75,7 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
     if(it == streams.end())
     {
         rep = selector.highest(adaptSet);
+        traceDecision(adaptSet, rep, "unknown", 0);
     }
     else
     {
@@ -98,39 +99,49 @@ BaseRepresentation *PredictiveAdaptationLogic::getNextRepresentation(BaseAdaptat
             }
         }
 
+        const char *reason;
+        unsigned i_available_bw = 0;
         if(stats.starting())
         {
             rep = selector.highest(adaptSet);
+            reason = "startup";
         }
         else
         {
-            const unsigned i_available_bw = getAvailableBw(i_max_bitrate, prevRep);
+            i_available_bw = getAvailableBw(i_max_bitrate, prevRep);
             if(!prevRep)
             {
                 rep = selector.select(adaptSet, i_available_bw);
+                reason = "throughput";
             }
             else if(f_buffering_level > 0.8)
             {
                 rep = selector.select(adaptSet, std::max((uint64_t) i_available_bw,
                                                          (uint64_t) prevRep->getBandwidth()));
+                reason = "buffer_high";
             }
             else if(f_buffering_level > 0.5)
             {
                 rep = prevRep;
+                reason = "buffer_hold";
             }
             else
             {
                 if(f_buffering_level > 2 * stats.last_duration)
                 {
                     rep = selector.lower(adaptSet, prevRep);
+                    reason = "buffer_low";
                 }
                 else
                 {
                     rep = selector.select(adaptSet, i_available_bw * f_buffering_level);
+                    reason = "buffer_low_throughput";
                 }
             }
         }
 
+        traceDecision(adaptSet, rep, reason, i_available_bw, stats.buffering_level);
+
         BwDebug( for(it=streams.begin(); it != streams.end(); ++it)
         {
             const PredictiveStats &s = (*it).second;
@@ -65,13 +65,16 @@ BaseRepresentation *RateBasedAdaptationLogic::getNextRepresentation(BaseAdaptati
 
     RepresentationSelector selector(maxwidth, maxheight);
     BaseRepresentation *rep = selector.select(adaptSet, availBps);
+    const char *reason = "throughput";
     if ( rep == nullptr )
     {
         rep = selector.select(adaptSet);
         if ( rep == nullptr )
             return nullptr;
+        reason = "fallback";
     }
 
+    traceDecision(adaptSet, rep, reason, availBps);
     return rep;
 }
 
@@ -140,5 +143,6 @@ BaseRepresentation *FixedRateAdaptationLogic::getNextRepresentation(BaseAdaptati
         if ( rep == nullptr )
             return nullptr;
     }
+    traceDecision(adaptSet, rep, "fixed", currentBps);
     return rep;
 }
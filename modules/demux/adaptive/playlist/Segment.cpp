@@ -37,6 +37,7 @@
 #include "../http/Downloader.hpp"
 #include <cassert>
 
+using namespace adaptive;
 using namespace adaptive::http;
 using namespace adaptive::playlist;
 
@@ -77,6 +78,30 @@ bool ISegment::prepareChunk(SharedResources *res, SegmentChunk *chunk, BaseRepre
     return true;
 }
 
+static ChunkPriority getStreamTypePriority(const BaseRepresentation *rep)
+{
+    /* Audio starves first and its segments are small: fetch them first.
+       Subtitles can wait behind video. */
+    const std::string &mime = rep->getMimeType();
+    if(mime.compare(0, 6, "audio/") == 0)
+        return ChunkPriority::High;
+    if(mime.compare(0, 5, "text/") == 0 ||
+       mime == "application/ttml+xml")
+        return ChunkPriority::Low;
+    switch(rep->getStreamFormat())
+    {
+        case StreamFormat::Type::PackedAAC:
+        case StreamFormat::Type::PackedMP3:
+        case StreamFormat::Type::PackedAC3:
+            return ChunkPriority::High;
+        case StreamFormat::Type::WebVTT:
+        case StreamFormat::Type::TTML:
+            return ChunkPriority::Low;
+        default:
+            return ChunkPriority::Normal;
+    }
+}
+
 SegmentChunk* ISegment::toChunk(SharedResources *res, size_t index, BaseRepresentation *rep)
 {
     const std::string url = getUrlSegment().toString(index, rep);
@@ -90,12 +115,11 @@ SegmentChunk* ISegment::toChunk(SharedResources *res, size_t index, BaseRepresen
         chunkType = ChunkType::Index;
     else
         chunkType = ChunkType::Segment;
-    AbstractChunkSource *source = res->getConnManager()->makeSource(url,
-                                                          rep->getAdaptationSet()->getID(),
-                                                          chunkType,
-                                                          range);
+    AbstractChunkSource *source = createSource(res, url, rep, chunkType, range);
     if(source)
     {
+        if(chunkType == ChunkType::Segment)
+            source->setPriority(getStreamTypePriority(rep));
         SegmentChunk *chunk = createChunk(source, rep);
         if(chunk)
         {
@@ -119,6 +143,19 @@ SegmentChunk* ISegment::toChunk(SharedResources *res, size_t index, BaseRepresen
     return nullptr;
 }
 
+AbstractChunkSource * ISegment::createSource(SharedResources *res, const std::string &url,
+                                             BaseRepresentation *rep, ChunkType type,
+                                             const BytesRange &range)
+{
+    return res->getConnManager()->makeSource(url, rep->getAdaptationSet()->getID(),
+                                             type, range);
+}
+
+bool ISegment::isComplete() const
+{
+    return true;
+}
+
 bool ISegment::isTemplate() const
 {
     return templated;
@@ -69,6 +69,8 @@ namespace adaptive
                 virtual size_t                          getOffset       () const;
                 virtual void                            debug           (vlc_object_t *,int = 0) const;
                 virtual bool                            contains        (size_t byte) const;
+                /* false while the live edge segment is still being produced */
+                virtual bool                            isComplete      () const;
                 void                                    setEncryption   (CommonEncryption &);
                 void                                    setDisplayTime  (vlc_tick_t);
                 vlc_tick_t                              getDisplayTime  () const;
@@ -77,6 +79,11 @@ namespace adaptive
                 bool                    discontinuity;
 
             protected:
+                virtual AbstractChunkSource *           createSource    (SharedResources *,
+                                                                         const std::string &,
+                                                                         BaseRepresentation *,
+                                                                         ChunkType,
+                                                                         const BytesRange &);
                 virtual bool                            prepareChunk    (SharedResources *,
                                                                          SegmentChunk *,
                                                                          BaseRepresentation *);
@@ -41,6 +41,7 @@ SegmentList::SegmentList( SegmentInformation *parent_, bool b_relative ):
 {
     totalLength = 0;
     b_relative_mediatimes = b_relative;
+    windowStart = std::numeric_limits<uint64_t>::max();
 }
 SegmentList::~SegmentList()
 {
@@ -96,12 +97,35 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     AbstractMultipleSegmentBaseType::updateWith(updated_);
 
     SegmentList *updated = dynamic_cast<SegmentList *>(updated_);
-    if(!updated || updated->segments.empty())
+    if(!updated)
         return;
 
+    if(updated->segments.empty())
+    {
+        if(updated->windowStart != std::numeric_limits<uint64_t>::max())
+            pruneBySegmentNumber(updated->windowStart);
+        return;
+    }
+
     b_restamp = b_relative_mediatimes;
 
-    if(!b_restamp || segments.empty())
+    /* update can omit the segments we already have */
+    const uint64_t oldest = (updated->windowStart != std::numeric_limits<uint64_t>::max())
+                          ? updated->windowStart
+                          : updated->segments.front()->getSequenceNumber();
+
+    /* live edge segment was still being produced, use the updated one */
+    if(!segments.empty() && !segments.back()->isComplete() &&
+       updated->segments.back()->getSequenceNumber() >= segments.back()->getSequenceNumber())
+    {
+        totalLength -= segments.back()->duration.Get();
+        delete segments.back();
+        segments.pop_back();
+    }
+
+    /* absolute timings: keep our segments only if the update continues them */
+    if(segments.empty() ||
+       (!b_restamp && oldest > segments.back()->getSequenceNumber() + 1))
     {
         if(!segments.empty())
             pruneBySegmentNumber(std::numeric_limits<uint64_t>::max());
@@ -109,22 +133,20 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
         for(auto seg : updated->segments)
             addSegment(seg);
         updated->segments.clear();
+        return;
     }
-    else
-    {
-        const Segment * prevSegment = segments.back();
-        const uint64_t oldest = updated->segments.front()->getSequenceNumber();
 
-        /* filter out known segments from the update */
-        updated->pruneBySegmentNumber(prevSegment->getSequenceNumber() + 1);
+    const Segment * prevSegment = segments.back();
 
-        if(updated->segments.empty())
-            return;
+    /* filter out known segments from the update */
+    updated->pruneBySegmentNumber(prevSegment->getSequenceNumber() + 1);
 
-        /* merge update with current list */
-        for(auto it = updated->segments.begin(); it != updated->segments.end(); ++it)
+    /* merge update with current list */
+    for(auto it = updated->segments.begin(); it != updated->segments.end(); ++it)
+    {
+        Segment *cur = *it;
+        if(b_restamp)
         {
-            Segment *cur = *it;
             cur->startTime.Set(prevSegment->startTime.Get() + prevSegment->duration.Get());
             /* not continuous */
             if(cur->getSequenceNumber() != prevSegment->getSequenceNumber() + 1)
@@ -134,14 +156,19 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
                 uint64_t gap = cur->getSequenceNumber() - prevSegment->getSequenceNumber() - 1;
                 cur->startTime.Set(cur->startTime.Get() + duration * gap);
             }
-            prevSegment = cur;
-            addSegment(cur);
         }
-        updated->segments.clear();
-
-        /* prune previous list using update window start */
-        pruneBySegmentNumber(oldest);
+        prevSegment = cur;
+        addSegment(cur);
     }
+    updated->segments.clear();
+
+    /* prune previous list using update window start */
+    pruneBySegmentNumber(oldest);
+}
+
+void SegmentList::setWindowStart(uint64_t number)
+{
+    windowStart = number;
 }
 
 void SegmentList::pruneByPlaybackTime(vlc_tick_t time)
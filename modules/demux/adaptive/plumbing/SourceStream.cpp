@@ -165,6 +165,11 @@ ssize_t ChunksSourceStream::Read(uint8_t *buf, size_t size)
             i_toread -= p_block->i_buffer;
             block_Release(p_block);
             p_block = nullptr;
+            /* Don't wait for the next block, callers
+             * wanting the full size will read again.
+             * Empty blocks are skipped, as 0 would mean EOF */
+            if(i_copied > 0)
+                break;
         }
     }
 
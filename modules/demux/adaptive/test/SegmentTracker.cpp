@@ -731,6 +731,116 @@ static int SegmentTracker_check_HLSseeks(BaseAdaptationSet *adaptSet,
     return 0;
 }
 
+/****** check prefetched chunks are dropped on switch and seek ******/
+static int SegmentTracker_check_prefetch(BaseAdaptationSet *adaptSet,
+                                         DummyLogic *logic,
+                                         SegmentTracker *tracker,
+                                         SegmentTrackerListener &events)
+{
+    const stime_t START = 1337;
+    Timescale timescale(100);
+
+    ChunkInterface *currentChunk = nullptr;
+    try
+    {
+        for(int r=0; r<2; r++)
+        {
+            DummyRepresentation *rep = new DummyRepresentation(adaptSet);
+            adaptSet->addRepresentation(rep);
+            rep->setID(ID(std::to_string(r)));
+
+            SegmentList *segmentList = nullptr;
+            try
+            {
+                segmentList = new SegmentList(rep);
+                segmentList->addAttribute(new TimescaleAttr(timescale));
+                for(int i=0; i<6; i++)
+                {
+                    Segment *seg = new Segment(rep);
+                    seg->setSequenceNumber(123 + i);
+                    seg->startTime.Set(START + 100 * i);
+                    seg->duration.Set(100);
+                    seg->setSourceUrl(r == 0 ? "sample/aac" : "sample/ac3");
+                    segmentList->addSegment(seg);
+                }
+            } catch (...) {
+                delete segmentList;
+                std::rethrow_exception(std::current_exception());
+            }
+            rep->addAttribute(segmentList);
+        }
+
+        tracker->setPrefetchCount(2);
+
+        events.reset();
+        Expect(tracker->setStartPosition() == true);
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(currentChunk->getContentType() == "sample/aac");
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* served from prefetched sequence */
+        events.reset();
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(currentChunk->getContentType() == "sample/aac");
+        Expect(events.occured(TrackerEvent::Type::RepresentationSwitch) == false);
+        Expect(events.occured(TrackerEvent::Type::SegmentGap) == false);
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START + 100) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* switch must not be delayed by prefetched chunks */
+        logic->repindex = 1;
+        events.reset();
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.occured(TrackerEvent::Type::RepresentationSwitch) == true);
+        Expect(currentChunk->getContentType() == "sample/ac3");
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START + 200) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* no switch while prefetched chunks are not dequeued */
+        events.reset();
+        currentChunk = tracker->getNextChunk(false);
+        Expect(currentChunk);
+        Expect(currentChunk->getContentType() == "sample/ac3");
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START + 300) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* seek drops prefetched */
+        events.reset();
+        Expect(tracker->setPositionByTime(VLC_TICK_0 + timescale.ToTime(START + 50), false, false) == true);
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk);
+        Expect(events.occured(TrackerEvent::Type::PositionChange) == true);
+        Expect(events.segmentchanged.starttime == timescale.ToTime(START) + VLC_TICK_0);
+        delete currentChunk;
+        currentChunk = nullptr;
+
+        /* up to the end */
+        for(int i=1; i<6; i++)
+        {
+            currentChunk = tracker->getNextChunk(true);
+            Expect(currentChunk);
+            delete currentChunk;
+            currentChunk = nullptr;
+        }
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk == nullptr);
+
+    } catch( ... ) {
+        delete currentChunk;
+        return 1;
+    }
+
+    return 0;
+}
+
 typedef decltype(SegmentTracker_check_formats) testfunc;
 
 static int Prepare_test(testfunc func)
@@ -786,5 +896,6 @@ int SegmentTracker_test()
         Prepare_test(SegmentTracker_check_seeks) ||
         Prepare_test(SegmentTracker_check_switches) ||
         Prepare_test(SegmentTracker_check_HLSseeks) ||
+        Prepare_test(SegmentTracker_check_prefetch) ||
         0;
 }
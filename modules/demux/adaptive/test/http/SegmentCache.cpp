@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * SegmentCache.cpp: on-disk segment cache tests
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../http/SegmentCache.hpp"
+
+#include "../test.hpp"
+
+#include <vlc_block.h>
+#include <vlc_fs.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace adaptive::http;
+
+#define DATA_SIZE 1000
+
+static block_t * MakeSegment(uint8_t fill)
+{
+    block_t *p_block = block_Alloc(DATA_SIZE);
+    if(p_block)
+        memset(p_block->p_buffer, fill, DATA_SIZE);
+    return p_block;
+}
+
+/* checks the cached segment content */
+static bool Has(SegmentCache &cache, const StorageID &id, uint8_t fill)
+{
+    std::string type;
+    block_t *p_block = cache.get(id, &type);
+    if(!p_block)
+        return false;
+    bool b_ok = p_block->i_buffer == DATA_SIZE && type == "video/mp4";
+    for(size_t i=0; b_ok && i<p_block->i_buffer; i++)
+        b_ok = p_block->p_buffer[i] == fill;
+    block_Release(p_block);
+    return b_ok;
+}
+
+static std::vector<std::string> ListFiles(const std::string &dir)
+{
+    std::vector<std::string> files;
+    vlc_DIR *d = vlc_opendir(dir.c_str());
+    if(d)
+    {
+        const char *psz_name;
+        while((psz_name = vlc_readdir(d)))
+            if(psz_name[0] != '.')
+                files.push_back(dir + DIR_SEP + psz_name);
+        vlc_closedir(d);
+    }
+    return files;
+}
+
+static void RemoveDir(const std::string &dir)
+{
+    for(const std::string &file : ListFiles(dir))
+        vlc_unlink(file.c_str());
+    rmdir(dir.c_str());
+}
+
+int SegmentCache_test()
+{
+    char tmpl[] = "/tmp/vlc_segcache_XXXXXX";
+    if(!mkdtemp(tmpl))
+        return 1;
+    const std::string dir(tmpl);
+
+    /* each entry takes its data, the ids, and a 12 bytes header */
+    const StorageID ids[] = { "http://host/seg1", "http://host/seg2",
+                              "http://host/seg3", "http://host/seg4" };
+    const size_t entrysize = 12 + ids[0].length() + 9 + DATA_SIZE;
+    block_t *segs[ARRAY_SIZE(ids)] = {};
+
+    try
+    {
+        for(size_t i=0; i<ARRAY_SIZE(ids); i++)
+        {
+            segs[i] = MakeSegment(i + 1);
+            Expect(segs[i]);
+        }
+
+        {
+            SegmentCache cache(nullptr, dir, entrysize * 2);
+            Expect(cache.init());
+
+            /* insert */
+            Expect(!Has(cache, ids[0], 1));
+            cache.put(ids[0], "video/mp4", segs[0]);
+            cache.put(ids[1], "video/mp4", segs[1]);
+            Expect(Has(cache, ids[0], 1));
+            Expect(Has(cache, ids[1], 2));
+            Expect(ListFiles(dir).size() == 2);
+
+            /* already cached */
+            cache.put(ids[1], "video/mp4", segs[2]);
+            Expect(Has(cache, ids[1], 2));
+
+            /* empty or too large */
+            block_t *p_empty = block_Alloc(0);
+            Expect(p_empty);
+            cache.put(ids[3], "video/mp4", p_empty);
+            block_Release(p_empty);
+            Expect(!Has(cache, ids[3], 4));
+            block_t *p_large = block_Alloc(entrysize * 2);
+            Expect(p_large);
+            cache.put(ids[3], "video/mp4", p_large);
+            block_Release(p_large);
+            Expect(!Has(cache, ids[3], 4));
+            Expect(ListFiles(dir).size() == 2);
+
+            /* eviction, seg1 got used last */
+            Expect(Has(cache, ids[0], 1));
+            cache.put(ids[2], "video/mp4", segs[2]);
+            Expect(!Has(cache, ids[1], 2));
+            Expect(Has(cache, ids[0], 1));
+            Expect(Has(cache, ids[2], 3));
+            Expect(ListFiles(dir).size() == 2);
+        }
+
+        /* leftover of an interrupted put */
+        int fd = vlc_open((dir + DIR_SEP "0123.seg.tmp").c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        Expect(fd != -1);
+        vlc_close(fd);
+
+        /* reload */
+        {
+            SegmentCache cache(nullptr, dir, entrysize * 2);
+            Expect(cache.init());
+            Expect(ListFiles(dir).size() == 2);
+            Expect(Has(cache, ids[0], 1));
+            Expect(Has(cache, ids[2], 3));
+            Expect(!Has(cache, ids[1], 2));
+
+            /* truncated entry gets dropped */
+            fd = vlc_open(ListFiles(dir).front().c_str(), O_WRONLY | O_TRUNC);
+            Expect(fd != -1);
+            vlc_close(fd);
+            Expect(Has(cache, ids[0], 1) != Has(cache, ids[2], 3));
+            Expect(ListFiles(dir).size() == 1);
+        }
+
+        {
+            SegmentCache cache(nullptr, dir, entrysize * 2);
+            Expect(cache.init());
+            cache.put(ids[3], "video/mp4", segs[3]);
+            Expect(Has(cache, ids[3], 4));
+            Expect(ListFiles(dir).size() == 2);
+        }
+
+        /* reload within a smaller bound evicts */
+        {
+            SegmentCache cache(nullptr, dir, entrysize);
+            Expect(cache.init());
+            Expect(ListFiles(dir).size() == 1);
+        }
+    } catch(...) {
+        for(size_t i=0; i<ARRAY_SIZE(segs); i++)
+            if(segs[i])
+                block_Release(segs[i]);
+        RemoveDir(dir);
+        return 1;
+    }
+
+    for(size_t i=0; i<ARRAY_SIZE(segs); i++)
+        block_Release(segs[i]);
+    RemoveDir(dir);
+    return 0;
+}
@@ -144,6 +144,16 @@ int BufferingLogic_test()
         Expect(bufferinglogic.getMinBuffering(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
         Expect(bufferinglogic.getLiveDelay(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
 
+        /* playlist hold back */
+        playlist->setMinBuffering(DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT / 2);
+        Expect(bufferinglogic.getMinBuffering(playlist) == DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT / 2);
+        Expect(bufferinglogic.getLiveDelay(playlist) == DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT / 2);
+        playlist->setMinBuffering(DefaultBufferingLogic::LOWLATENCY_LOWEST_LIMIT / 2);
+        Expect(bufferinglogic.getMinBuffering(playlist) == DefaultBufferingLogic::LOWLATENCY_LOWEST_LIMIT);
+        playlist->setMinBuffering(DefaultBufferingLogic::DEFAULT_MIN_BUFFERING);
+        Expect(bufferinglogic.getMinBuffering(playlist) == DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
+        playlist->setMinBuffering(0);
+
         playlist->b_lowlatency = false;
         Expect(bufferinglogic.getStartSegmentNumber(rep) == number);
 
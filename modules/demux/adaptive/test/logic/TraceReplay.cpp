@@ -0,0 +1,285 @@
+/*****************************************************************************
+ * TraceReplay.cpp: adaptation logics replayed over bandwidth traces
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/AbstractAdaptationLogic.h"
+#include "../../logic/RateBasedAdaptationLogic.h"
+#include "../../logic/PredictiveAdaptationLogic.hpp"
+#include "../../logic/NearOptimalAdaptationLogic.hpp"
+#include "../../logic/HybridAdaptationLogic.hpp"
+
+#include "../test.hpp"
+
+#include <algorithm>
+#include <memory>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace adaptive::logic;
+
+/* Replays a recorded bandwidth trace (piecewise constant link rate,
+ * looped when exhausted) through an adaptation logic, simulating
+ * segment downloads and playback of a single stream. */
+
+struct TraceStep
+{
+    unsigned ms;
+    unsigned kbps;
+};
+
+static const TraceStep trace_constant[] = {
+    { 60000, 4000 },
+};
+
+static const TraceStep trace_drop[] = {
+    { 40000, 5000 },
+    { 30000,  600 },
+    { 50000, 5000 },
+};
+
+static const TraceStep trace_fluctuating[] = {
+    { 3000, 6000 }, { 2000, 1500 }, { 4000, 3000 }, { 1000,  400 },
+    { 5000, 4500 }, { 3000,  900 }, { 2000, 7000 }, { 4000, 2000 },
+};
+
+static const vlc_tick_t SEGMENT_DURATION = VLC_TICK_FROM_SEC(2);
+static const vlc_tick_t MIN_BUFFERING = VLC_TICK_FROM_SEC(6);
+static const vlc_tick_t MAX_BUFFERING = VLC_TICK_FROM_SEC(30);
+static const vlc_tick_t TARGET_BUFFERING = VLC_TICK_FROM_SEC(15);
+static const unsigned SEGMENTS_COUNT = 90;
+
+class TraceReplay
+{
+    public:
+        TraceReplay(const TraceStep *s, size_t c) : steps(s), count(c) {}
+
+        /* returns the time needed to transfer bits starting at time */
+        vlc_tick_t download(vlc_tick_t time, uint64_t bits) const
+        {
+            vlc_tick_t period = 0;
+            for(size_t i=0; i<count; i++)
+                period += VLC_TICK_FROM_MS(steps[i].ms);
+
+            vlc_tick_t elapsed = 0;
+            for(;;)
+            {
+                /* locate current step */
+                vlc_tick_t offset = (time + elapsed) % period;
+                size_t i = 0;
+                for(; offset >= VLC_TICK_FROM_MS(steps[i].ms); i++)
+                    offset -= VLC_TICK_FROM_MS(steps[i].ms);
+                const vlc_tick_t left = VLC_TICK_FROM_MS(steps[i].ms) - offset;
+                const uint64_t bps = steps[i].kbps * UINT64_C(1000);
+                const uint64_t stepbits = bps * left / CLOCK_FREQ;
+                if(stepbits >= bits)
+                    return elapsed + (bits * CLOCK_FREQ + bps - 1) / bps;
+                bits -= stepbits;
+                elapsed += left;
+            }
+        }
+
+    private:
+        const TraceStep *steps;
+        size_t count;
+};
+
+struct ReplayStats
+{
+    vlc_tick_t startup = -1;
+    vlc_tick_t played = 0;
+    vlc_tick_t stalled = 0;
+    unsigned switches = 0;
+    unsigned downswitches = 0;
+    unsigned upjumps = 0; /* after startup, up by more than one representation */
+    uint64_t bitrates = 0;
+};
+
+static ReplayStats Replay(AbstractAdaptationLogic *logic, BaseAdaptationSet *set,
+                          const TraceReplay &trace)
+{
+    ReplayStats stats;
+    const ID &id = set->getID();
+    const std::vector<BaseRepresentation *> &reps = set->getRepresentations();
+    vlc_tick_t now = 0;
+    vlc_tick_t buffering = 0;
+    BaseRepresentation *prev = nullptr;
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, true));
+
+    for(unsigned i=0; i<SEGMENTS_COUNT; i++)
+    {
+        BaseRepresentation *rep = logic->getNextRepresentation(set, prev);
+        if(rep == nullptr)
+            break;
+        if(rep != prev)
+        {
+            logic->trackerEvent(RepresentationSwitchEvent(prev, rep));
+            if(prev)
+            {
+                const auto from = std::find(reps.begin(), reps.end(), prev);
+                const auto to = std::find(reps.begin(), reps.end(), rep);
+                stats.switches++;
+                if(to < from)
+                    stats.downswitches++;
+                else if(to - from > 1 && stats.startup >= 0)
+                    stats.upjumps++;
+            }
+            prev = rep;
+        }
+
+        const uint64_t bits = rep->getBandwidth() * SEGMENT_DURATION / CLOCK_FREQ;
+        const vlc_tick_t duration = trace.download(now, bits);
+        if(stats.startup >= 0)
+        {
+            if(buffering >= duration)
+            {
+                stats.played += duration;
+                buffering -= duration;
+            }
+            else
+            {
+                stats.played += buffering;
+                stats.stalled += duration - buffering;
+                buffering = 0;
+            }
+        }
+        now += duration;
+        buffering += SEGMENT_DURATION;
+        stats.bitrates += rep->getBandwidth();
+
+        if(stats.startup < 0 && buffering >= MIN_BUFFERING)
+            stats.startup = now;
+
+        logic->updateDownloadRate(id, bits / 8, duration, now);
+
+        /* Wait for room in buffer before next request */
+        if(buffering > MAX_BUFFERING)
+        {
+            stats.played += buffering - MAX_BUFFERING;
+            now += buffering - MAX_BUFFERING;
+            buffering = MAX_BUFFERING;
+        }
+
+        logic->trackerEvent(BufferingLevelChangedEvent(id, MIN_BUFFERING, MAX_BUFFERING,
+                                                       buffering, TARGET_BUFFERING));
+    }
+
+    stats.played += buffering;
+    stats.bitrates /= SEGMENTS_COUNT;
+    return stats;
+}
+
+int TraceReplay_test()
+{
+    BasePlaylist *playlist = nullptr;
+    try
+    {
+        playlist = new BasePlaylist(nullptr);
+        BasePeriod *period = new BasePeriod(playlist);
+        playlist->addPeriod(period);
+        BaseAdaptationSet *set = new BaseAdaptationSet(period);
+        set->setID(ID("video"));
+        period->addAdaptationSet(set);
+        const uint64_t bandwidths[] = { 400000, 1000000, 2500000, 6000000 };
+        for(uint64_t bw : bandwidths)
+        {
+            BaseRepresentation *rep = new BaseRepresentation(set);
+            rep->setBandwidth(bw);
+            set->addRepresentation(rep);
+        }
+        const std::vector<BaseRepresentation *> &reps = set->getRepresentations();
+
+        const struct
+        {
+            const char *name;
+            TraceReplay trace;
+        } traces[] = {
+            { "constant",    TraceReplay(trace_constant,    ARRAY_SIZE(trace_constant)) },
+            { "drop",        TraceReplay(trace_drop,        ARRAY_SIZE(trace_drop)) },
+            { "fluctuating", TraceReplay(trace_fluctuating, ARRAY_SIZE(trace_fluctuating)) },
+        };
+
+        for(size_t j=0; j<ARRAY_SIZE(traces); j++)
+        {
+            const auto &t = traces[j];
+            std::unique_ptr<AbstractAdaptationLogic> logics[] = {
+                std::unique_ptr<AbstractAdaptationLogic>(new RateBasedAdaptationLogic(nullptr)),
+                std::unique_ptr<AbstractAdaptationLogic>(new PredictiveAdaptationLogic(nullptr)),
+                std::unique_ptr<AbstractAdaptationLogic>(new NearOptimalAdaptationLogic(nullptr)),
+                std::unique_ptr<AbstractAdaptationLogic>(new HybridAdaptationLogic(nullptr)),
+            };
+            ReplayStats stats;
+            for(size_t i=0; i<ARRAY_SIZE(logics); i++)
+            {
+                stats = Replay(logics[i].get(), set, t.trace);
+                /* every logic starts, and every segment gets played */
+                Expect(stats.startup >= 0);
+                Expect(stats.played == SEGMENTS_COUNT * SEGMENT_DURATION);
+            }
+
+            /* Hybrid was replayed last. The link never drops below the
+             * lowest representation, so falling back to it avoids stalls */
+            Expect(stats.stalled == 0);
+            /* once started, climbs one representation at a time without oscillating */
+            Expect(stats.upjumps == 0);
+            Expect(stats.switches <= SEGMENTS_COUNT / 10);
+            if(j == 0)
+            {
+                /* link never drops below the 2.5 Mbps representation */
+                Expect(stats.downswitches == 0);
+                Expect(stats.bitrates > reps[1]->getBandwidth());
+            }
+        }
+
+        /* Stream not known yet */
+        HybridAdaptationLogic logic(nullptr);
+        Expect(logic.getNextRepresentation(set, nullptr) == reps.front());
+
+        /* Starts on throughput then climbs one step at a time */
+        logic.trackerEvent(BufferingStateUpdatedEvent(set->getID(), true));
+        logic.updateDownloadRate(set->getID(), 400000, VLC_TICK_FROM_SEC(1), 0);
+        BaseRepresentation *rep = logic.getNextRepresentation(set, nullptr);
+        Expect(rep == reps[2]);
+        logic.trackerEvent(RepresentationSwitchEvent(nullptr, rep));
+        logic.trackerEvent(BufferingLevelChangedEvent(set->getID(), MIN_BUFFERING, MAX_BUFFERING,
+                                                      MAX_BUFFERING, TARGET_BUFFERING));
+        logic.updateDownloadRate(set->getID(), 100000000, VLC_TICK_FROM_SEC(1), 0);
+        Expect(logic.getNextRepresentation(set, reps[0]) == reps[1]);
+
+        /* Buffer draining, falls back to throughput */
+        logic.trackerEvent(BufferingLevelChangedEvent(set->getID(), MIN_BUFFERING, MAX_BUFFERING,
+                                                      0, TARGET_BUFFERING));
+        logic.updateDownloadRate(set->getID(), 10000, VLC_TICK_FROM_SEC(1), 0);
+        Expect(logic.getNextRepresentation(set, reps[3]) == reps[0]);
+
+        delete playlist;
+    } catch(...) {
+        delete playlist;
+        return 1;
+    }
+
+    return 0;
+}
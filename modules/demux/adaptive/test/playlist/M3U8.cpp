@@ -543,5 +543,92 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 6, low latency */
+    const char manifest6[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=1.0\n"
+    "#EXT-X-PART-INF:PART-TARGET=0.5\n"
+    "#EXT-X-MEDIA-SEQUENCE:20\n"
+    "#EXTINF:4\n"
+    "seg20.mp4\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"part21.0.mp4\",INDEPENDENT=YES\n"
+    "#EXTINF:4\n"
+    "seg21.mp4\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"part22.mp4\",BYTERANGE=\"1000@0\",INDEPENDENT=YES\n"
+    "#EXT-X-PART:DURATION=0.5,URI=\"part22.mp4\",BYTERANGE=\"800\"\n"
+    "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"part22.mp4\",BYTERANGE-START=1800\n";
+
+    m3u = ParseM3U8(obj, manifest6, sizeof(manifest6));
+    try
+    {
+        bufferingLogic = DefaultBufferingLogic();
+        Expect(m3u);
+        Expect(m3u->isLive() == true);
+        Expect(m3u->isLowLatency() == true);
+        Expect(m3u->getMinBuffering() == VLC_TICK_FROM_SEC(1));
+        Expect(bufferingLogic.getMinBuffering(m3u) == VLC_TICK_FROM_SEC(1));
+        BaseRepresentation *rep = m3u->getFirstPeriod()->getAdaptationSets().front()->
+                                  getRepresentations().front();
+        Expect(rep->getMediaSegment(21));
+        Expect(rep->getMediaSegment(21)->isComplete());
+        ISegment *seg = rep->getMediaSegment(22);
+        Expect(seg);
+        Expect(!seg->isComplete());
+        Expect(seg->duration.Get() == rep->inheritTimescale().ToScaled(VLC_TICK_FROM_SEC(1)));
+        Expect(!rep->needsUpdate(22));
+        /* published parts already fill the hold back */
+        Expect(bufferingLogic.getStartSegmentNumber(rep) == 22);
+        Expect(HLSRepresentation::getBlockingReloadUrl("http://example.com/p.m3u8", 23, 0) ==
+               "http://example.com/p.m3u8?_HLS_msn=23&_HLS_part=0");
+        Expect(HLSRepresentation::getBlockingReloadUrl("http://example.com/p.m3u8?a=b", 22, 2) ==
+               "http://example.com/p.m3u8?a=b&_HLS_msn=22&_HLS_part=2");
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
+    /* Manifest 7, delta update */
+    const char manifest7[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-SKIP-UNTIL=24.0\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXT-X-SKIP:SKIPPED-SEGMENTS=3\n"
+    "#EXTINF:4\n"
+    "seg13.ts\n"
+    "#EXTINF:4\n"
+    "seg14.ts\n";
+
+    m3u = ParseM3U8(obj, manifest7, sizeof(manifest7));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive() == true);
+        HLSRepresentation *rep = static_cast<HLSRepresentation *>(m3u->getFirstPeriod()->
+                                 getAdaptationSets().front()->getRepresentations().front());
+        Expect(rep->canSkipSegments());
+        Expect(rep->getMediaSegment(12) == nullptr);
+        Expect(rep->getMediaSegment(13));
+        Expect(rep->getMediaSegment(14));
+        Expect(rep->getMediaSegment(15) == nullptr);
+        Expect(HLSRepresentation::getDeltaUpdateUrl("http://example.com/p.m3u8") ==
+               "http://example.com/p.m3u8?_HLS_skip=YES");
+        Expect(HLSRepresentation::getDeltaUpdateUrl(
+               HLSRepresentation::getBlockingReloadUrl("http://example.com/p.m3u8", 15, 0)) ==
+               "http://example.com/p.m3u8?_HLS_msn=15&_HLS_part=0&_HLS_skip=YES");
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
+
     return 0;
 }
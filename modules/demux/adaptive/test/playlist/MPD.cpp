@@ -0,0 +1,426 @@
+/*****************************************************************************
+ * MPD.cpp: DOM and streamed MPD parsing tests
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../playlist/SegmentTemplate.h"
+#include "../../playlist/SegmentTimeline.h"
+#include "../../xml/DOMParser.h"
+#include "../../../dash/mpd/IsoffMainParser.h"
+#include "../../../dash/mpd/MPD.h"
+#include "../../../dash/mpd/MPDPatch.h"
+
+#include "../test.hpp"
+
+#include <vlc_xml.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace dash::mpd;
+
+/* Replays a synthetic MPD as xml reader events,
+ * so both parsing modes can run without the xml module */
+class FakeReader
+{
+    public:
+        class Event
+        {
+            public:
+                int type;
+                std::string name;
+                std::vector<std::pair<std::string, std::string>> attrs;
+                bool empty;
+        };
+
+        FakeReader()
+        {
+            std::memset(&reader, 0, sizeof(reader));
+            reader.p_sys = this;
+            reader.pf_next_node = NextNode;
+            reader.pf_next_attr = NextAttr;
+            reader.pf_is_empty = IsEmpty;
+        }
+
+        void start(const char *name,
+                   std::vector<std::pair<std::string, std::string>> attrs = {},
+                   bool empty = false)
+        {
+            events.push_back({XML_READER_STARTELEM, name, std::move(attrs), empty});
+        }
+
+        void end(const char *name)
+        {
+            events.push_back({XML_READER_ENDELEM, name, {}, false});
+        }
+
+        void text(const char *value)
+        {
+            events.push_back({XML_READER_TEXT, value, {}, false});
+        }
+
+        xml_reader_t * rewind()
+        {
+            pos = 0;
+            attr = 0;
+            return &reader;
+        }
+
+    private:
+        static int NextNode(xml_reader_t *p_reader, const char **pval, const char **pns)
+        {
+            FakeReader *sys = static_cast<FakeReader *>(p_reader->p_sys);
+            if(sys->pos >= sys->events.size())
+                return XML_READER_NONE;
+            const Event &ev = sys->events[sys->pos++];
+            sys->attr = 0;
+            *pval = ev.name.c_str();
+            if(pns)
+                *pns = NS_DASH.c_str();
+            return ev.type;
+        }
+
+        static const char *NextAttr(xml_reader_t *p_reader, const char **pval, const char **pns)
+        {
+            FakeReader *sys = static_cast<FakeReader *>(p_reader->p_sys);
+            const Event &ev = sys->events[sys->pos - 1];
+            if(sys->attr >= ev.attrs.size())
+                return nullptr;
+            const auto &a = ev.attrs[sys->attr++];
+            *pval = a.second.c_str();
+            if(pns)
+                *pns = nullptr; /* unprefixed */
+            return a.first.c_str();
+        }
+
+        static int IsEmpty(xml_reader_t *p_reader)
+        {
+            FakeReader *sys = static_cast<FakeReader *>(p_reader->p_sys);
+            return sys->events[sys->pos - 1].empty;
+        }
+
+        xml_reader_t reader;
+        std::vector<Event> events;
+        size_t pos = 0;
+        size_t attr = 0;
+};
+
+static void GenerateMPD(FakeReader &fake, unsigned periods, unsigned sets,
+                        unsigned reps, unsigned timeline)
+{
+    fake.start("MPD", {{"type", "static"}});
+    fake.start("BaseURL");
+    fake.end("BaseURL");
+    for(unsigned p=0; p<periods; p++)
+    {
+        fake.start("Period", {{"id", std::to_string(p)},
+                              {"start", "PT" + std::to_string(p * 60) + "S"}});
+        for(unsigned a=0; a<sets; a++)
+        {
+            fake.start("AdaptationSet", {{"id", std::to_string(a)},
+                                         {"mimeType", "video/mp4"}});
+            fake.start("SegmentTemplate", {{"timescale", "1000"},
+                                           {"media", "$RepresentationID$/$Time$.m4s"}});
+            fake.start("SegmentTimeline");
+            for(unsigned s=0; s<timeline; s++)
+            {
+                if(s == 0)
+                    fake.start("S", {{"t", "0"}, {"d", "2000"}}, true);
+                else
+                    fake.start("S", {{"d", (s % 2) ? "2000" : "1960"}}, true);
+            }
+            fake.end("SegmentTimeline");
+            fake.end("SegmentTemplate");
+            for(unsigned r=0; r<reps; r++)
+                fake.start("Representation", {{"id", std::to_string(a * reps + r)},
+                                              {"bandwidth", std::to_string(100000 * (r + 1))}},
+                           true);
+            fake.end("AdaptationSet");
+        }
+        fake.end("Period");
+    }
+    fake.end("MPD");
+}
+
+static stime_t TimelineLength(MPD *mpd)
+{
+    stime_t length = 0;
+    for(const BasePeriod *period : mpd->getPeriods())
+        for(const BaseAdaptationSet *set : period->getAdaptationSets())
+            for(const BaseRepresentation *rep : set->getRepresentations())
+            {
+                const SegmentTemplate *templ = rep->inheritSegmentTemplate();
+                const SegmentTimeline *tl = templ ? templ->inheritSegmentTimeline() : nullptr;
+                if(tl)
+                    length += tl->getTotalLength();
+            }
+    return length;
+}
+
+static size_t RepresentationsCount(MPD *mpd)
+{
+    size_t count = 0;
+    for(const BasePeriod *period : mpd->getPeriods())
+        for(const BaseAdaptationSet *set : period->getAdaptationSets())
+            count += set->getRepresentations().size();
+    return count;
+}
+
+static MPD * ParseDOM(FakeReader &fake)
+{
+    xml::DOMParser parser(fake.rewind());
+    if(!parser.parse(true))
+        return nullptr;
+    IsoffMainParser mpdparser(parser.getRootNode(), nullptr, nullptr,
+                              std::string("stdin://"));
+    return mpdparser.parse();
+}
+
+static MPD * ParseStreamed(FakeReader &fake)
+{
+    xml::DOMParser parser(fake.rewind());
+    if(!parser.parse(true, "Period"))
+        return nullptr;
+    IsoffMainParser mpdparser(&parser, nullptr, nullptr,
+                              std::string("stdin://"));
+    return mpdparser.parse();
+}
+
+int MPDParse_test()
+{
+    MPD *dommpd = nullptr;
+    MPD *streamedmpd = nullptr;
+
+    try
+    {
+        const unsigned PERIODS = 4, SETS = 2, REPS = 3, TIMELINE = 10;
+        FakeReader fake;
+        GenerateMPD(fake, PERIODS, SETS, REPS, TIMELINE);
+
+        dommpd = ParseDOM(fake);
+        Expect(dommpd);
+        streamedmpd = ParseStreamed(fake);
+        Expect(streamedmpd);
+
+        Expect(dommpd->getPeriods().size() == PERIODS);
+        Expect(streamedmpd->getPeriods().size() == PERIODS);
+        Expect(RepresentationsCount(dommpd) == PERIODS * SETS * REPS);
+        Expect(RepresentationsCount(streamedmpd) == RepresentationsCount(dommpd));
+        Expect(TimelineLength(dommpd) > 0);
+        Expect(TimelineLength(streamedmpd) == TimelineLength(dommpd));
+        for(size_t i=0; i<PERIODS; i++)
+        {
+            Expect(streamedmpd->getPeriods()[i]->getID() == dommpd->getPeriods()[i]->getID());
+            Expect(streamedmpd->getPeriods()[i]->getPeriodStart() ==
+                   dommpd->getPeriods()[i]->getPeriodStart());
+        }
+
+        delete dommpd;
+        dommpd = nullptr;
+        delete streamedmpd;
+        streamedmpd = nullptr;
+
+        /* truncated documents */
+        FakeReader truncated;
+        truncated.start("MPD");
+        truncated.start("Period", {{"id", "0"}});
+        truncated.start("AdaptationSet");
+        {
+            xml::DOMParser parser(truncated.rewind());
+            Expect(parser.parse(true, "Period"));
+            Expect(parser.getNextNode() == nullptr);
+        }
+
+        /* a parser without any reader yet can be reset,
+         * as done before parsing manifests from the stream */
+        {
+            xml::DOMParser parser;
+            Expect(parser.reset(nullptr));
+            Expect(parser.getRootNode() == nullptr);
+        }
+
+        FakeReader empty;
+        empty.start("MPD", {}, true);
+        {
+            xml::DOMParser parser(empty.rewind());
+            Expect(parser.parse(true, "Period"));
+            Expect(parser.getRootNode());
+            Expect(parser.getNextNode() == nullptr);
+        }
+    }
+    catch (...)
+    {
+        delete dommpd;
+        delete streamedmpd;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void GenerateLiveMPD(FakeReader &fake, const char *location)
+{
+    fake.start("MPD", {{"type", "dynamic"}, {"id", "live"},
+                       {"publishTime", "2026-01-01T00:00:00Z"}});
+    fake.start("BaseURL");
+    fake.text("http://cdn.example.com/live/");
+    fake.end("BaseURL");
+    if(location)
+    {
+        fake.start("Location");
+        fake.text(location);
+        fake.end("Location");
+    }
+    fake.start("PatchLocation");
+    fake.text("patch.mpp");
+    fake.end("PatchLocation");
+    fake.start("Period", {{"id", "p0"}, {"start", "PT0S"}});
+    fake.start("AdaptationSet", {{"id", "1"}, {"mimeType", "video/mp4"}});
+    fake.start("SegmentTemplate", {{"timescale", "1000"}, {"media", "$Time$.m4s"}});
+    fake.start("SegmentTimeline");
+    fake.start("S", {{"t", "0"}, {"d", "2000"}, {"r", "4"}}, true);
+    fake.end("SegmentTimeline");
+    fake.end("SegmentTemplate");
+    fake.start("Representation", {{"id", "v0"}, {"bandwidth", "100000"}}, true);
+    fake.end("AdaptationSet");
+    fake.end("Period");
+    fake.end("MPD");
+}
+
+#define PATCH_TIMELINE "/MPD/Period[@id='p0']/AdaptationSet[@id='1']" \
+                       "/SegmentTemplate/SegmentTimeline"
+
+static void StartPatch(FakeReader &fake, const char *original, const char *publish)
+{
+    fake.start("Patch", {{"mpdId", "live"}, {"originalPublishTime", original},
+                         {"publishTime", publish}});
+}
+
+static void AddTimeline(FakeReader &fake, const char *t, const char *d, const char *r,
+                        std::vector<std::pair<std::string, std::string>> opattrs = {})
+{
+    opattrs.push_back({"sel", PATCH_TIMELINE});
+    fake.start("add", opattrs);
+    fake.start("S", {{"t", t}, {"d", d}, {"r", r}}, true);
+    fake.end("add");
+}
+
+static bool ApplyPatch(FakeReader &fake, MPD *mpd)
+{
+    xml::DOMParser parser(fake.rewind());
+    if(!parser.parse(true))
+        return false;
+    MPDPatch patch(parser.getRootNode());
+    return patch.apply(mpd);
+}
+
+int MPDPatch_test()
+{
+    MPD *mpd = nullptr;
+
+    try
+    {
+        FakeReader fake;
+        GenerateLiveMPD(fake, nullptr);
+        mpd = ParseDOM(fake);
+        Expect(mpd);
+        Expect(TimelineLength(mpd) == 10000);
+        Expect(mpd->getPatchLocation() == "patch.mpp");
+        /* relative to the BaseURL */
+        Expect(mpd->getPatchUrl().toString() == "http://cdn.example.com/live/patch.mpp");
+
+        /* remove, add and replace */
+        FakeReader patch;
+        StartPatch(patch, "2026-01-01T00:00:00Z", "2026-01-01T00:00:10Z");
+        patch.start("replace", {{"sel", "/MPD/@publishTime"}});
+        patch.text("2026-01-01T00:00:10Z");
+        patch.end("replace");
+        patch.start("replace", {{"sel", "/MPD/PatchLocation"}});
+        patch.start("PatchLocation");
+        patch.text("/patches/live.mpp");
+        patch.end("PatchLocation");
+        patch.end("replace");
+        patch.start("remove", {{"sel", PATCH_TIMELINE "/S[1]"}}, true);
+        /* overlaps the last two segments */
+        AddTimeline(patch, "6000", "2000", "3");
+        patch.end("Patch");
+        Expect(ApplyPatch(patch, mpd));
+        Expect(TimelineLength(mpd) == 14000);
+        Expect(mpd->getPatchLocation() == "/patches/live.mpp");
+        Expect(mpd->getPatchUrl().toString() == "http://cdn.example.com/patches/live.mpp");
+
+        /* publish times must follow */
+        Expect(!ApplyPatch(patch, mpd));
+        Expect(TimelineLength(mpd) == 14000);
+
+        FakeReader next;
+        StartPatch(next, "2026-01-01T00:00:10Z", "2026-01-01T00:00:12Z");
+        AddTimeline(next, "14000", "1000", "1");
+        next.end("Patch");
+        Expect(ApplyPatch(next, mpd));
+        Expect(TimelineLength(mpd) == 16000);
+
+        /* any unsupported operation rejects the whole patch */
+        FakeReader unsupported;
+        StartPatch(unsupported, "2026-01-01T00:00:12Z", "2026-01-01T00:00:14Z");
+        AddTimeline(unsupported, "16000", "2000", "0");
+        AddTimeline(unsupported, "18000", "2000", "0", {{"pos", "before"}});
+        unsupported.end("Patch");
+        Expect(!ApplyPatch(unsupported, mpd));
+        Expect(TimelineLength(mpd) == 16000);
+
+        /* unknown timeline */
+        FakeReader unknown;
+        StartPatch(unknown, "2026-01-01T00:00:12Z", "2026-01-01T00:00:14Z");
+        unknown.start("add", {{"sel", "/MPD/Period[@id='p1']/AdaptationSet[@id='1']"
+                                      "/SegmentTemplate/SegmentTimeline"}});
+        unknown.start("S", {{"t", "16000"}, {"d", "2000"}}, true);
+        unknown.end("add");
+        unknown.end("Patch");
+        Expect(!ApplyPatch(unknown, mpd));
+        Expect(TimelineLength(mpd) == 16000);
+
+        delete mpd;
+        mpd = nullptr;
+
+        /* relative to the MPD Location over the BaseURL */
+        FakeReader moved;
+        GenerateLiveMPD(moved, "http://origin.example.com/live/manifest.mpd");
+        mpd = ParseDOM(moved);
+        Expect(mpd);
+        Expect(mpd->getPatchUrl().toString() == "http://origin.example.com/live/patch.mpp");
+
+        delete mpd;
+    }
+    catch (...)
+    {
+        delete mpd;
+        return 1;
+    }
+
+    return 0;
+}
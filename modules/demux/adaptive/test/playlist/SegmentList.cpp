@@ -233,6 +233,46 @@ int SegmentList_test() try
     segmentList.reset();
     segmentList2.reset();
 
+    /* tail only updates, known segments are kept */
+    segmentList = std::make_unique<SegmentList>(nullptr, false);
+    segmentList->addAttribute(new TimescaleAttr(timescale));
+    for(int i=0; i<4; i++)
+    {
+        seg = std::make_unique<Segment>(nullptr);
+        seg->setSequenceNumber(123 + i);
+        seg->startTime.Set(START + 100 * i);
+        seg->duration.Set(100);
+        segmentList->addSegment(seg.release());
+    }
+    segptr = segmentList->getMediaSegment(125);
+    segmentList2 = std::make_unique<SegmentList>(nullptr, false);
+    segmentList2->setWindowStart(124);
+    for(int i=4; i<6; i++)
+    {
+        seg = std::make_unique<Segment>(nullptr);
+        seg->setSequenceNumber(123 + i);
+        seg->startTime.Set(START + 100 * i);
+        seg->duration.Set(100);
+        segmentList2->addSegment(seg.release());
+    }
+    segmentList->updateWith(segmentList2.get());
+    Expect(segmentList->getStartSegmentNumber() == 124);
+    Expect(segmentList->getSegments().size() == 5);
+    Expect(segmentList->getMediaSegment(125) == segptr);
+    Expect(segmentList->getTotalLength() == 100 * 5);
+    Expect(segmentList->getMediaSegment(128)->startTime.Get() == START + 100 * 5);
+
+    /* nothing new, window still moves */
+    segmentList2 = std::make_unique<SegmentList>(nullptr, false);
+    segmentList2->setWindowStart(126);
+    segmentList->updateWith(segmentList2.get());
+    Expect(segmentList->getStartSegmentNumber() == 126);
+    Expect(segmentList->getSegments().size() == 3);
+    Expect(segmentList->getTotalLength() == 100 * 3);
+
+    segmentList.reset();
+    segmentList2.reset();
+
     /* Tricky now, check timelined */
     segmentList = std::make_unique<SegmentList>(nullptr);
     segmentList->addAttribute(new TimescaleAttr(timescale));
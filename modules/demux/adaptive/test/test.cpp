@@ -46,9 +46,13 @@ int main()
     TEST(Conversions) ||
     TEST(TemplatedUri) ||
     TEST(BufferingLogic) ||
+    TEST(TraceReplay) ||
     TEST(CommandsQueue) ||
     TEST(M3U8MasterPlaylist) ||
     TEST(M3U8Playlist) ||
-    TEST(SegmentTracker)
+    TEST(MPDParse) ||
+    TEST(MPDPatch) ||
+    TEST(SegmentTracker) ||
+    TEST(SegmentCache)
     ;
 }
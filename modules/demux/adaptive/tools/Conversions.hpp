@@ -24,6 +24,8 @@
 #include <vlc_tick.h>
 #include <string>
 #include <sstream>
+#include <charconv>
+#include <type_traits>
 
 class IsoTime
 {
@@ -50,6 +52,25 @@ template<typename T> class Integer
     public:
         Integer(const std::string &str)
         {
+            /* plain decimals, as in large timelines, without the stream */
+            if constexpr(std::is_integral<T>::value && !std::is_same<T, bool>::value)
+            {
+                const char *p = str.data();
+                const char *end = p + str.size();
+                if(p != end && ((*p >= '0' && *p <= '9') ||
+                                (std::is_signed<T>::value && *p == '-')))
+                {
+                    std::from_chars_result res = std::from_chars(p, end, value);
+                    if(res.ec == std::errc())
+                        return;
+                    if(res.ec == std::errc::result_out_of_range)
+                    {
+                        value = 0;
+                        return;
+                    }
+                }
+            }
+
             try
             {
                 std::istringstream in(str);
@@ -37,21 +37,38 @@ using namespace adaptive::xml;
 DOMParser::DOMParser() :
     root( nullptr ),
     stream( nullptr ),
-    vlc_reader( nullptr )
+    vlc_reader( nullptr ),
+    b_own_reader( true ),
+    streamedNext( nullptr ),
+    b_streamedEnd( false )
 {
 }
 
 DOMParser::DOMParser    (stream_t *stream) :
     root( nullptr ),
     stream( stream ),
-    vlc_reader( nullptr )
+    vlc_reader( nullptr ),
+    b_own_reader( true ),
+    streamedNext( nullptr ),
+    b_streamedEnd( false )
+{
+}
+
+DOMParser::DOMParser    (xml_reader_t *reader) :
+    root( nullptr ),
+    stream( nullptr ),
+    vlc_reader( reader ),
+    b_own_reader( false ),
+    streamedNext( nullptr ),
+    b_streamedEnd( false )
 {
 }
 
 DOMParser::~DOMParser   ()
 {
+    releaseStreamed();
     delete this->root;
-    if(this->vlc_reader)
+    if(this->vlc_reader && b_own_reader)
         xml_ReaderDelete(this->vlc_reader);
 }
 
@@ -61,10 +78,7 @@ Node*   DOMParser::getRootNode              ()
 }
 bool    DOMParser::parse                    (bool b)
 {
-    if(!stream)
-        return false;
-
-    if(!vlc_reader && !(vlc_reader = xml_ReaderCreate(stream, stream)))
+    if(!vlc_reader && (!stream || !(vlc_reader = xml_ReaderCreate(stream, stream))))
         return false;
 
     struct vlc_logger *const logger = vlc_reader->obj.logger;
@@ -78,19 +92,155 @@ bool    DOMParser::parse                    (bool b)
     return true;
 }
 
+bool DOMParser::parse(bool b_strict, const std::string &name)
+{
+    if(!vlc_reader && (!stream || !(vlc_reader = xml_ReaderCreate(stream, stream))))
+        return false;
+
+    streamedName = name;
+    b_streamedEnd = false;
+    /* reads up to the first streamed element */
+    processStreamedNode(true);
+    if(root == nullptr || (b_strict && streamedLifo.empty() &&
+                           !streamedNext && !b_streamedEnd))
+    {
+        delete root;
+        root = nullptr;
+        return false;
+    }
+    return true;
+}
+
+Node* DOMParser::getNextNode()
+{
+    if(streamedNext)
+    {
+        Node *node = streamedNext;
+        streamedNext = nullptr;
+        return node;
+    }
+    return processStreamedNode(false);
+}
+
+void DOMParser::releaseStreamed()
+{
+    /* streamed ones are not attached to root */
+    delete streamedNext;
+    streamedNext = nullptr;
+    if(streamedLifo.size() > 1 && streamedLifo[1]->getName() == streamedName)
+        delete streamedLifo[1];
+    streamedLifo.clear();
+    b_streamedEnd = false;
+}
+
 bool DOMParser::reset(stream_t *s)
 {
     stream = s;
     if(!vlc_reader)
         return true;
+    releaseStreamed();
     delete root;
     root = nullptr;
 
-    xml_ReaderDelete(vlc_reader);
+    if(b_own_reader)
+        xml_ReaderDelete(vlc_reader);
+    /* a borrowed reader is left to its owner, parse s with our own */
+    b_own_reader = true;
     vlc_reader = xml_ReaderCreate(s, s);
     return !!vlc_reader;
 }
 
+Node* DOMParser::createNode(const char *data, const char *ns)
+{
+    Namespaces::Ptr ptr = nss.registerNamespace(ns);
+    const char *unprefixed = std::strchr(data, ':');
+    data = unprefixed ? unprefixed + 1 : data;
+    auto name = std::make_unique<std::string>(data);
+    Node *node = new (std::nothrow) Node(std::move(name), ptr);
+    if(node)
+        addAttributesToNode(node);
+    return node;
+}
+
+Node* DOMParser::processStreamedNode(bool b_head)
+{
+    const char *data, *ns;
+    int type;
+
+    while( !b_streamedEnd && (type = xml_ReaderNextNodeNS(vlc_reader, &data, &ns)) > 0 )
+    {
+        switch(type)
+        {
+            case XML_READER_STARTELEM:
+            {
+                bool empty = xml_ReaderIsEmptyElement(vlc_reader);
+                Node *node = createNode(data, ns);
+                if(!node)
+                    break;
+
+                const bool b_streamed = (streamedLifo.size() == 1 &&
+                                         node->getName() == streamedName);
+                if(streamedLifo.empty())
+                    root = node;
+                else if(!b_streamed)
+                    streamedLifo.back()->addSubNode(node);
+
+                if(!empty)
+                {
+                    streamedLifo.push_back(node);
+                    if(b_streamed && b_head)
+                        return nullptr;
+                }
+                else if(b_streamed)
+                {
+                    if(!b_head)
+                        return node;
+                    streamedNext = node;
+                    return nullptr;
+                }
+                else if(streamedLifo.empty())
+                {
+                    b_streamedEnd = true;
+                }
+                break;
+            }
+
+            case XML_READER_TEXT:
+            {
+                if(!streamedLifo.empty())
+                    streamedLifo.back()->setText(std::string(data));
+                break;
+            }
+
+            case XML_READER_ENDELEM:
+            {
+                if(streamedLifo.empty())
+                {
+                    b_streamedEnd = true;
+                    break;
+                }
+
+                Node *node = streamedLifo.back();
+                streamedLifo.pop_back();
+                if(streamedLifo.empty())
+                    b_streamedEnd = true;
+                else if(streamedLifo.size() == 1 && node->getName() == streamedName)
+                    return node;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    /* truncated, drop the incomplete streamed element */
+    if(streamedLifo.size() > 1 && streamedLifo[1]->getName() == streamedName)
+        delete streamedLifo[1];
+    streamedLifo.clear();
+    return nullptr;
+}
+
 Node* DOMParser::processNode(bool b_strict)
 {
     const char *data, *ns;
@@ -103,19 +253,13 @@ Node* DOMParser::processNode(bool b_strict)
         {
             case XML_READER_STARTELEM:
             {
-                Namespaces::Ptr ptr = nss.registerNamespace(ns);
                 bool empty = xml_ReaderIsEmptyElement(vlc_reader);
-                const char *unprefixed = std::strchr(data, ':');
-                data = unprefixed ? unprefixed + 1 : data;
-                auto name = std::make_unique<std::string>(data);
-                Node *node = new (std::nothrow) Node(std::move(name), ptr);
+                Node *node = createNode(data, ns);
                 if(node)
                 {
                     if(!lifo.empty())
                         lifo.top()->addSubNode(node);
                     lifo.push(node);
-
-                    addAttributesToNode(node);
                 }
 
                 if(empty && lifo.size() > 1)
@@ -30,6 +30,9 @@
 
 #include "Node.h"
 
+#include <string>
+#include <vector>
+
 namespace adaptive
 {
     namespace xml
@@ -39,9 +42,15 @@ namespace adaptive
             public:
                 DOMParser           ();
                 DOMParser           (stream_t *stream);
+
+                DOMParser           (xml_reader_t *reader);
                 virtual ~DOMParser  ();
 
                 bool                parse       (bool);
+                /* Streaming: the named root children are not attached to
+                 * the root node, but handed one at a time by getNextNode() */
+                bool                parse       (bool, const std::string &);
+                Node*               getNextNode ();
                 bool                reset       (stream_t *);
                 Node*               getRootNode ();
                 void                print       ();
@@ -52,8 +61,17 @@ namespace adaptive
                 stream_t            *stream;
 
                 xml_reader_t        *vlc_reader;
+                bool                b_own_reader;
+
+                std::string         streamedName;
+                std::vector<Node *> streamedLifo;
+                Node                *streamedNext;
+                bool                b_streamedEnd;
 
                 Node*   processNode             (bool);
+                Node*   processStreamedNode     (bool);
+                Node*   createNode              (const char *, const char *);
+                void    releaseStreamed         ();
                 void    addAttributesToNode     (Node *node);
                 void    print                   (Node *node, int offset);
         };
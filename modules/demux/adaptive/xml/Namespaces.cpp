@@ -34,14 +34,17 @@ Namespaces::Ptr Namespaces::registerNamespace(const char *ns)
         ns = "";
     Ptr ptr = getNamespace(ns);
     if(ptr == nullptr)
+    {
         ptr = std::make_shared<Entry>(std::string(ns));
+        nss.push_back(ptr);
+    }
     return ptr;
 }
 
 Namespaces::Ptr Namespaces::getNamespace(const std::string &ns)
 {
     auto it = std::find_if(nss.begin(), nss.end(),
-                        [ns](Ptr &e){ return *e == ns; });
+                        [&ns](Ptr &e){ return *e == ns; });
     return it != nss.end() ? *it : nullptr;
 }
 
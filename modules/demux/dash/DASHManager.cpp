@@ -31,10 +31,12 @@
 #include "DASHManager.h"
 #include "mpd/ProgramInformation.h"
 #include "mpd/IsoffMainParser.h"
+#include "mpd/MPDPatch.h"
 #include "../adaptive/xml/DOMParser.h"
 #include "../adaptive/xml/Node.h"
 #include "../adaptive/SharedResources.hpp"
 #include "../adaptive/tools/Helper.h"
+#include "../adaptive/playlist/Url.hpp"
 #include "../adaptive/http/HTTPConnectionManager.h"
 #include <vlc_stream.h>
 #include <vlc_demux.h>
@@ -86,11 +88,48 @@ bool DASHManager::needsUpdate() const
     return PlaylistManager::needsUpdate();
 }
 
+bool DASHManager::updatePlaylistFromPatch()
+{
+    MPD *mpd = dynamic_cast<MPD *>(playlist);
+    if(!mpd)
+        return false;
+
+    const Url patchUrl = mpd->getPatchUrl();
+    if(patchUrl.empty())
+        return false;
+
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, patchUrl.toString());
+    if(!p_block)
+        return false;
+
+    bool b_ret = false;
+    stream_t *patchstream = vlc_stream_MemoryNew(p_demux, p_block->p_buffer, p_block->i_buffer, true);
+    if(patchstream)
+    {
+        xml::DOMParser parser(patchstream);
+        if(parser.parse(true))
+        {
+            MPDPatch patch(parser.getRootNode());
+            b_ret = patch.apply(mpd);
+        }
+        vlc_stream_Delete(patchstream);
+    }
+    block_Release(p_block);
+
+    if(!b_ret)
+        msg_Dbg(p_demux, "Can't apply MPD patch, reloading full MPD");
+    return b_ret;
+}
+
 bool DASHManager::updatePlaylist()
 {
     /* do update */
     if(nextPlaylistupdate)
     {
+        /* only the new timeline entries */
+        if(updatePlaylistFromPatch())
+            return true;
+
         std::string url(p_demux->psz_url);
 
         block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, url);
@@ -105,19 +144,20 @@ bool DASHManager::updatePlaylist()
         }
 
         xml::DOMParser parser(mpdstream);
-        if(!parser.parse(true))
+        if(!parser.parse(true, "Period"))
         {
             vlc_stream_Delete(mpdstream);
             block_Release(p_block);
             return false;
         }
 
-        IsoffMainParser mpdparser(parser.getRootNode(), VLC_OBJECT(p_demux),
+        IsoffMainParser mpdparser(&parser, VLC_OBJECT(p_demux),
                                   mpdstream, Helper::getDirectoryPath(url).append("/"));
         MPD *newmpd = mpdparser.parse();
         if(newmpd)
         {
             playlist->updateWith(newmpd);
+            static_cast<MPD *>(playlist)->updatePatchInfo(newmpd);
             delete newmpd;
         }
         vlc_stream_Delete(mpdstream);
@@ -59,6 +59,9 @@ namespace dash
 
         protected:
             int doControl(int, va_list) override;
+
+        private:
+            bool updatePlaylistFromPatch();
     };
 
 }
@@ -40,6 +40,7 @@
 #include "ProgramInformation.h"
 #include "DASHSegment.h"
 #include "../../adaptive/xml/DOMHelper.h"
+#include "../../adaptive/xml/DOMParser.h"
 #include "../../adaptive/tools/Helper.h"
 #include "../../adaptive/tools/Debug.hpp"
 #include "../../adaptive/tools/Conversions.hpp"
@@ -55,11 +56,19 @@ IsoffMainParser::IsoffMainParser    (Node *root_, vlc_object_t *p_object_,
                                      stream_t *stream, const std::string & streambaseurl_)
 {
     root = root_;
+    streamer = nullptr;
     p_stream = stream;
     p_object = p_object_;
     playlisturl = streambaseurl_;
 }
 
+IsoffMainParser::IsoffMainParser    (DOMParser *streamer_, vlc_object_t *p_object_,
+                                     stream_t *stream, const std::string & streambaseurl_)
+    : IsoffMainParser(streamer_->getRootNode(), p_object_, stream, streambaseurl_)
+{
+    streamer = streamer_;
+}
+
 IsoffMainParser::~IsoffMainParser   ()
 {
 }
@@ -88,9 +97,26 @@ void IsoffMainParser::parseMPDBaseUrl(MPD *mpd, Node *root)
     for(size_t i = 0; i < baseUrls.size(); i++)
         mpd->addBaseUrl(baseUrls.at(i)->getText());
 
+    Node *location = DOMHelper::getFirstChildElementByName(root, "Location", getDASHNamespace());
+    if(location)
+        mpd->location = location->getText();
+
     mpd->setPlaylistUrl( Helper::getDirectoryPath(playlisturl).append("/") );
 }
 
+void IsoffMainParser::parsePatchLocation(MPD *mpd, Node *root)
+{
+    Node *node = DOMHelper::getFirstChildElementByName(root, "PatchLocation", getDASHNamespace());
+    /* patches can only apply to an identified MPD */
+    if(!node || mpd->mpdId.empty() || mpd->publishTime.empty())
+        return;
+
+    vlc_tick_t ttl = 0;
+    if(node->hasAttribute("ttl"))
+        ttl = vlc_tick_from_sec(Integer<double>(node->getAttributeValue("ttl")));
+    mpd->setPatchLocation(node->getText(), ttl);
+}
+
 MPD * IsoffMainParser::parse()
 {
     MPD *mpd = new (std::nothrow) MPD(p_object, getProfile());
@@ -99,6 +125,7 @@ MPD * IsoffMainParser::parse()
         parseMPDAttributes(mpd, root);
         parseProgramInformation(DOMHelper::getFirstChildElementByName(root, "ProgramInformation", getDASHNamespace()), mpd);
         parseMPDBaseUrl(mpd, root);
+        parsePatchLocation(mpd, root);
         parsePeriods(mpd, root);
         mpd->addAttribute(new StartnumberAttr(1));
         mpd->debug();
@@ -114,7 +141,8 @@ void    IsoffMainParser::parseMPDAttributes   (MPD *mpd, xml::Node *node)
 
     for(auto attr: attributes)
     {
-        if(*attr.ns != NS_DASH)
+        /* unprefixed attributes have no namespace */
+        if(!attr.ns->empty() && *attr.ns != NS_DASH)
             continue;
 
         if(attr.name == "mediaPresentationDuration")
@@ -156,35 +184,59 @@ void    IsoffMainParser::parseMPDAttributes   (MPD *mpd, xml::Node *node)
         {
             mpd->suggestedPresentationDelay.Set(IsoTime(attr.value));
         }
+        else if(attr.name == "id")
+        {
+            mpd->mpdId = attr.value;
+        }
+        else if(attr.name == "publishTime")
+        {
+            mpd->publishTime = attr.value;
+        }
     }
 }
 
 void IsoffMainParser::parsePeriods(MPD *mpd, Node *root)
 {
-    std::vector<Node *> periods = DOMHelper::getElementByTagName(root, "Period", getDASHNamespace(), false);
-    std::vector<Node *>::const_iterator it;
     uint64_t nextid = 0;
 
-    for(it = periods.begin(); it != periods.end(); ++it)
+    if(streamer)
     {
-        BasePeriod *period = new (std::nothrow) BasePeriod(mpd);
-        if (!period)
-            continue;
-        parseSegmentInformation(mpd, *it, period, &nextid);
-        if((*it)->hasAttribute("start"))
-            period->startTime.Set(IsoTime((*it)->getAttributeValue("start")));
-        if((*it)->hasAttribute("duration"))
-            period->duration.Set(IsoTime((*it)->getAttributeValue("duration")));
-        std::vector<Node *> baseUrls = DOMHelper::getChildElementByTagName(*it, "BaseURL", getDASHNamespace());
-        if(!baseUrls.empty())
+        /* never holds more than a single Period tree */
+        Node *periodNode;
+        while((periodNode = streamer->getNextNode()))
         {
-            period->baseUrl.Set( new Url( baseUrls.front()->getText() ) );
-            parseAvailability<BasePeriod>(mpd, baseUrls.front(), period);
+            if(periodNode->matches("Period", getDASHNamespace()))
+                parsePeriod(mpd, periodNode, &nextid);
+            delete periodNode;
         }
+        return;
+    }
 
-        parseAdaptationSets(mpd, *it, period);
-        mpd->addPeriod(period);
+    std::vector<Node *> periods = DOMHelper::getElementByTagName(root, "Period", getDASHNamespace(), false);
+    std::vector<Node *>::const_iterator it;
+    for(it = periods.begin(); it != periods.end(); ++it)
+        parsePeriod(mpd, *it, &nextid);
+}
+
+void IsoffMainParser::parsePeriod(MPD *mpd, Node *periodNode, uint64_t *nextid)
+{
+    BasePeriod *period = new (std::nothrow) BasePeriod(mpd);
+    if (!period)
+        return;
+    parseSegmentInformation(mpd, periodNode, period, nextid);
+    if(periodNode->hasAttribute("start"))
+        period->startTime.Set(IsoTime(periodNode->getAttributeValue("start")));
+    if(periodNode->hasAttribute("duration"))
+        period->duration.Set(IsoTime(periodNode->getAttributeValue("duration")));
+    std::vector<Node *> baseUrls = DOMHelper::getChildElementByTagName(periodNode, "BaseURL", getDASHNamespace());
+    if(!baseUrls.empty())
+    {
+        period->baseUrl.Set( new Url( baseUrls.front()->getText() ) );
+        parseAvailability<BasePeriod>(mpd, baseUrls.front(), period);
     }
+
+    parseAdaptationSets(mpd, periodNode, period);
+    mpd->addPeriod(period);
 }
 
 void IsoffMainParser::parseSegmentBaseType(MPD *, Node *node,
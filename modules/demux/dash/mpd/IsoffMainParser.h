@@ -48,6 +48,7 @@ namespace adaptive
     namespace xml
     {
         class Node;
+        class DOMParser;
     }
 }
 
@@ -68,6 +69,9 @@ namespace dash
             public:
                 IsoffMainParser             (xml::Node *root, vlc_object_t *p_object,
                                              stream_t *p_stream, const std::string &);
+                /* Periods are pulled and released one at a time */
+                IsoffMainParser             (xml::DOMParser *streamer, vlc_object_t *p_object,
+                                             stream_t *p_stream, const std::string &);
                 virtual ~IsoffMainParser    ();
                 MPD *   parse();
 
@@ -75,12 +79,14 @@ namespace dash
                 mpd::Profile getProfile     () const;
                 const std::string & getDASHNamespace() const;
                 void    parseMPDBaseUrl     (MPD *, xml::Node *);
+                void    parsePatchLocation  (MPD *, xml::Node *);
                 void    parseMPDAttributes  (MPD *, xml::Node *);
                 void    parseAdaptationSets (MPD *, xml::Node *periodNode, BasePeriod *period);
                 void    parseRepresentations(MPD *, xml::Node *adaptationSetNode, AdaptationSet *adaptationSet);
                 void    parseInitSegment    (xml::Node *, Initializable<InitSegment> *, SegmentInformation *);
                 void    parseTimeline       (xml::Node *, AbstractMultipleSegmentBaseType *);
                 void    parsePeriods        (MPD *, xml::Node *);
+                void    parsePeriod         (MPD *, xml::Node *, uint64_t *);
                 size_t  parseSegmentInformation(MPD *, xml::Node *, SegmentInformation *, uint64_t *);
                 size_t  parseSegmentBase    (MPD *, xml::Node *, SegmentInformation *);
                 size_t  parseSegmentList    (MPD *, xml::Node *, SegmentInformation *);
@@ -95,6 +101,7 @@ namespace dash
                 void    parseCommonAttributesElements(xml::Node *, CommonAttributesElements *);
 
                 xml::Node       *root;
+                xml::DOMParser  *streamer;
                 vlc_object_t    *p_object;
                 stream_t        *p_stream;
                 std::string      playlisturl;
@@ -26,6 +26,7 @@
 #endif
 
 #include <cinttypes>
+#include <ctime>
 
 #include "MPD.h"
 #include "ProgramInformation.h"
@@ -41,6 +42,7 @@ MPD::MPD (vlc_object_t *p_object, Profile profile_) :
 {
     programInfo.Set( nullptr );
     lowLatency = false;
+    patchLocationExpiry = 0;
 }
 
 MPD::~MPD()
@@ -69,6 +71,46 @@ void MPD::setLowLatency(bool b)
     lowLatency = b;
 }
 
+void MPD::setPatchLocation(const std::string &location, vlc_tick_t ttl)
+{
+    patchLocation = location;
+    patchLocationExpiry = ttl > 0 ? time(nullptr) + SEC_FROM_VLC_TICK(ttl) : 0;
+}
+
+std::string MPD::getPatchLocation() const
+{
+    if(patchLocationExpiry && time(nullptr) > patchLocationExpiry)
+        return std::string();
+    return patchLocation;
+}
+
+Url MPD::getPatchUrl() const
+{
+    const std::string patch = getPatchLocation();
+    if(patch.empty())
+        return Url();
+
+    Url url(patch);
+    if(!url.hasScheme())
+    {
+        /* relative to where the MPD moved, or to its BaseURL */
+        Url base = location.empty() ? getUrlSegment() : Url(location);
+        if(!base.hasScheme() && !playlistUrl.empty())
+            base.prepend(Url(playlistUrl));
+        url.prepend(base);
+    }
+    return url;
+}
+
+void MPD::updatePatchInfo(const MPD *updated)
+{
+    mpdId = updated->mpdId;
+    publishTime = updated->publishTime;
+    location = updated->location;
+    patchLocation = updated->patchLocation;
+    patchLocationExpiry = updated->patchLocationExpiry;
+}
+
 Profile MPD::getProfile() const
 {
     return profile;
@@ -41,6 +41,7 @@ namespace dash
         class MPD : public BasePlaylist
         {
             friend class IsoffMainParser;
+            friend class MPDPatch;
 
             public:
                 MPD(vlc_object_t *, Profile);
@@ -50,6 +51,10 @@ namespace dash
                 bool                            isLive() const override;
                 bool                            isLowLatency() const override;
                 void                            setLowLatency(bool);
+                void                            setPatchLocation(const std::string &, vlc_tick_t);
+                std::string                     getPatchLocation() const;
+                Url                             getPatchUrl() const;
+                void                            updatePatchInfo(const MPD *);
                 void                            debug() const override;
 
                 Property<ProgramInformation *>      programInfo;
@@ -57,6 +62,11 @@ namespace dash
             private:
                 Profile                             profile;
                 bool                                lowLatency;
+                std::string                         mpdId;
+                std::string                         publishTime;
+                std::string                         location;
+                std::string                         patchLocation;
+                time_t                              patchLocationExpiry;
         };
     }
 }
@@ -0,0 +1,253 @@
+/*
+ * MPDPatch.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "MPDPatch.h"
+#include "MPD.h"
+#include "../../adaptive/playlist/BasePeriod.h"
+#include "../../adaptive/playlist/BaseAdaptationSet.h"
+#include "../../adaptive/playlist/BaseRepresentation.h"
+#include "../../adaptive/playlist/SegmentTemplate.h"
+#include "../../adaptive/playlist/SegmentList.h"
+#include "../../adaptive/playlist/SegmentTimeline.h"
+#include "../../adaptive/xml/Node.h"
+#include "../../adaptive/tools/Conversions.hpp"
+
+using namespace dash::mpd;
+using namespace adaptive::xml;
+using namespace adaptive::playlist;
+
+MPDPatch::MPDPatch(Node *root_)
+{
+    root = root_;
+}
+
+bool MPDPatch::isPatch(Node *root)
+{
+    return root && root->getName() == "Patch";
+}
+
+bool MPDPatch::parseSelector(const std::string &sel, std::vector<Step> &steps)
+{
+    /* Only simple absolute paths, with optional id predicates */
+    if(sel.empty() || sel[0] != '/')
+        return false;
+
+    std::string::size_type pos = 1;
+    for(;;)
+    {
+        Step step;
+        std::string::size_type end = sel.find_first_of("/[", pos);
+        if(end == std::string::npos)
+            end = sel.size();
+        step.name = sel.substr(pos, end - pos);
+        if(step.name.empty())
+            return false;
+
+        if(end < sel.size() && sel[end] == '[')
+        {
+            std::string::size_type close = sel.find(']', end);
+            if(close == std::string::npos)
+                return false;
+            const std::string predicate = sel.substr(end + 1, close - end - 1);
+            step.b_predicate = true;
+            if(predicate.size() > 6 && !predicate.compare(0, 4, "@id=") &&
+               (predicate[4] == '\'' || predicate[4] == '"') &&
+               predicate.back() == predicate[4])
+                step.id = predicate.substr(5, predicate.size() - 6);
+            end = close + 1;
+        }
+
+        steps.push_back(step);
+
+        if(end >= sel.size())
+            break;
+        if(sel[end] != '/')
+            return false;
+        pos = end + 1;
+    }
+
+    return steps.front().name == "MPD" && !steps.front().b_predicate;
+}
+
+SegmentTimeline * MPDPatch::getTimeline(MPD *mpd, const std::vector<Step> &steps)
+{
+    BasePeriod *period = nullptr;
+    BaseAdaptationSet *adaptSet = nullptr;
+    SegmentInformation *info = nullptr;
+    AbstractMultipleSegmentBaseType *base = nullptr;
+
+    for(std::size_t i = 1; i < steps.size(); i++)
+    {
+        const Step &step = steps[i];
+        if(step.name == "Period" && !period && !step.id.empty())
+        {
+            for(BasePeriod *p : mpd->getPeriods())
+                if(p->getID() == ID(step.id))
+                    period = p;
+            info = period;
+        }
+        else if(step.name == "AdaptationSet" && period && !adaptSet && !step.id.empty())
+        {
+            info = adaptSet = period->getAdaptationSetByID(ID(step.id));
+        }
+        else if(step.name == "Representation" && adaptSet && info == adaptSet && !step.id.empty())
+        {
+            info = adaptSet->getRepresentationByID(ID(step.id));
+        }
+        else if(step.name == "SegmentTemplate" && info && !base && !step.b_predicate)
+        {
+            base = info->inheritSegmentTemplate();
+        }
+        else if(step.name == "SegmentList" && info && !base && !step.b_predicate)
+        {
+            base = info->inheritSegmentList();
+        }
+        else if(step.name == "SegmentTimeline" && base &&
+                i + 1 == steps.size() && !step.b_predicate)
+        {
+            return base->inheritSegmentTimeline();
+        }
+        else return nullptr;
+
+        if(!info || (step.name.compare(0, 7, "Segment") == 0 && !base))
+            return nullptr;
+    }
+    return nullptr;
+}
+
+bool MPDPatch::checkTimelineElements(const Node *node)
+{
+    const std::vector<Node *> &elements = node->getSubNodes();
+    for(const Node *s : elements)
+    {
+        if(s->getName() != "S" || !s->hasAttribute("d") ||
+           (s->hasAttribute("r") && Integer<int64_t>(s->getAttributeValue("r")) < 0))
+            return false;
+    }
+    /* first one needs to be placed on our timeline */
+    return !elements.empty() && elements.front()->hasAttribute("t");
+}
+
+void MPDPatch::addToTimeline(SegmentTimeline *timeline, const Node *node)
+{
+    /* new elements get renumbered from the existing ones */
+    SegmentTimeline update(nullptr);
+    for(const Node *s : node->getSubNodes())
+    {
+        stime_t d = Integer<stime_t>(s->getAttributeValue("d"));
+        uint64_t r = 0;
+        if(s->hasAttribute("r"))
+            r = Integer<uint64_t>(s->getAttributeValue("r"));
+        if(s->hasAttribute("t"))
+            update.addElement(0, d, r, Integer<stime_t>(s->getAttributeValue("t")));
+        else
+            update.addElement(0, d, r);
+    }
+    timeline->updateWith(update);
+}
+
+bool MPDPatch::prepare(MPD *mpd, Node *op, std::vector<Operation> &ops) const
+{
+    std::vector<Step> steps;
+    if(!parseSelector(op->getAttributeValue("sel"), steps))
+        return false;
+
+    Operation operation;
+    operation.node = op;
+    operation.timeline = nullptr;
+
+    if(op->getName() == "add")
+    {
+        /* only appending as last child */
+        if(op->hasAttribute("pos") || op->hasAttribute("type"))
+            return false;
+        operation.type = Operation::Type::AddTimeline;
+        operation.timeline = getTimeline(mpd, steps);
+        if(!operation.timeline || operation.timeline->getTotalLength() == 0 ||
+           !checkTimelineElements(op))
+            return false;
+    }
+    else if(op->getName() == "replace" && steps.size() == 2)
+    {
+        if(steps[1].name == "@publishTime")
+            operation.type = Operation::Type::ReplacePublishTime;
+        else if(steps[1].name == "PatchLocation")
+            operation.type = Operation::Type::ReplacePatchLocation;
+        else
+            return false;
+    }
+    else if(op->getName() == "remove" && steps.back().name == "S")
+    {
+        /* expired elements, our timeline gets pruned on playback */
+        steps.pop_back();
+        return getTimeline(mpd, steps) != nullptr;
+    }
+    else return false;
+
+    ops.push_back(operation);
+    return true;
+}
+
+bool MPDPatch::apply(MPD *mpd) const
+{
+    if(!isPatch(root) ||
+       root->getAttributeValue("mpdId") != mpd->mpdId ||
+       root->getAttributeValue("originalPublishTime") != mpd->publishTime ||
+       !root->hasAttribute("publishTime"))
+        return false;
+
+    /* don't leave a partially patched MPD */
+    std::vector<Operation> ops;
+    for(Node *op : root->getSubNodes())
+        if(!prepare(mpd, op, ops))
+            return false;
+
+    for(const Operation &op : ops)
+    {
+        switch(op.type)
+        {
+            case Operation::Type::AddTimeline:
+                addToTimeline(op.timeline, op.node);
+                break;
+            case Operation::Type::ReplacePublishTime:
+                /* same as the Patch one, set below */
+                break;
+            case Operation::Type::ReplacePatchLocation:
+            {
+                const Node *location = op.node->getSubNodes().empty()
+                                     ? nullptr : op.node->getSubNodes().front();
+                if(location && location->getName() == "PatchLocation")
+                {
+                    vlc_tick_t ttl = 0;
+                    if(location->hasAttribute("ttl"))
+                        ttl = vlc_tick_from_sec(Integer<double>(location->getAttributeValue("ttl")));
+                    mpd->setPatchLocation(location->getText(), ttl);
+                }
+            }
+            break;
+        }
+    }
+
+    mpd->publishTime = root->getAttributeValue("publishTime");
+    return true;
+}
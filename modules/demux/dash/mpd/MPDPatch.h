@@ -0,0 +1,90 @@
+/*
+ * MPDPatch.h
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef MPDPATCH_H_
+#define MPDPATCH_H_
+
+#include <string>
+#include <vector>
+
+namespace adaptive
+{
+    namespace playlist
+    {
+        class SegmentTimeline;
+    }
+    namespace xml
+    {
+        class Node;
+    }
+}
+
+namespace dash
+{
+    namespace mpd
+    {
+        class MPD;
+
+        using namespace adaptive;
+
+        /* Applies an MPD Patch document operations to the loaded MPD,
+         * so live updates only carry the timeline additions.
+         * Only the usual timeline tail additions are supported,
+         * anything else requires reloading the full MPD. */
+        class MPDPatch
+        {
+            public:
+                MPDPatch(xml::Node *);
+                bool apply(MPD *) const;
+                static bool isPatch(xml::Node *);
+
+            private:
+                class Step
+                {
+                    public:
+                        std::string name;
+                        std::string id;
+                        bool b_predicate = false;
+                };
+
+                class Operation
+                {
+                    public:
+                        enum class Type
+                        {
+                            AddTimeline,
+                            ReplacePublishTime,
+                            ReplacePatchLocation,
+                        };
+                        Type type;
+                        xml::Node *node;
+                        playlist::SegmentTimeline *timeline;
+                };
+
+                static bool parseSelector(const std::string &, std::vector<Step> &);
+                static playlist::SegmentTimeline * getTimeline(MPD *, const std::vector<Step> &);
+                bool prepare(MPD *, xml::Node *, std::vector<Operation> &) const;
+                static bool checkTimelineElements(const xml::Node *);
+                static void addToTimeline(playlist::SegmentTimeline *, const xml::Node *);
+                xml::Node *root;
+        };
+    }
+}
+
+#endif /* MPDPATCH_H_ */
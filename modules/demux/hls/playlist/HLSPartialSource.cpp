@@ -0,0 +1,256 @@
+/*
+ * HLSPartialSource.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HLSPartialSource.hpp"
+#include "HLSRepresentation.hpp"
+#include "Parser.hpp"
+#include "../../adaptive/SharedResources.hpp"
+#include "../../adaptive/http/HTTPConnectionManager.h"
+#include "../../adaptive/playlist/BaseAdaptationSet.h"
+#include "../../adaptive/playlist/BasePlaylist.hpp"
+#include "../../adaptive/playlist/Url.hpp"
+
+#include <vlc_block.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+using namespace hls::playlist;
+using namespace adaptive::http;
+
+HLSPartialSource::HLSPartialSource(SharedResources *res, HLSRepresentation *rep,
+                                   const std::string &base, uint64_t seq,
+                                   const std::vector<HLSPart> &parts_,
+                                   const HLSPart &hint) :
+    AbstractChunkSource(ChunkType::Segment),
+    resources(res),
+    sourceid(rep->getAdaptationSet()->getID()),
+    baseUrl(base),
+    sequence(seq),
+    parts(parts_),
+    preloadHint(hint)
+{
+    p_obj = rep->getPlaylist()->getVLCObject();
+    playlistUrl = rep->getPlaylistUrl().toString();
+    current = nullptr;
+    hintSource = nullptr;
+    next = 0;
+    consumed = 0;
+    complete = false;
+    eof = false;
+}
+
+HLSPartialSource::~HLSPartialSource()
+{
+    if(current)
+        dropPart(current);
+    if(hintSource)
+        dropPart(hintSource);
+}
+
+void HLSPartialSource::dropPart(AbstractChunkSource *source)
+{
+    resources->getConnManager()->recycleSource(source);
+}
+
+AbstractChunkSource * HLSPartialSource::makePart(const HLSPart &part)
+{
+    Url url(baseUrl);
+    url.append(Url(part.uri));
+    AbstractConnectionManager *connManager = resources->getConnManager();
+    AbstractChunkSource *source = connManager->makeSource(url.toString(), sourceid,
+                                                          ChunkType::Segment, part.range);
+    if(source)
+    {
+        source->setPriority(getPriority());
+        /* a part is not a whole segment */
+        source->setStorable(false);
+        connManager->start(source);
+    }
+    return source;
+}
+
+bool HLSPartialSource::reload()
+{
+    std::vector<HLSPart> updated;
+    HLSPart hint;
+    bool b_complete;
+
+    const std::string url = HLSRepresentation::getBlockingReloadUrl(playlistUrl, sequence,
+                                                                    parts.size());
+    M3U8Parser parser(resources);
+    if(!parser.getPartsFromPlaylistURI(p_obj, url, sequence, updated, hint, &b_complete))
+        return false;
+
+    /* published parts can't go away */
+    if(updated.size() < parts.size())
+        return false;
+
+    const bool b_progress = (updated.size() > parts.size() || b_complete);
+    parts = updated;
+    preloadHint = hint;
+    complete = b_complete;
+    return b_progress;
+}
+
+AbstractChunkSource * HLSPartialSource::nextPart()
+{
+    /* blocks until the server publishes our next part */
+    for(unsigned i=0; next >= parts.size() && !complete; i++)
+    {
+        if(i == MAX_RELOADS || !reload())
+        {
+            msg_Warn(p_obj, "No more parts for segment %" PRIu64, sequence);
+            complete = true;
+        }
+    }
+
+    if(next >= parts.size())
+        return nullptr;
+
+    const HLSPart &part = parts[next++];
+    AbstractChunkSource *source = nullptr;
+    if(hintSource)
+    {
+        if(part == hintPart)
+        {
+            source = hintSource;
+            hintSource = nullptr;
+        }
+        else if(!(hintPart == preloadHint) &&
+                std::find(parts.begin() + next, parts.end(), hintPart) == parts.end())
+        {
+            /* hinted resource was not published as expected */
+            dropPart(hintSource);
+            hintSource = nullptr;
+        }
+    }
+    if(!source)
+        source = makePart(part);
+
+    /* request the announced part ahead, the server holds it until ready */
+    if(!hintSource && next == parts.size() && !complete && !preloadHint.uri.empty())
+    {
+        hintPart = preloadHint;
+        hintSource = makePart(hintPart);
+    }
+
+    return source;
+}
+
+block_t * HLSPartialSource::readBlock()
+{
+    while(!eof)
+    {
+        if(!current && !(current = nextPart()))
+            break;
+
+        block_t *p_block = current->readBlock();
+        if(p_block && p_block->i_buffer)
+        {
+            if(contentType.empty())
+                contentType = current->getContentType();
+            consumed += p_block->i_buffer;
+            return p_block;
+        }
+        if(p_block)
+            block_Release(p_block);
+        if(!p_block || !current->hasMoreData())
+        {
+            dropPart(current);
+            current = nullptr;
+        }
+    }
+
+    if(eof)
+        return nullptr;
+    eof = true;
+    return block_Alloc(0);
+}
+
+block_t * HLSPartialSource::read(size_t readsize)
+{
+    block_t *p_chain = nullptr;
+    block_t **pp_last = &p_chain;
+    size_t copied = 0;
+
+    while(copied < readsize && !eof)
+    {
+        if(!current && !(current = nextPart()))
+        {
+            eof = true;
+            break;
+        }
+
+        block_t *p_block = current->read(readsize - copied);
+        const size_t got = p_block ? p_block->i_buffer : 0;
+        if(got)
+        {
+            if(contentType.empty())
+                contentType = current->getContentType();
+            copied += got;
+            block_ChainLastAppend(&pp_last, p_block);
+        }
+        else if(p_block)
+        {
+            block_Release(p_block);
+        }
+        if(!got || !current->hasMoreData())
+        {
+            dropPart(current);
+            current = nullptr;
+        }
+    }
+
+    consumed += copied;
+    return p_chain ? block_ChainGather(p_chain) : nullptr;
+}
+
+bool HLSPartialSource::hasMoreData() const
+{
+    return !eof;
+}
+
+size_t HLSPartialSource::getBytesRead() const
+{
+    return consumed;
+}
+
+std::string HLSPartialSource::getContentType() const
+{
+    if(contentType.empty() && current)
+        return current->getContentType();
+    return contentType;
+}
+
+RequestStatus HLSPartialSource::getRequestStatus() const
+{
+    if(current)
+        return current->getRequestStatus();
+    return AbstractChunkSource::getRequestStatus();
+}
+
+void HLSPartialSource::recycle()
+{
+    delete this;
+}
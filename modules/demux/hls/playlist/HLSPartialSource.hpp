@@ -0,0 +1,82 @@
+/*
+ * HLSPartialSource.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef HLSPARTIALSOURCE_HPP
+#define HLSPARTIALSOURCE_HPP
+
+#include "HLSSegment.hpp"
+#include "../../adaptive/http/Chunk.h"
+
+#include <vector>
+
+namespace hls
+{
+    namespace playlist
+    {
+        class HLSRepresentation;
+
+        using namespace adaptive::http;
+
+        /* Reads a segment still being produced as its parts get
+         * published, using blocking playlist reloads to learn
+         * about the next ones */
+        class HLSPartialSource : public AbstractChunkSource
+        {
+            public:
+                HLSPartialSource(SharedResources *, HLSRepresentation *,
+                                 const std::string &, uint64_t,
+                                 const std::vector<HLSPart> &, const HLSPart &);
+                virtual ~HLSPartialSource();
+
+                block_t *   readBlock       ()  override;
+                block_t *   read            (size_t)  override;
+                bool        hasMoreData     () const  override;
+                size_t      getBytesRead    () const  override;
+                std::string getContentType  () const  override;
+                RequestStatus getRequestStatus() const override;
+                void        recycle() override;
+
+                static const unsigned MAX_RELOADS = 3;
+
+            private:
+                AbstractChunkSource * makePart(const HLSPart &);
+                AbstractChunkSource * nextPart();
+                void                  dropPart(AbstractChunkSource *);
+                bool                  reload();
+                SharedResources    *resources;
+                vlc_object_t       *p_obj;
+                ID                  sourceid;
+                std::string         baseUrl;
+                std::string         playlistUrl;
+                uint64_t            sequence;
+                std::vector<HLSPart> parts;
+                HLSPart             preloadHint;
+                AbstractChunkSource *current;
+                AbstractChunkSource *hintSource; /* prefetched preload hint */
+                HLSPart             hintPart;
+                size_t              next; /* part index to read next */
+                size_t              consumed;
+                bool                complete;
+                bool                eof;
+                std::string         contentType;
+        };
+    }
+}
+
+#endif // HLSPARTIALSOURCE_HPP
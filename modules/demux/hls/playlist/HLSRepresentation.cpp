@@ -44,6 +44,9 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     updateFailureCount = 0;
     lastUpdateTime = 0;
     targetDuration = 0;
+    partTargetDuration = 0;
+    canBlockReload = false;
+    canSkipUntil = 0;
     streamFormat = StreamFormat::Type::Unknown;
     channels = 0;
 }
@@ -62,6 +65,19 @@ bool HLSRepresentation::isLive() const
     return b_live;
 }
 
+bool HLSRepresentation::isLowLatency() const
+{
+    return b_live && canBlockReload && partTargetDuration;
+}
+
+bool HLSRepresentation::canSkipSegments() const
+{
+    /* delta updates are only allowed while our copy
+     * is less than half the skip boundary old */
+    return b_live && b_loaded && canSkipUntil && lastUpdateTime &&
+           vlc_tick_now() - lastUpdateTime < canSkipUntil / 2;
+}
+
 bool HLSRepresentation::initialized() const
 {
     return b_loaded;
@@ -87,6 +103,23 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+std::string HLSRepresentation::getBlockingReloadUrl(const std::string &url,
+                                                    uint64_t msn, unsigned part)
+{
+    std::string ret = url;
+    ret += (url.find('?') == std::string::npos) ? '?' : '&';
+    ret += "_HLS_msn=" + std::to_string(msn) + "&_HLS_part=" + std::to_string(part);
+    return ret;
+}
+
+std::string HLSRepresentation::getDeltaUpdateUrl(const std::string &url)
+{
+    std::string ret = url;
+    ret += (url.find('?') == std::string::npos) ? '?' : '&';
+    ret += "_HLS_skip=YES";
+    return ret;
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -129,7 +162,16 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
         return false;
     if(!b_loaded)
         return true;
-    if(isLive())
+    if(isLowLatency())
+    {
+        /* Blocking reload only returns once the next segment has started,
+         * so there's no need to poll while we still have segments */
+        if(vlc_tick_now() - lastUpdateTime < partTargetDuration)
+            return false;
+        return number == std::numeric_limits<uint64_t>::max() ||
+               getMediaSegment(number) == nullptr;
+    }
+    else if(isLive())
     {
         const vlc_tick_t now = vlc_tick_now();
         const vlc_tick_t elapsed = now - lastUpdateTime;
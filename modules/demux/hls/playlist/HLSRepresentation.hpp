@@ -46,6 +46,8 @@ namespace hls
                 void setPlaylistUrl(const std::string &);
                 Url getPlaylistUrl() const;
                 bool isLive() const;
+                bool isLowLatency() const;
+                bool canSkipSegments() const;
                 bool initialized() const;
                 void scheduleNextUpdate(uint64_t, bool) override;
                 bool needsUpdate(uint64_t) const override;
@@ -58,8 +60,14 @@ namespace hls
 
                 void setChannelsCount(unsigned);
 
+                static std::string getBlockingReloadUrl(const std::string &, uint64_t, unsigned);
+                static std::string getDeltaUpdateUrl(const std::string &);
+
             protected:
                 time_t targetDuration;
+                vlc_tick_t partTargetDuration;
+                bool canBlockReload;
+                vlc_tick_t canSkipUntil;
                 Url playlistUrl;
 
             private:
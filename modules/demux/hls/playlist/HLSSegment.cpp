@@ -22,21 +22,53 @@
 #endif
 
 #include "HLSSegment.hpp"
+#include "HLSRepresentation.hpp"
+#include "HLSPartialSource.hpp"
 #include "../../adaptive/playlist/BaseRepresentation.h"
 
 
 using namespace hls::playlist;
 
+HLSPart::HLSPart()
+{
+    duration = 0;
+}
+
+bool HLSPart::operator==(const HLSPart &other) const
+{
+    return uri == other.uri &&
+           range.getStartByte() == other.range.getStartByte() &&
+           range.getEndByte() == other.range.getEndByte();
+}
+
 HLSSegment::HLSSegment( ICanonicalUrl *parent, uint64_t seq ) :
     Segment( parent )
 {
     setSequenceNumber(seq);
+    complete = true;
 }
 
 HLSSegment::~HLSSegment()
 {
 }
 
+bool HLSSegment::isComplete() const
+{
+    return complete;
+}
+
+AbstractChunkSource * HLSSegment::createSource(SharedResources *res, const std::string &url,
+                                               BaseRepresentation *rep, ChunkType type,
+                                               const BytesRange &range)
+{
+    if(complete || type != ChunkType::Segment)
+        return Segment::createSource(res, url, rep, type, range);
+
+    /* url is our parent one as there's no segment uri yet */
+    return new (std::nothrow) HLSPartialSource(res, static_cast<HLSRepresentation *>(rep), url,
+                                               getSequenceNumber(), parts, preloadHint);
+}
+
 bool HLSSegment::prepareChunk(SharedResources *res, SegmentChunk *chunk, BaseRepresentation *rep)
 {
     if(encryption.method == CommonEncryption::Method::AES_128)
@@ -23,6 +23,8 @@
 #include "../../adaptive/playlist/Segment.h"
 #include "../../adaptive/encryption/CommonEncryption.hpp"
 
+#include <vector>
+
 namespace hls
 {
     namespace playlist
@@ -31,6 +33,17 @@ namespace hls
         using namespace adaptive::playlist;
         using namespace adaptive::encryption;
 
+        /* EXT-X-PART or EXT-X-PRELOAD-HINT of a low latency playlist */
+        class HLSPart
+        {
+            public:
+                HLSPart();
+                bool operator==(const HLSPart &) const;
+                std::string uri;
+                BytesRange range;
+                vlc_tick_t duration;
+        };
+
         class HLSSegment : public Segment
         {
             friend class M3U8Parser;
@@ -38,10 +51,20 @@ namespace hls
             public:
                 HLSSegment( ICanonicalUrl *parent, uint64_t sequence );
                 virtual ~HLSSegment();
+                bool isComplete() const override;
 
             protected:
+                AbstractChunkSource * createSource(SharedResources *, const std::string &,
+                                                   BaseRepresentation *, ChunkType,
+                                                   const BytesRange &) override;
                 bool prepareChunk(SharedResources *, SegmentChunk *,
                                   BaseRepresentation *) override;
+
+            private:
+                /* live edge segment only available as parts */
+                bool complete;
+                std::vector<HLSPart> parts;
+                HLSPart preloadHint;
         };
     }
 }
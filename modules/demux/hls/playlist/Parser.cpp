@@ -225,7 +225,22 @@ void M3U8Parser::fillAdaptsetFromMediainfo(const AttributesTag *mediatag,
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    std::string url = rep->getPlaylistUrl().toString();
+    const SegmentList *segmentList = rep->inheritSegmentList();
+    if(segmentList && !segmentList->getSegments().empty())
+    {
+        if(rep->isLowLatency())
+        {
+            /* Blocking reload, returns once the next segment has started */
+            const uint64_t next = segmentList->getSegments().back()->getSequenceNumber() + 1;
+            url = HLSRepresentation::getBlockingReloadUrl(url, next, 0);
+        }
+        /* Only ask for the segments we don't have */
+        if(rep->canSkipSegments())
+            url = HLSRepresentation::getDeltaUpdateUrl(url);
+    }
+
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, url);
     if(p_block)
     {
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
@@ -244,6 +259,110 @@ bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresent
     return false;
 }
 
+static void parsePart(const AttributesTag *tag, std::size_t &prevoffset, HLSPart &part)
+{
+    const Attribute *attr = tag->getAttributeByName("URI");
+    if(attr)
+        part.uri = attr->quotedString();
+    attr = tag->getAttributeByName("DURATION");
+    if(attr)
+        part.duration = vlc_tick_from_sec(attr->floatingPoint());
+    attr = tag->getAttributeByName("BYTERANGE");
+    if(attr)
+    {
+        std::pair<std::size_t,std::size_t> range = attr->unescapeQuotes().getByteRange();
+        if(range.first == 0)
+            range.first = prevoffset;
+        prevoffset = range.first + range.second;
+        part.range = BytesRange(range.first, prevoffset - 1);
+    }
+    else prevoffset = 0;
+}
+
+static bool parsePreloadHint(const AttributesTag *tag, HLSPart &part)
+{
+    const Attribute *attr = tag->getAttributeByName("TYPE");
+    if(!attr || attr->value != "PART" || !(attr = tag->getAttributeByName("URI")))
+        return false;
+    part.uri = attr->quotedString();
+    attr = tag->getAttributeByName("BYTERANGE-START");
+    if(attr)
+    {
+        const std::size_t start = attr->decimal();
+        attr = tag->getAttributeByName("BYTERANGE-LENGTH");
+        /* open ended until the part is complete */
+        part.range = BytesRange(start, attr ? start + attr->decimal() - 1 : 0);
+    }
+    return true;
+}
+
+bool M3U8Parser::getPartsFromPlaylistURI(vlc_object_t *p_obj, const std::string &url,
+                                         uint64_t sequence, std::vector<HLSPart> &parts,
+                                         HLSPart &hint, bool *pb_complete)
+{
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, url);
+    if(!p_block)
+        return false;
+
+    stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
+    if(!substream)
+    {
+        block_Release(p_block);
+        return false;
+    }
+
+    std::list<Tag *> tagslist = parseEntries(substream);
+    vlc_stream_Delete(substream);
+    block_Release(p_block);
+
+    uint64_t current = 0;
+    std::size_t prevoffset = 0;
+    bool b_endlist = false;
+    parts.clear();
+    hint = HLSPart();
+
+    for(const Tag *tag : tagslist)
+    {
+        switch(tag->getType())
+        {
+            case SingleValueTag::EXTXMEDIASEQUENCE:
+                current = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
+                break;
+
+            case SingleValueTag::URI:
+                if(!static_cast<const SingleValueTag *>(tag)->getValue().value.empty())
+                    current++;
+                prevoffset = 0;
+                break;
+
+            case AttributesTag::EXTXPART:
+                if(current == sequence)
+                {
+                    HLSPart part;
+                    parsePart(static_cast<const AttributesTag *>(tag), prevoffset, part);
+                    if(!part.uri.empty())
+                        parts.push_back(part);
+                }
+                break;
+
+            case AttributesTag::EXTXPRELOADHINT:
+                if(current == sequence)
+                    parsePreloadHint(static_cast<const AttributesTag *>(tag), hint);
+                break;
+
+            case Tag::EXTXENDLIST:
+                b_endlist = true;
+                break;
+        }
+    }
+
+    releaseTagsList(tagslist);
+
+    /* segment uri has been published or is gone */
+    *pb_complete = (current > sequence || b_endlist);
+    return true;
+}
+
 static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
                             CommonEncryption &encryption)
 {
@@ -301,6 +420,16 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     const SingleValueTag *ctx_byterange = nullptr;
     CommonEncryption encryption;
     const ValuesListTag *ctx_extinf = nullptr;
+    std::vector<HLSPart> parts; /* of the segment being produced */
+    std::size_t prevpartoffset = 0;
+    HLSPart preloadHint;
+    vlc_tick_t partHoldBack = 0;
+
+    /* segments we already have are not created again */
+    const SegmentList *knownList = rep->inheritSegmentList();
+    std::size_t knownIndex = 0;
+    bool b_knownTimings = false;
+    uint64_t windowStart = std::numeric_limits<uint64_t>::max();
 
     std::list<HLSSegment *> segmentstoappend;
 
@@ -333,11 +462,13 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                     break;
                 }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
+                /* parts were those of this now complete segment */
+                parts.clear();
+                prevpartoffset = 0;
+                preloadHint = HLSPart();
 
-                segment->setSourceUrl(uritag->getValue().value);
+                if(windowStart == std::numeric_limits<uint64_t>::max())
+                    windowStart = sequenceNumber;
 
                 /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
                 vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
@@ -348,6 +479,50 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                         nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
                     ctx_extinf = nullptr;
                 }
+
+                const Segment *known = nullptr;
+                if(knownList)
+                {
+                    const std::vector<Segment *> &knownSegments = knownList->getSegments();
+                    while(knownIndex < knownSegments.size() &&
+                          knownSegments[knownIndex]->getSequenceNumber() < sequenceNumber)
+                        knownIndex++;
+                    if(knownIndex < knownSegments.size() &&
+                       knownSegments[knownIndex]->getSequenceNumber() == sequenceNumber &&
+                       knownSegments[knownIndex]->isComplete())
+                        known = knownSegments[knownIndex];
+                }
+
+                if(known)
+                {
+                    /* continue on the timeline we already have */
+                    if(!b_knownTimings)
+                    {
+                        nzStartTime = timescale.ToTime(known->startTime.Get());
+                        b_knownTimings = true;
+                    }
+                    sequenceNumber++;
+                    nzStartTime += nzDuration;
+                    totalduration += nzDuration;
+                    if(absReferenceTime != VLC_TICK_INVALID)
+                        absReferenceTime += nzDuration;
+                    if(ctx_byterange)
+                    {
+                        std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
+                        if(range.first == 0)
+                            range.first = prevbyterangeoffset;
+                        prevbyterangeoffset = range.first + range.second;
+                        ctx_byterange = nullptr;
+                    }
+                    discontinuity = false;
+                    break;
+                }
+
+                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+                if(!segment)
+                    break;
+
+                segment->setSourceUrl(uritag->getValue().value);
                 segment->duration.Set(timescale.ToScaled(nzDuration));
                 segment->startTime.Set(timescale.ToScaled(nzStartTime));
                 nzStartTime += nzDuration;
@@ -437,6 +612,53 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             }
             break;
 
+            case AttributesTag::EXTXPART:
+            {
+                HLSPart part;
+                parsePart(static_cast<const AttributesTag *>(tag), prevpartoffset, part);
+                if(!part.uri.empty())
+                    parts.push_back(part);
+            }
+            break;
+
+            case AttributesTag::EXTXPRELOADHINT:
+                parsePreloadHint(static_cast<const AttributesTag *>(tag), preloadHint);
+                break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->getAttributeByName("PART-TARGET");
+                if(attr)
+                    rep->partTargetDuration = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const AttributesTag *controltag = static_cast<const AttributesTag *>(tag);
+                const Attribute *attr = controltag->getAttributeByName("CAN-BLOCK-RELOAD");
+                rep->canBlockReload = (attr && attr->value == "YES");
+                attr = controltag->getAttributeByName("PART-HOLD-BACK");
+                if(attr)
+                    partHoldBack = vlc_tick_from_sec(attr->floatingPoint());
+                attr = controltag->getAttributeByName("CAN-SKIP-UNTIL");
+                rep->canSkipUntil = attr ? vlc_tick_from_sec(attr->floatingPoint()) : 0;
+            }
+            break;
+
+            case AttributesTag::EXTXSKIP:
+            {
+                /* Delta update, replaces the segments we already have */
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->getAttributeByName("SKIPPED-SEGMENTS");
+                if(attr)
+                {
+                    if(windowStart == std::numeric_limits<uint64_t>::max())
+                        windowStart = sequenceNumber;
+                    sequenceNumber += attr->decimal();
+                }
+            }
+            break;
+
             case SingleValueTag::EXTXDISCONTINUITYSEQUENCE:
                 discontinuitySequence = static_cast<const SingleValueTag *>(tag)->getValue().decimal();
                 break;
@@ -451,9 +673,44 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
         }
     }
 
+    /* Low latency live edge, segment only available as parts so far.
+     * Encrypted parts are unsupported, they'll be read once complete. */
+    if(rep->isLowLatency() && encryption.method == CommonEncryption::Method::None &&
+       (!parts.empty() || !preloadHint.uri.empty()))
+    {
+        HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber);
+        if(segment)
+        {
+            vlc_tick_t nzDuration = 0;
+            for(const HLSPart &part : parts)
+                nzDuration += part.duration;
+            if(nzDuration == 0)
+                nzDuration = rep->partTargetDuration;
+            segment->duration.Set(timescale.ToScaled(nzDuration));
+            segment->startTime.Set(timescale.ToScaled(nzStartTime));
+            if(absReferenceTime != VLC_TICK_INVALID)
+                segment->setDisplayTime(absReferenceTime);
+            segment->setDiscontinuitySequenceNumber(discontinuitySequence);
+            segment->discontinuity = discontinuity;
+            segment->complete = false;
+            segment->parts = parts;
+            segment->preloadHint = preloadHint;
+            segmentstoappend.push_back(segment);
+        }
+    }
+
+    if(rep->isLowLatency())
+    {
+        /* recommended default of 3 part durations */
+        if(partHoldBack == 0)
+            partHoldBack = rep->partTargetDuration * 3;
+        rep->getPlaylist()->setMinBuffering(partHoldBack);
+    }
+
     for(HLSSegment *seg : segmentstoappend)
         segmentList->addSegment(seg);
     segmentstoappend.clear();
+    segmentList->setWindowStart(windowStart);
 
     if(rep->isLive())
     {
@@ -25,6 +25,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <list>
+#include <vector>
 
 #include <vlc_common.h>
 
@@ -50,6 +51,7 @@ namespace hls
         class AttributesTag;
         class Tag;
         class HLSRepresentation;
+        class HLSPart;
 
         class M3U8Parser
         {
@@ -59,6 +61,8 @@ namespace hls
 
                 M3U8 *             parse  (vlc_object_t *p_obj, stream_t *p_stream, const std::string &);
                 bool appendSegmentsFromPlaylistURI(vlc_object_t *, HLSRepresentation *);
+                bool getPartsFromPlaylistURI(vlc_object_t *, const std::string &, uint64_t,
+                                             std::vector<HLSPart> &, HLSPart &, bool *);
 
             private:
                 HLSRepresentation * createRepresentation(BaseAdaptationSet *, const AttributesTag *);
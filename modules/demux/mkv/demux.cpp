@@ -288,7 +288,10 @@ bool demux_sys_t::PreparePlayback( virtual_segment_c & new_vsegment )
         i_current_title = p_current_vsegment->i_sys_title;
     }
     if( !p_current_vsegment->CurrentSegment()->b_cues )
+    {
         msg_Warn( &p_current_vsegment->CurrentSegment()->sys.demuxer, "no cues/empty cues found->seek won't be precise" );
+        p_current_vsegment->CurrentSegment()->StartIndexer();
+    }
 
     i_duration = p_current_vsegment->Duration();
 
@@ -22,12 +22,16 @@
  *****************************************************************************/
 
 #include "matroska_segment.hpp"
+#include "matroska_segment_indexer.hpp"
 #include "chapters.hpp"
 #include "demux.hpp"
 #include "util.hpp"
 #include "Ebml_dispatcher.hpp"
 
 #include <vlc_arrays.h>
+#include <vlc_configuration.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
 
 #include <new>
 #include <iterator>
@@ -50,6 +54,8 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, matroska_iostream
     ,i_attachments_position(-1)
     ,cluster(NULL)
     ,i_block_pos(0)
+    ,i_block_payload_pos(0)
+    ,i_block_payload_size(0)
     ,p_segment_uid(NULL)
     ,p_prev_segment_uid(NULL)
     ,p_next_segment_uid(NULL)
@@ -64,11 +70,20 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, matroska_iostream
     ,ep( EbmlParser(&estream, p_seg, &demuxer.demuxer ))
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
+    ,indexer(NULL)
 {
 }
 
 matroska_segment_c::~matroska_segment_c()
 {
+    if( indexer )
+    {
+        indexer->Stop();
+        indexer->Flush( _seeker );
+        delete indexer;
+    }
+    _seeker.save_index( VLC_OBJECT( &sys.demuxer ) );
+
     free( psz_writing_application );
     free( psz_muxing_application );
     free( psz_segment_filename );
@@ -686,6 +701,8 @@ bool matroska_segment_c::Preload( )
 
     ComputeTrackPriority();
 
+    LoadSeekIndex();
+
     b_preloaded = true;
 
     if( cluster )
@@ -694,6 +711,80 @@ bool matroska_segment_c::Preload( )
     return true;
 }
 
+/* Without Cues, reuse the cluster and keyframe positions
+ * found by scanning the same segment during a previous playback */
+void matroska_segment_c::LoadSeekIndex()
+{
+    if( b_cues || !sys.b_seekable ||
+        !var_InheritBool( &sys.demuxer, "mkv-seek-index-cache" ) )
+        return;
+
+    stream_t *s = es.I_O().GetStream();
+    uint64_t i_size;
+    if( s->psz_url == NULL || vlc_stream_GetSize( s, &i_size ) || i_size == 0 )
+        return;
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_cachedir == NULL )
+        return;
+
+    /* files rewritten in place, even to the same size, must not reuse it */
+    uint64_t i_mtime;
+    if( vlc_stream_GetMTime( s, &i_mtime ) )
+        i_mtime = 0;
+
+    /* the same file is expected to keep the same location, size,
+     * modification time and segment UID */
+    uint8_t key[24];
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, s->psz_url, strlen( s->psz_url ) );
+    SetQWBE( &key[0], i_size );
+    SetQWBE( &key[8], segment->GetElementPosition() );
+    SetQWBE( &key[16], i_mtime );
+    vlc_hash_md5_Update( &md5, key, sizeof(key) );
+    if( p_segment_uid )
+        vlc_hash_md5_Update( &md5, p_segment_uid->GetBuffer(), p_segment_uid->GetSize() );
+
+    uint8_t digest[VLC_HASH_MD5_DIGEST_SIZE];
+    char hex[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_Finish( &md5, digest, sizeof(digest) );
+    vlc_hex_encode_binary( digest, sizeof(digest), hex );
+
+    std::string path = std::string( psz_cachedir ) + DIR_SEP "mkv" DIR_SEP + hex + ".idx";
+    free( psz_cachedir );
+
+    _seeker.load_index( VLC_OBJECT( &sys.demuxer ), path, i_size );
+}
+
+/* Index the clusters of files without Cues while playing,
+ * on a separate stream so the demux reading position is untouched */
+void matroska_segment_c::StartIndexer()
+{
+    if( indexer || b_cues || !sys.b_fastseekable ||
+        !var_InheritBool( &sys.demuxer, "mkv-background-index" ) )
+        return;
+
+    stream_t *s = es.I_O().GetStream();
+    if( s->psz_url == NULL )
+        return;
+
+    SegmentSeeker::track_ids_t track_ids;
+    for( tracks_map_t::const_iterator it = tracks.begin(); it != tracks.end(); ++it )
+        track_ids.push_back( it->first );
+
+    uint64_t i_end = segment->IsFiniteSize() ? segment->GetEndPosition()
+                                             : std::numeric_limits<uint64_t>::max();
+
+    indexer = new SegmentIndexer( &sys.demuxer, i_timescale, segment->GetDataStart(), i_end,
+                                  _seeker._ranges_searched, track_ids );
+    if( !indexer->Start( s->psz_url ) )
+    {
+        delete indexer;
+        indexer = NULL;
+    }
+}
+
 /* Here we try to load elements that were found in Seek Heads, but not yet parsed */
 bool matroska_segment_c::LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int64_t i_element_position )
 {
@@ -839,6 +930,9 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 
     // find appropriate seekpoints //
 
+    if( indexer )
+        indexer->Flush( _seeker );
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
@@ -1175,6 +1269,106 @@ void matroska_segment_c::ESDestroy( )
     }
 }
 
+/* Whether the block payload can be read straight into the output block_t
+ * by BlockDecode() rather than copied from the libebml buffer */
+static bool CanReadPayloadLater( const mkv_track_t & track, bool b_simpleblock )
+{
+    if( track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+    {
+        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER )
+        {
+            if( track.p_compression_data == NULL )
+                return false;
+        }
+        else if( track.i_compression_type != MATROSKA_COMPRESSION_NONE )
+            return false; /* decompressed from memory */
+    }
+
+    switch( track.fmt.i_codec )
+    {
+        case VLC_CODEC_WAVPACK: /* repacked with its own header */
+        case VLC_CODEC_COOK:
+        case VLC_CODEC_ATRAC3:  /* reordered through the track buffers */
+            return false;
+        case VLC_CODEC_THEORA:  /* keyframe flag read from the payload */
+            return b_simpleblock;
+        default:
+            return true;
+    }
+}
+
+/* Only read the header of non laced blocks, the payload position is kept
+ * for BlockPayloadGet(). The file pointer is left at the block data start
+ * when nothing was read. The payload is read after moving back in the
+ * file, which only seekable inputs can do. */
+bool matroska_segment_c::ReadBlockHeader( KaxInternalBlock & block, bool b_simpleblock )
+{
+    i_block_payload_size = 0;
+
+    if( !sys.b_seekable )
+        return false;
+
+    const uint64_t i_data_pos = es.I_O().getFilePointer();
+    uint8_t header[2 + 2 + 1];
+    const size_t i_header = es.I_O().read( header, sizeof(header) );
+    es.I_O().setFilePointer( i_data_pos, seek_beginning );
+
+    /* track numbers on 2 bytes at most, as libmatroska */
+    size_t i_track_len;
+    unsigned i_track;
+    if( i_header >= 4 && ( header[0] & 0x80 ) )
+    {
+        i_track = header[0] & 0x7F;
+        i_track_len = 1;
+    }
+    else if( i_header >= 5 && ( header[0] & 0x40 ) )
+    {
+        i_track = ( ( header[0] & 0x3F ) << 8 ) | header[1];
+        i_track_len = 2;
+    }
+    else
+        return false;
+
+    const size_t i_head_size = i_track_len + 2 + 1;
+    if( ( header[i_head_size - 1] & 0x06 ) != 0 || /* laced */
+        block.GetSize() <= i_head_size )
+        return false;
+
+    tracks_map_t::const_iterator it = tracks.find( i_track );
+    if( it == tracks.end() || !CanReadPayloadLater( *it->second, b_simpleblock ) )
+        return false;
+
+    /* the partial read computes the global timestamp from the parent */
+    block.SetParent( *cluster );
+    block.ReadData( es.I_O(), SCOPE_PARTIAL_DATA );
+
+    i_block_payload_pos = i_data_pos + i_head_size;
+    i_block_payload_size = block.GetSize() - i_head_size;
+    return true;
+}
+
+block_t * matroska_segment_c::BlockPayloadGet( size_t i_offset )
+{
+    if( unlikely( i_block_payload_size > SIZE_MAX - i_offset ) )
+        return NULL;
+
+    block_t *p_block = block_Alloc( i_block_payload_size + i_offset );
+    if( unlikely( p_block == NULL ) )
+        return NULL;
+
+    const uint64_t i_saved_pos = es.I_O().getFilePointer();
+    es.I_O().setFilePointer( i_block_payload_pos, seek_beginning );
+    const size_t i_read = es.I_O().read( p_block->p_buffer + i_offset, i_block_payload_size );
+    es.I_O().setFilePointer( i_saved_pos, seek_beginning );
+
+    if( i_read != i_block_payload_size )
+    {
+        block_Release( p_block );
+        return NULL;
+    }
+    return p_block;
+}
+
 int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_simpleblock,
                                   KaxBlockAdditions * & pp_additions,
                                   bool *pb_key_picture, bool *pb_discardable_picture,
@@ -1183,6 +1377,7 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
     pp_simpleblock = NULL;
     pp_block = NULL;
     pp_additions = NULL;
+    i_block_payload_size = 0;
 
     *pb_key_picture         = true;
     *pb_discardable_picture = false;
@@ -1258,8 +1453,11 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             }
 
             vars.simpleblock = &ksblock;
-            vars.simpleblock->ReadData( vars.obj->es.I_O() );
-            vars.simpleblock->SetParent( *vars.obj->cluster );
+            if( !vars.obj->ReadBlockHeader( ksblock, true ) )
+            {
+                vars.simpleblock->ReadData( vars.obj->es.I_O() );
+                vars.simpleblock->SetParent( *vars.obj->cluster );
+            }
 
             if( ksblock.IsKeyframe() )
             {
@@ -1278,8 +1476,11 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
         E_CASE( KaxBlock, kblock )
         {
             vars.block = &kblock;
-            vars.block->ReadData( vars.obj->es.I_O() );
-            vars.block->SetParent( *vars.obj->cluster );
+            if( !vars.obj->ReadBlockHeader( kblock, false ) )
+            {
+                vars.block->ReadData( vars.obj->es.I_O() );
+                vars.block->SetParent( *vars.obj->cluster );
+            }
 
             const mkv_track_t *p_track = vars.obj->FindTrackByBlock( &kblock, NULL );
             if( p_track != NULL && p_track->fmt.i_cat == SPU_ES )
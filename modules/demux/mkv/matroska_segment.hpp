@@ -77,6 +77,7 @@ public:
 };
 
 struct demux_sys_t;
+class SegmentIndexer;
 
 class matroska_segment_c
 {
@@ -113,6 +114,9 @@ public:
 
     KaxCluster              *cluster;
     uint64_t                i_block_pos;
+    /* payload of the last block read, when left in the file */
+    uint64_t                i_block_payload_pos;
+    uint64_t                i_block_payload_size;
     KaxSegmentUID           *p_segment_uid;
     KaxPrevUID              *p_prev_segment_uid;
     KaxNextUID              *p_next_segment_uid;
@@ -144,12 +148,14 @@ public:
     bool Preload();
     bool PreloadFamily( const matroska_segment_c & segment );
     bool PreloadClusters( uint64_t i_cluster_position );
+    void StartIndexer();
     void InformationCreate();
 
     bool Seek( demux_t &, vlc_tick_t i_mk_date, vlc_tick_t i_mk_time_offset, bool b_accurate );
 
     int BlockGet( KaxBlock * &, KaxSimpleBlock * &, KaxBlockAdditions * &,
                   bool *, bool *, int64_t *);
+    block_t * BlockPayloadGet( size_t i_offset );
 
     mkv_track_t * FindTrackByBlock(const KaxBlock *, const KaxSimpleBlock * );
 
@@ -164,6 +170,7 @@ private:
     void LoadCues( KaxCues *cues );
     void LoadTags( KaxTags *tags );
     bool LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int64_t i_element_position );
+    bool ReadBlockHeader( KaxInternalBlock &, bool b_simpleblock );
     void ParseInfo( KaxInfo *info );
     void ParseAttachments( KaxAttachments *attachments );
     void ParseChapters( KaxChapters *chapters );
@@ -176,8 +183,10 @@ private:
     bool TrackInit( mkv_track_t * p_tk );
     void ComputeTrackPriority();
     void EnsureDuration();
+    void LoadSeekIndex();
 
     SegmentSeeker _seeker;
+    SegmentIndexer *indexer;
 
     friend SegmentSeeker;
 };
@@ -0,0 +1,378 @@
+/*****************************************************************************
+ * matroska_segment_indexer.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "matroska_segment_indexer.hpp"
+
+#include <vlc_stream.h>
+
+#include <limits>
+
+namespace {
+    const uint32_t ID_CLUSTER        = 0x1F43B675;
+    const uint32_t ID_TIMESTAMP      = 0xE7;
+    const uint32_t ID_SIMPLEBLOCK    = 0xA3;
+    const uint32_t ID_BLOCKGROUP     = 0xA0;
+    const uint32_t ID_BLOCK          = 0xA1;
+    const uint32_t ID_REFERENCEBLOCK = 0xFB;
+
+    /* clusters indexed before handing them to the demux thread */
+    const unsigned PUBLISH_INTERVAL  = 32;
+
+    /* EBML variable size integer, the marker bit is kept for IDs */
+    size_t vint_get( const uint8_t *p, size_t i_max, bool b_keep_marker,
+                     uint64_t *pi_value, bool *pb_unknown )
+    {
+        if( i_max == 0 || p[0] == 0 )
+            return 0;
+
+        size_t i_len = 1;
+        while( !( p[0] & ( 0x80 >> ( i_len - 1 ) ) ) )
+            i_len++;
+        if( i_len > i_max )
+            return 0;
+
+        uint64_t i_value = b_keep_marker ? p[0] : p[0] & ( 0xFF >> i_len );
+        bool b_all_ones = ( p[0] & ( 0xFF >> i_len ) ) == ( 0xFF >> i_len );
+        for( size_t i = 1; i < i_len; i++ )
+        {
+            i_value = ( i_value << 8 ) | p[i];
+            b_all_ones &= p[i] == 0xFF;
+        }
+
+        *pi_value = i_value;
+        if( pb_unknown )
+            *pb_unknown = b_all_ones;
+        return i_len;
+    }
+}
+
+namespace mkv {
+
+SegmentIndexer::SegmentIndexer( demux_t *p_demux_, uint64_t i_timescale_,
+                                fptr_t start, fptr_t end,
+                                SegmentSeeker::ranges_t const& searched_,
+                                SegmentSeeker::track_ids_t const& tracks_ )
+    : p_demux( p_demux_ )
+    , s( NULL )
+    , i_timescale( i_timescale_ )
+    , i_start( start )
+    , i_end( end )
+    , searched( searched_ )
+    , tracks( tracks_ )
+    , b_abort( false )
+    , is_running( false )
+{
+    last_cluster.fpos = std::numeric_limits<fptr_t>::max();
+    vlc_mutex_init( &lock );
+    vlc_cond_init( &wait );
+}
+
+SegmentIndexer::~SegmentIndexer()
+{
+    Stop();
+    if( s )
+        vlc_stream_Delete( s );
+}
+
+bool SegmentIndexer::Start( const char *psz_url )
+{
+    s = vlc_stream_NewURL( p_demux, psz_url );
+    if( s == NULL )
+        return false;
+
+    is_running = !vlc_clone( &thread, IndexThread, this );
+    return is_running;
+}
+
+void SegmentIndexer::Stop()
+{
+    if( !is_running )
+        return;
+
+    {
+        vlc_mutex_locker lock_guard( &lock );
+        b_abort = true;
+        vlc_cond_signal( &wait );
+    }
+
+    vlc_join( thread, NULL );
+    is_running = false;
+}
+
+void SegmentIndexer::Flush( SegmentSeeker & seeker )
+{
+    SegmentSeeker::Index index;
+    {
+        vlc_mutex_locker lock_guard( &lock );
+        std::swap( index, pending );
+    }
+    if( !index.empty() )
+        seeker.merge( index );
+}
+
+bool SegmentIndexer::ReadElementHeader( fptr_t pos, uint32_t *pi_id, uint64_t *pi_size, fptr_t *pi_data )
+{
+    uint8_t p_header[4 + 8];
+    if( vlc_stream_Seek( s, pos ) )
+        return false;
+    ssize_t i_read = vlc_stream_Read( s, p_header, sizeof(p_header) );
+    if( i_read <= 0 )
+        return false;
+
+    uint64_t i_id;
+    size_t i_id_len = vint_get( p_header, std::min<size_t>( i_read, 4 ), true, &i_id, NULL );
+    if( i_id_len == 0 )
+        return false;
+
+    bool b_unknown;
+    size_t i_size_len = vint_get( &p_header[i_id_len], i_read - i_id_len, false, pi_size, &b_unknown );
+    if( i_size_len == 0 )
+        return false;
+    if( b_unknown )
+        *pi_size = std::numeric_limits<uint64_t>::max();
+
+    *pi_id = i_id;
+    *pi_data = pos + i_id_len + i_size_len;
+    return true;
+}
+
+bool SegmentIndexer::ReadBlockHeader( fptr_t pos, SegmentSeeker::track_id_t *pi_track,
+                                      int16_t *pi_rel_ts, uint8_t *pi_flags )
+{
+    uint8_t p_header[8 + 3];
+    if( vlc_stream_Seek( s, pos ) )
+        return false;
+    ssize_t i_read = vlc_stream_Read( s, p_header, sizeof(p_header) );
+    if( i_read <= 0 )
+        return false;
+
+    uint64_t i_track;
+    size_t i_len = vint_get( p_header, i_read, false, &i_track, NULL );
+    if( i_len == 0 || i_len + 3 > (size_t) i_read )
+        return false;
+
+    *pi_track = i_track;
+    *pi_rel_ts = (int16_t) GetWBE( &p_header[i_len] );
+    *pi_flags = p_header[i_len + 2];
+    return true;
+}
+
+bool SegmentIndexer::ReadUnsigned( fptr_t pos, uint64_t size, uint64_t *pi_value )
+{
+    uint8_t p_data[8];
+    if( size == 0 || size > sizeof(p_data) ||
+        vlc_stream_Seek( s, pos ) ||
+        vlc_stream_Read( s, p_data, size ) != (ssize_t) size )
+        return false;
+
+    *pi_value = 0;
+    for( size_t i = 0; i < size; i++ )
+        *pi_value = ( *pi_value << 8 ) | p_data[i];
+    return true;
+}
+
+void SegmentIndexer::AddKeyframe( SegmentSeeker::track_id_t track_id, fptr_t fpos,
+                                  uint64_t i_cluster_ts, int16_t i_rel_ts )
+{
+    if( std::find( tracks.begin(), tracks.end(), track_id ) == tracks.end() )
+        return;
+
+    /* same timestamp as KaxInternalBlock::GlobalTimestamp() */
+    vlc_tick_t pts = VLC_TICK_FROM_NS( ( (int64_t) i_cluster_ts + i_rel_ts ) * (int64_t) i_timescale );
+    found.tracks_seekpoints[ track_id ].push_back( SegmentSeeker::Seekpoint( fpos, pts ) );
+}
+
+bool SegmentIndexer::IndexCluster( fptr_t pos, fptr_t data, fptr_t end )
+{
+    uint64_t i_cluster_ts = std::numeric_limits<uint64_t>::max();
+    bool b_has_ts = false;
+
+    for( fptr_t child = data; child < end; )
+    {
+        uint32_t i_id;
+        uint64_t i_size;
+        fptr_t   child_data;
+
+        if( !ReadElementHeader( child, &i_id, &i_size, &child_data ) ||
+            child_data > end || i_size > end - child_data )
+            return false;
+
+        SegmentSeeker::track_id_t track_id;
+        int16_t i_rel_ts;
+        uint8_t i_flags;
+
+        switch( i_id )
+        {
+            case ID_TIMESTAMP:
+                b_has_ts = ReadUnsigned( child_data, i_size, &i_cluster_ts );
+                break;
+
+            case ID_SIMPLEBLOCK:
+                if( b_has_ts &&
+                    ReadBlockHeader( child_data, &track_id, &i_rel_ts, &i_flags ) &&
+                    ( i_flags & 0x80 ) )
+                    AddKeyframe( track_id, child, i_cluster_ts, i_rel_ts );
+                break;
+
+            case ID_BLOCKGROUP:
+            {
+                fptr_t block_pos = std::numeric_limits<fptr_t>::max();
+                fptr_t block_data = 0;
+                bool b_reference = false;
+                const fptr_t group_end = child_data + i_size;
+
+                for( fptr_t sub = child_data; sub < group_end; )
+                {
+                    uint32_t i_sub_id;
+                    uint64_t i_sub_size;
+                    fptr_t   sub_data;
+                    if( !ReadElementHeader( sub, &i_sub_id, &i_sub_size, &sub_data ) ||
+                        sub_data > group_end || i_sub_size > group_end - sub_data )
+                        return false;
+                    if( i_sub_id == ID_BLOCK )
+                    {
+                        block_pos = sub;
+                        block_data = sub_data;
+                    }
+                    else if( i_sub_id == ID_REFERENCEBLOCK )
+                        b_reference = true;
+                    sub = sub_data + i_sub_size;
+                }
+
+                if( b_has_ts && !b_reference && block_data &&
+                    ReadBlockHeader( block_data, &track_id, &i_rel_ts, &i_flags ) )
+                    AddKeyframe( track_id, block_pos, i_cluster_ts, i_rel_ts );
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        child = child_data + i_size;
+    }
+
+    if( !b_has_ts )
+        return true; /* broken cluster, leave it to the demux thread */
+
+    SegmentSeeker::Cluster cinfo;
+    cinfo.fpos     = pos;
+    cinfo.pts      = VLC_TICK_FROM_NS( i_cluster_ts * i_timescale );
+    cinfo.duration = -1;
+    cinfo.size     = end - pos;
+
+    if( last_cluster.fpos != std::numeric_limits<fptr_t>::max() )
+    {
+        if( last_cluster.fpos + last_cluster.size == cinfo.fpos )
+            last_cluster.duration = cinfo.pts - last_cluster.pts;
+        found.clusters.push_back( last_cluster );
+    }
+    last_cluster = cinfo;
+
+    found.cluster_positions.push_back( pos );
+    found.ranges.push_back( SegmentSeeker::Range( pos, end ) );
+    return true;
+}
+
+bool SegmentIndexer::IsSearched( fptr_t start, fptr_t end ) const
+{
+    for( SegmentSeeker::ranges_t::const_iterator it = searched.begin(); it != searched.end(); ++it )
+    {
+        if( it->start <= start && end <= it->end )
+            return true;
+    }
+    return false;
+}
+
+bool SegmentIndexer::Publish()
+{
+    vlc_mutex_locker lock_guard( &lock );
+
+    pending.ranges.insert( pending.ranges.end(), found.ranges.begin(), found.ranges.end() );
+    pending.cluster_positions.insert( pending.cluster_positions.end(),
+                                      found.cluster_positions.begin(), found.cluster_positions.end() );
+    pending.clusters.insert( pending.clusters.end(), found.clusters.begin(), found.clusters.end() );
+    for( SegmentSeeker::tracks_seekpoints_t::const_iterator it = found.tracks_seekpoints.begin();
+         it != found.tracks_seekpoints.end(); ++it )
+    {
+        SegmentSeeker::seekpoints_t & seekpoints = pending.tracks_seekpoints[ it->first ];
+        seekpoints.insert( seekpoints.end(), it->second.begin(), it->second.end() );
+    }
+    found = SegmentSeeker::Index();
+
+    /* leave the disk to the demux thread for a moment */
+    if( !b_abort )
+        vlc_cond_timedwait( &wait, &lock, vlc_tick_now() + VLC_TICK_FROM_MS(5) );
+
+    return !b_abort;
+}
+
+void SegmentIndexer::IndexThread()
+{
+    vlc_thread_set_name("vlc-mkv-index");
+
+    int canc = vlc_savecancel ();
+
+    unsigned i_clusters = 0;
+    fptr_t pos = i_start;
+    while( pos < i_end )
+    {
+        uint32_t i_id;
+        uint64_t i_size;
+        fptr_t   data;
+
+        /* unknown sizes would need a full parse, as when demuxing */
+        if( !ReadElementHeader( pos, &i_id, &i_size, &data ) ||
+            i_size == std::numeric_limits<uint64_t>::max() )
+            break;
+
+        const fptr_t next = data + i_size;
+        if( i_id == ID_CLUSTER && !IsSearched( pos, next ) )
+        {
+            if( !IndexCluster( pos, data, next ) )
+                break;
+            if( ++i_clusters % PUBLISH_INTERVAL == 0 && !Publish() )
+                break;
+        }
+
+        pos = next;
+    }
+
+    if( last_cluster.fpos != std::numeric_limits<fptr_t>::max() )
+        found.clusters.push_back( last_cluster );
+    {
+        vlc_mutex_locker lock_guard( &lock );
+        b_abort = true; /* no more waiting in Publish() */
+    }
+    Publish();
+
+    msg_Dbg( p_demux, "background indexing stopped at %" PRIu64 " after %u clusters",
+             pos, i_clusters );
+
+    vlc_restorecancel (canc);
+}
+
+void *SegmentIndexer::IndexThread( void *data )
+{
+    static_cast<SegmentIndexer*>( data )->IndexThread();
+    return NULL;
+}
+
+} // namespace
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * matroska_segment_indexer.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+#define MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+
+#include "matroska_segment_seeker.hpp"
+
+#include <vlc_threads.h>
+
+namespace mkv {
+
+/* Walks the clusters of a segment without Cues on its own stream,
+ * so seeks find an already populated SegmentSeeker index instead
+ * of scanning from the demux thread.
+ * Only the element headers are read, block payloads are skipped. */
+class SegmentIndexer
+{
+    public:
+        typedef SegmentSeeker::fptr_t fptr_t;
+
+        SegmentIndexer( demux_t *, uint64_t i_timescale,
+                        fptr_t start, fptr_t end,
+                        SegmentSeeker::ranges_t const& searched,
+                        SegmentSeeker::track_ids_t const& tracks );
+        ~SegmentIndexer();
+
+        bool Start( const char *psz_url );
+        void Stop();
+
+        /* hands what was found so far over to the seeker, from the demux thread */
+        void Flush( SegmentSeeker & );
+
+    private:
+        bool ReadElementHeader( fptr_t pos, uint32_t *pi_id, uint64_t *pi_size, fptr_t *pi_data );
+        bool ReadBlockHeader( fptr_t pos, SegmentSeeker::track_id_t *, int16_t *, uint8_t * );
+        bool ReadUnsigned( fptr_t pos, uint64_t size, uint64_t * );
+        bool IndexCluster( fptr_t pos, fptr_t data, fptr_t end );
+        void AddKeyframe( SegmentSeeker::track_id_t, fptr_t, uint64_t i_cluster_ts, int16_t i_rel_ts );
+        bool IsSearched( fptr_t start, fptr_t end ) const;
+        bool Publish();
+
+        void IndexThread();
+        static void *IndexThread( void * );
+
+        demux_t            *p_demux;
+        stream_t           *s;
+        const uint64_t      i_timescale;
+        const fptr_t        i_start;
+        const fptr_t        i_end;
+        const SegmentSeeker::ranges_t    searched;
+        const SegmentSeeker::track_ids_t tracks;
+
+        /* owned by the index thread */
+        SegmentSeeker::Index found;
+        SegmentSeeker::Cluster last_cluster;
+
+        vlc_thread_t        thread;
+        vlc_mutex_t         lock;
+        vlc_cond_t          wait;
+        SegmentSeeker::Index pending;
+        bool                b_abort;
+        bool                is_running;
+};
+
+} // namespace
+
+#endif
@@ -28,6 +28,16 @@
 #include "util.hpp"
 #include "stream_io_callback.hpp"
 
+#include <vlc_block.h>
+#include <vlc_fs.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <sstream>
 #include <limits>
 
@@ -46,6 +56,120 @@ namespace {
 
     template<class It> It prev_( It it ) { return --it; }
     template<class It> It next_( It it ) { return ++it; }
+
+    /* seek index file: magic, then big endian tables
+     *  ranges:    count, { start, end }
+     *  positions: count, { fpos }
+     *  clusters:  count, { fpos, pts, duration, size }
+     *  tracks:    count, { track_id, count, { fpos, pts, trust } } */
+    const char   index_magic[8] = { 'V','L','C','M','K','V','X','1' };
+    const size_t index_max_size = 16 << 20;
+    /* all index files together, the least recently used are removed first */
+    const uint64_t index_dir_max_size = 64 << 20;
+
+    struct IndexFile
+    {
+        std::string path;
+        time_t      mtime;
+        uint64_t    size;
+
+        bool operator<( IndexFile const& other ) const
+        {
+            return mtime < other.mtime;
+        }
+    };
+
+    void trim_index_dir( vlc_object_t *p_obj, std::string const& dirpath )
+    {
+        vlc_DIR *dir = vlc_opendir( dirpath.c_str() );
+        if( dir == NULL )
+            return;
+
+        std::vector<IndexFile> files;
+        uint64_t total = 0;
+        const char *name;
+        while( ( name = vlc_readdir( dir ) ) != NULL )
+        {
+            const size_t len = strlen( name );
+            struct stat st;
+            if( len < 4 || strcmp( &name[len - 4], ".idx" ) )
+                continue;
+
+            IndexFile file;
+            file.path = dirpath + DIR_SEP + name;
+            if( vlc_stat( file.path.c_str(), &st ) )
+                continue;
+            file.mtime = st.st_mtime;
+            file.size = st.st_size;
+            total += file.size;
+            files.push_back( file );
+        }
+        vlc_closedir( dir );
+
+        if( total <= index_dir_max_size )
+            return;
+
+        std::sort( files.begin(), files.end() );
+        for( std::vector<IndexFile>::const_iterator it = files.begin();
+             it != files.end() && total > index_dir_max_size; ++it )
+        {
+            if( vlc_unlink( it->path.c_str() ) == 0 )
+            {
+                msg_Dbg( p_obj, "removed seek index %s", it->path.c_str() );
+                total -= it->size;
+            }
+        }
+    }
+
+    class IndexWriter
+    {
+        public:
+            void put32( uint32_t v )
+            {
+                uint8_t b[4];
+                SetDWBE( b, v );
+                data.insert( data.end(), b, b + 4 );
+            }
+            void put64( uint64_t v )
+            {
+                uint8_t b[8];
+                SetQWBE( b, v );
+                data.insert( data.end(), b, b + 8 );
+            }
+            std::vector<uint8_t> data;
+    };
+
+    class IndexReader
+    {
+        public:
+            IndexReader( const uint8_t *p, size_t size )
+                : p( p ), left( size ), error( false )
+            { }
+            uint32_t get32()
+            {
+                if( error || left < 4 ) { error = true; return 0; }
+                uint32_t v = GetDWBE( p );
+                p += 4; left -= 4;
+                return v;
+            }
+            uint64_t get64()
+            {
+                if( error || left < 8 ) { error = true; return 0; }
+                uint64_t v = GetQWBE( p );
+                p += 8; left -= 8;
+                return v;
+            }
+            /* entries which can't fit in what's left are corrupted */
+            uint32_t getCount( size_t entry_size )
+            {
+                uint32_t count = get32();
+                if( left / entry_size < count ) { error = true; return 0; }
+                return count;
+            }
+            const uint8_t *p;
+            size_t left;
+            bool error;
+    };
 }
 
 namespace mkv {
@@ -466,6 +590,200 @@ SegmentSeeker::get_search_areas( fptr_t start, fptr_t end ) const
     return areas_to_search;
 }
 
+SegmentSeeker::fptr_t
+SegmentSeeker::searched_size() const
+{
+    fptr_t size = 0;
+    for( ranges_t::const_iterator it = _ranges_searched.begin(); it != _ranges_searched.end(); ++it )
+        size += it->end - it->start;
+    return size;
+}
+
+void
+SegmentSeeker::merge( Index const& index )
+{
+    for( ranges_t::const_iterator it = index.ranges.begin(); it != index.ranges.end(); ++it )
+        mark_range_as_searched( *it );
+    for( cluster_positions_t::const_iterator it = index.cluster_positions.begin(); it != index.cluster_positions.end(); ++it )
+    {
+        if( !std::binary_search( _cluster_positions.begin(), _cluster_positions.end(), *it ) )
+            add_cluster_position( *it );
+    }
+    for( std::vector<Cluster>::const_iterator it = index.clusters.begin(); it != index.clusters.end(); ++it )
+        _clusters.insert( cluster_map_t::value_type( it->pts, *it ) );
+    for( tracks_seekpoints_t::const_iterator it = index.tracks_seekpoints.begin(); it != index.tracks_seekpoints.end(); ++it )
+    {
+        for( seekpoints_t::const_iterator sp = it->second.begin(); sp != it->second.end(); ++sp )
+            add_seekpoint( it->first, *sp );
+    }
+}
+
+bool
+SegmentSeeker::load_index( vlc_object_t *p_obj, std::string const& path, fptr_t max_fpos )
+{
+    _index_path = path;
+
+    block_t *p_block = block_FilePath( path.c_str(), false );
+    if( p_block == NULL )
+        return false;
+
+    if( p_block->i_buffer <= sizeof(index_magic) || p_block->i_buffer > index_max_size ||
+        memcmp( p_block->p_buffer, index_magic, sizeof(index_magic) ) )
+    {
+        block_Release( p_block );
+        return false;
+    }
+
+    /* parse everything before merging, the file could be from another run
+     * on a truncated file, or damaged */
+    IndexReader r( &p_block->p_buffer[sizeof(index_magic)], p_block->i_buffer - sizeof(index_magic) );
+
+    Index index;
+    for( uint32_t i = r.getCount( 16 ); i > 0; i-- )
+    {
+        fptr_t start = r.get64();
+        fptr_t end = r.get64();
+        if( start > end || end > max_fpos )
+            r.error = true;
+        index.ranges.push_back( Range( start, end ) );
+    }
+
+    for( uint32_t i = r.getCount( 8 ); i > 0; i-- )
+    {
+        index.cluster_positions.push_back( r.get64() );
+        if( index.cluster_positions.back() >= max_fpos )
+            r.error = true;
+    }
+
+    for( uint32_t i = r.getCount( 32 ); i > 0; i-- )
+    {
+        Cluster c;
+        c.fpos = r.get64();
+        c.pts = r.get64();
+        c.duration = r.get64();
+        c.size = r.get64();
+        if( c.fpos >= max_fpos )
+            r.error = true;
+        index.clusters.push_back( c );
+    }
+
+    for( uint32_t i = r.getCount( 12 ); i > 0 && !r.error; i-- )
+    {
+        seekpoints_t& seekpoints = index.tracks_seekpoints[ r.get64() ];
+        for( uint32_t j = r.getCount( 20 ); j > 0; j-- )
+        {
+            fptr_t fpos = r.get64();
+            vlc_tick_t pts = r.get64();
+            uint32_t trust = r.get32();
+            if( fpos >= max_fpos ||
+                ( trust != Seekpoint::TRUSTED && trust != Seekpoint::QUESTIONABLE ) )
+                r.error = true;
+            seekpoints.push_back( Seekpoint( fpos, pts, Seekpoint::TrustLevel( trust ) ) );
+        }
+    }
+
+    const bool b_error = r.error || r.left;
+    block_Release( p_block );
+    if( b_error )
+    {
+        msg_Warn( p_obj, "ignoring invalid seek index %s", path.c_str() );
+        vlc_unlink( path.c_str() );
+        return false;
+    }
+
+    merge( index );
+
+#ifdef HAVE_UTIMENSAT
+    /* keep recently used indexes when trimming the directory */
+    utimensat( AT_FDCWD, path.c_str(), NULL, 0 );
+#endif
+
+    _index_searched_size = searched_size();
+
+    msg_Dbg( p_obj, "loaded seek index with %zu clusters, %" PRIu64 " bytes indexed",
+             _cluster_positions.size(), _index_searched_size );
+    return true;
+}
+
+void
+SegmentSeeker::save_index( vlc_object_t *p_obj ) const
+{
+    if( _index_path.empty() || searched_size() <= _index_searched_size )
+        return; /* nothing new was found */
+
+    IndexWriter w;
+    w.data.assign( index_magic, index_magic + sizeof(index_magic) );
+
+    w.put32( _ranges_searched.size() );
+    for( ranges_t::const_iterator it = _ranges_searched.begin(); it != _ranges_searched.end(); ++it )
+    {
+        w.put64( it->start );
+        w.put64( it->end );
+    }
+
+    w.put32( _cluster_positions.size() );
+    for( cluster_positions_t::const_iterator it = _cluster_positions.begin(); it != _cluster_positions.end(); ++it )
+        w.put64( *it );
+
+    w.put32( _clusters.size() );
+    for( cluster_map_t::const_iterator it = _clusters.begin(); it != _clusters.end(); ++it )
+    {
+        w.put64( it->second.fpos );
+        w.put64( it->second.pts );
+        w.put64( it->second.duration );
+        w.put64( it->second.size );
+    }
+
+    w.put32( _tracks_seekpoints.size() );
+    for( tracks_seekpoints_t::const_iterator it = _tracks_seekpoints.begin(); it != _tracks_seekpoints.end(); ++it )
+    {
+        w.put64( it->first );
+        size_t count_pos = w.data.size();
+        w.put32( 0 );
+        uint32_t count = 0;
+        for( seekpoints_t::const_iterator sp = it->second.begin(); sp != it->second.end(); ++sp )
+        {
+            /* initial seekpoints are guessed again on each open */
+            if( sp->trust_level <= Seekpoint::DISABLED || sp->pts < 0 )
+                continue;
+            w.put64( sp->fpos );
+            w.put64( sp->pts );
+            w.put32( sp->trust_level );
+            count++;
+        }
+        SetDWBE( &w.data[count_pos], count );
+    }
+
+    if( w.data.size() > index_max_size )
+        return;
+
+    const size_t dirlen = _index_path.find_last_of( DIR_SEP_CHAR );
+    const std::string dirpath = _index_path.substr( 0, dirlen );
+    if( dirlen != std::string::npos &&
+        vlc_mkdir_parent( dirpath.c_str(), 0700 ) && errno != EEXIST )
+    {
+        msg_Warn( p_obj, "cannot create seek index directory" );
+        return;
+    }
+
+    const std::string temppath = _index_path + ".tmp";
+    int fd = vlc_open( temppath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600 );
+    if( fd == -1 )
+        return;
+
+    bool b_error = vlc_write( fd, w.data.data(), w.data.size() ) != (ssize_t) w.data.size();
+    vlc_close( fd );
+
+    if( b_error || vlc_rename( temppath.c_str(), _index_path.c_str() ) )
+        vlc_unlink( temppath.c_str() );
+    else
+    {
+        msg_Dbg( p_obj, "saved seek index to %s", _index_path.c_str() );
+        if( dirlen != std::string::npos )
+            trim_index_dir( p_obj, dirpath );
+    }
+}
+
 void
 SegmentSeeker::mkv_jump_to( matroska_segment_c& ms, fptr_t fpos )
 {
@@ -29,6 +29,7 @@
 #include <vector>
 #include <map>
 #include <limits>
+#include <string>
 
 namespace mkv {
 
@@ -99,6 +100,17 @@ class SegmentSeeker
 
         typedef std::pair<Seekpoint, Seekpoint> seekpoint_pair_t;
 
+        /* positions found outside of the seeker, merged at once */
+        struct Index
+        {
+            ranges_t            ranges;
+            cluster_positions_t cluster_positions;
+            std::vector<Cluster> clusters;
+            tracks_seekpoints_t tracks_seekpoints;
+
+            bool empty() const { return ranges.empty() && cluster_positions.empty(); }
+        };
+
         void add_seekpoint( track_id_t, Seekpoint );
 
         seekpoint_pair_t get_seekpoints_around( vlc_tick_t, seekpoints_t const& );
@@ -119,11 +131,23 @@ class SegmentSeeker
         void mark_range_as_searched( Range );
         ranges_t get_search_areas( fptr_t start, fptr_t end ) const;
 
+        void merge( Index const& );
+
+        /* index found by scanning files without Cues, kept across sessions */
+        bool load_index( vlc_object_t *, std::string const& path, fptr_t max_fpos );
+        void save_index( vlc_object_t * ) const;
+
     public:
         ranges_t            _ranges_searched;
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
         cluster_map_t       _clusters;
+
+    private:
+        fptr_t searched_size() const;
+
+        std::string         _index_path;
+        fptr_t              _index_searched_size = 0;
 };
 
 } // namespace
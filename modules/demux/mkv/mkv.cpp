@@ -82,6 +82,16 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback") )
 
+    add_bool( "mkv-seek-index-cache", true,
+            N_("Keep the seek index of files without Cues"),
+            N_("Store the cluster and keyframe positions found while seeking in files "
+               "without Cues, and reuse them the next time the file is opened.") )
+
+    add_bool( "mkv-background-index", true,
+            N_("Index files without Cues in the background"),
+            N_("Find the cluster and keyframe positions of files without Cues "
+               "during playback, so seeking does not have to scan the file.") )
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
@@ -585,29 +595,42 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
 
     size_t frame_size = 0;
     size_t block_size = internal_block.GetSize();
-    const unsigned i_number_frames = internal_block.NumberFrames();
+    const unsigned i_number_frames = p_segment->i_block_payload_size
+                                   ? 1 : internal_block.NumberFrames();
 
     for( unsigned int i_frame = 0; i_frame < i_number_frames; i_frame++ )
     {
         block_t *p_block;
-        DataBuffer *data = &internal_block.GetBuffer(i_frame);
+        size_t extra_data = track.fmt.i_codec == VLC_CODEC_PRORES ? 8 : 0;
 
-        frame_size += data->Size();
-        if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
+        if( p_segment->i_block_payload_size )
         {
-            msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
-            break;
+            /* single frame left in the file by BlockGet(), read in place */
+            if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+                track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+                extra_data += track.p_compression_data->GetSize();
+            p_block = p_segment->BlockPayloadGet( extra_data );
         }
-        size_t extra_data = track.fmt.i_codec == VLC_CODEC_PRORES ? 8 : 0;
-
-        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
-            track.p_compression_data != NULL &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-            p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() + extra_data );
-        else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
-            p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
         else
-            p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        {
+            DataBuffer *data = &internal_block.GetBuffer(i_frame);
+
+            frame_size += data->Size();
+            if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
+            {
+                msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
+                break;
+            }
+
+            if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+                track.p_compression_data != NULL &&
+                track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+                p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() + extra_data );
+            else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
+                p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
+            else
+                p_block = MemToBlock( data->Buffer(), data->Size(), extra_data );
+        }
 
         if( p_block == NULL )
         {
@@ -57,6 +57,7 @@ class vlc_stream_io_callback: public IOCallback
     }
 
     bool IsEOF() const { return mb_eof; }
+    stream_t *GetStream() const { return s; }
 
     uint32_t read            ( void *p_buffer, size_t i_size) override;
     void     setFilePointer  ( int64_t i_offset, seek_mode mode = seek_beginning ) override;
@@ -58,12 +58,19 @@ mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_n
 stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
                                               unsigned i_track_index, uint64_t i_moof_pos )
 {
-    for( size_t i=0; i<p_index->i_entries; i++ )
+    /* first entry at or after the moof, positions are in file order */
+    size_t i_low = 0, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->pi_pos[i] >= i_moof_pos )
-            return p_index->p_times[i * p_index->i_tracks + i_track_index];
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->pi_pos[i_mid] >= i_moof_pos )
+            i_high = i_mid;
+        else
+            i_low = i_mid + 1;
     }
-    return 0;
+    if( i_low == p_index->i_entries )
+        return 0;
+    return p_index->p_times[i_low * p_index->i_tracks + i_track_index];
 }
 
 stime_t MP4_Fragment_Index_GetTracksDuration( const mp4_fragments_index_t *p_index )
@@ -78,18 +85,19 @@ bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_tim
         i_track_index >= p_index->i_tracks )
         return false;
 
-    for( size_t i=1; i<p_index->i_entries; i++ )
+    /* first entry starting after the time, times are increasing per track */
+    size_t i_low = 1, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->p_times[i * p_index->i_tracks + i_track_index] > *pi_time )
-        {
-            *pi_time = p_index->p_times[(i - 1) * p_index->i_tracks + i_track_index];
-            *pi_pos = p_index->pi_pos[i - 1];
-            return true;
-        }
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_times[i_mid * p_index->i_tracks + i_track_index] > *pi_time )
+            i_high = i_mid;
+        else
+            i_low = i_mid + 1;
     }
 
-    *pi_time = p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks];
-    *pi_pos = p_index->pi_pos[p_index->i_entries - 1];
+    *pi_time = p_index->p_times[(i_low - 1) * p_index->i_tracks + i_track_index];
+    *pi_pos = p_index->pi_pos[i_low - 1];
     return true;
 }
 
@@ -42,6 +42,9 @@
  * The input method HAS to be seekable
  */
 
+/* Largest top level box read at once on streams with slow seeks */
+#define MP4_BUFFERED_BOX_MAX (64 * 1024 * 1024)
+
 /* convert 16.16 fixed point to floating point */
 static double conv_fx( int32_t fx ) {
     double fp = fx;
@@ -395,6 +398,78 @@ static int MP4_PeekBoxHeader( stream_t *p_stream, MP4_Box_t *p_box )
     return 1;
 }
 
+static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father,
+                                         const uint32_t stopbefore[], bool *pb_restrictionhit );
+
+static void MP4_BoxOffsetUp( MP4_Box_t *p_box, uint64_t i_offset )
+{
+    while(p_box)
+    {
+        p_box->i_pos += i_offset;
+        MP4_BoxOffsetUp( p_box->p_first, i_offset );
+        p_box = p_box->p_next;
+    }
+}
+
+/* Index and header boxes are read with a single request when seeking is
+ * slow (network), and parsed from memory: children skipped or not fully
+ * read would otherwise cost a seek, then a new request, each */
+static bool MP4_BoxIsBuffered( stream_t *p_stream, const MP4_Box_t *p_father,
+                               const MP4_Box_t *p_peekbox )
+{
+    if( !p_father || p_father->i_type != ATOM_root ||
+        p_peekbox->i_size > MP4_BUFFERED_BOX_MAX )
+        return false;
+
+    switch( p_peekbox->i_type )
+    {
+        case ATOM_moov:
+        case ATOM_moof:
+        case ATOM_sidx:
+        case ATOM_mfra:
+            break;
+        default:
+            return false;
+    }
+
+    bool b_fastseekable;
+    if( vlc_stream_Control( p_stream, STREAM_CAN_FASTSEEK, &b_fastseekable ) != VLC_SUCCESS )
+        return false;
+    return !b_fastseekable;
+}
+
+static MP4_Box_t *MP4_ReadBoxBuffered( stream_t *p_stream, MP4_Box_t *p_father,
+                                       const MP4_Box_t *p_peekbox )
+{
+    block_t *p_block = vlc_stream_Block( p_stream, p_peekbox->i_size );
+    if( !p_block )
+        return NULL;
+
+    if( p_block->i_buffer < p_peekbox->i_size )
+    {
+        msg_Warn( p_stream, "truncated box %4.4s discarded", (char*) &p_peekbox->i_type );
+        block_Release( p_block );
+        return NULL;
+    }
+
+    MP4_Box_t *p_box = NULL;
+    /* memory streams are fast seekable, so this won't recurse */
+    stream_t *p_substream = vlc_stream_MemoryNew( p_stream, p_block->p_buffer,
+                                                  p_block->i_buffer, true );
+    if( p_substream )
+    {
+        bool b_restrictionhit = false;
+        p_box = MP4_ReadBoxRestricted( p_substream, p_father, NULL, &b_restrictionhit );
+        vlc_stream_Delete( p_substream );
+        /* do pos fixup */
+        if( p_box )
+            MP4_BoxOffsetUp( p_box, p_peekbox->i_pos );
+    }
+    block_Release( p_block );
+
+    return p_box;
+}
+
 /*****************************************************************************
  * MP4_ReadBoxRestricted : Reads box from current position
  *****************************************************************************
@@ -438,6 +513,9 @@ static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father
         }
     }
 
+    if( MP4_BoxIsBuffered( p_stream, p_father, &peekbox ) )
+        return MP4_ReadBoxBuffered( p_stream, p_father, &peekbox );
+
     /* Everything seems OK */
     MP4_Box_t *p_box = (MP4_Box_t *) malloc( sizeof(MP4_Box_t) );
     if( !p_box )
@@ -456,7 +534,12 @@ static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father
     /* Check is we consumed all data */
     if( vlc_stream_Tell( p_stream ) < i_next )
     {
-        MP4_Seek( p_stream, i_next - 1 ); /*  since past seek can fail when hitting EOF */
+        uint64_t i_stream_size;
+        /* skipping mdat is a new request on network streams, only
+         * seek twice when the box could be truncated */
+        if( vlc_stream_GetSize( p_stream, &i_stream_size ) != VLC_SUCCESS ||
+            i_next >= i_stream_size )
+            MP4_Seek( p_stream, i_next - 1 ); /*  since past seek can fail when hitting EOF */
         MP4_Seek( p_stream, i_next );
         if( vlc_stream_Tell( p_stream ) < i_next - 1 ) /* Truncated box */
         {
@@ -570,16 +653,6 @@ int MP4_ReadBoxContainerChildren( stream_t *p_stream, MP4_Box_t *p_container,
                                                 stoplist, NULL, false );
 }
 
-static void MP4_BoxOffsetUp( MP4_Box_t *p_box, uint64_t i_offset )
-{
-    while(p_box)
-    {
-        p_box->i_pos += i_offset;
-        MP4_BoxOffsetUp( p_box->p_first, i_offset );
-        p_box = p_box->p_next;
-    }
-}
-
 /* Reads within an already read/in memory box (containers without having to seek) */
 static int MP4_ReadBoxContainerRawInBox( stream_t *p_stream, MP4_Box_t *p_container,
                                          uint8_t *p_buffer, uint64_t i_size, uint64_t i_offset )
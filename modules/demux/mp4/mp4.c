@@ -100,6 +100,8 @@ static int   DemuxRef( demux_t *p_demux ){ (void)p_demux; return 0;}
 static int   DemuxFrag( demux_t * );
 static int   Control ( demux_t *, int, va_list );
 
+#define MP4_MOOF_CACHE_SIZE 4
+
 typedef struct
 {
     MP4_Box_t    *p_root;      /* container for the whole file */
@@ -135,6 +137,13 @@ typedef struct
         uint32_t        i_lastseqnumber;
     } context;
 
+    /* recently demuxed moof, reused when seeking back to them */
+    struct
+    {
+        MP4_Box_t      *p_moofs[MP4_MOOF_CACHE_SIZE];
+        unsigned        i_next;
+    } moofcache;
+
     /* */
     bool seekpoint_changed;
     int          i_seekpoint;
@@ -159,6 +168,7 @@ typedef struct
     } hacks;
 
     mp4_fragments_index_t *p_fragsindex;
+    mp4_fragments_index_t *p_sidxindex; /* from the first global sidx */
 
     ssize_t i_attachments;
     input_attachment_t **pp_attachments;
@@ -469,33 +479,6 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-static int MP4_ChunkAllocEntries( size_t entries, uint32_t *smallbuf,
-                                  uint32_t **dst0, uint32_t **dst1 )
-{
-    uint32_t *buf;
-
-    if( entries > MP4_CHUNK_SMALLBUF_ENTRIES )
-    {
-        buf = calloc( entries, sizeof( buf[0] ) * 2 );
-        if( unlikely(buf == NULL) )
-            return VLC_ENOMEM;
-    }
-    else buf = smallbuf;
-
-    *dst0 = buf;
-    *dst1 = &buf[entries];
-
-    return VLC_SUCCESS;
-}
-
-static void MP4_ChunkDestroy( mp4_chunk_t *ck )
-{
-    if( ck->p_sample_count_dts != ck->small_dts_buf )
-        free( ck->p_sample_count_dts );
-    if( ck->p_sample_count_pts != ck->small_pts_buf )
-        free( ck->p_sample_count_pts );
-}
-
 static stime_t MP4_MapTrackTimeIntoTimeline( const mp4_track_t *p_track,
                                              uint32_t i_movie_timescale,
                                              stime_t i_time )
@@ -542,42 +525,56 @@ static stime_t MP4_MapMediaTimelineToTrackTime( const mp4_track_t *p_track,
     return i_time;
 }
 
-static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
+static stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *p_track,
+                                      const mp4_chunk_t *p_chunk,
                                       uint32_t i_sample )
 {
-    uint32_t i_index = 0;
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
     stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    if( stts == NULL )
+        return sdts;
+
+    uint32_t i_index = p_chunk->dts.i_index;
+    uint32_t i_skip = p_chunk->dts.i_skip;
+    while( i_sample > 0 && i_index < stts->i_entry_count )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        const uint32_t i_count = stts->pi_sample_count[i_index] - i_skip;
+        if( i_sample > i_count )
         {
-            sdts += (stime_t)p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
+            sdts += (stime_t)i_count * stts->pi_sample_delta[i_index++];
+            i_sample -= i_count;
+            i_skip = 0;
         }
         else
         {
-            sdts += (stime_t)i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += (stime_t)i_sample * stts->pi_sample_delta[i_index];
             break;
         }
     }
     return sdts;
 }
 
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
+static bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                        const mp4_chunk_t *p_chunk,
                                         uint32_t i_sample, stime_t *pi_delta )
 {
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
+    if( ctts == NULL )
+        return false;
+
+    uint32_t i_skip = p_chunk->pts.i_skip;
+    for( uint32_t i_index = p_chunk->pts.i_index;
+         i_index < ctts->i_entry_count; i_index++ )
     {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
+        const uint32_t i_count = ctts->pi_sample_count[i_index] - i_skip;
+        if( i_sample < i_count )
         {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
+            stime_t i_delta = ctts->pi_sample_offset[i_index] + p_track->i_cts_shift;
+            *pi_delta = __MAX(i_delta, 0); /* should not be negative */
+            return true;
         }
+        i_sample -= i_count;
+        i_skip = 0;
     }
     return false;
 }
@@ -618,44 +615,50 @@ static vlc_tick_t MP4_TrackGetDTSPTS( demux_t *p_demux, const mp4_track_t *p_tra
     return i_dts;
 }
 
-static stime_t MP4_GetChunkSamplesDuration( const mp4_chunk_t *p_chunk,
+static stime_t MP4_GetChunkSamplesDuration( const mp4_track_t *p_track,
+                                            const mp4_chunk_t *p_chunk,
                                             uint32_t i_start_sample,
                                             uint32_t i_nb_samples )
 {
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
     stime_t i_duration = 0;
+    if( stts == NULL )
+        return 0;
 
     /* Forward to right index, and set remaining count in that index */
-    uint32_t i_index = 0;
-    uint32_t i_remain = 0;
+    uint32_t i_index = p_chunk->dts.i_index;
+    uint32_t i_remain = p_chunk->dts.i_skip;
     for( uint32_t i = p_chunk->i_sample_first;
-         i<i_start_sample && i_index < p_chunk->i_entries_dts; )
+         i<i_start_sample && i_index < stts->i_entry_count; )
     {
-        if( i_start_sample - i >= p_chunk->p_sample_count_dts[i_index] )
+        const uint32_t i_count = stts->pi_sample_count[i_index] - i_remain;
+        if( i_start_sample - i >= i_count )
         {
-            i += p_chunk->p_sample_count_dts[i_index];
+            i += i_count;
             i_index++;
+            i_remain = 0;
         }
         else
         {
-            i_remain = i_start_sample - i;
+            i_remain += i_start_sample - i;
             break;
         }
     }
 
     /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_nb_samples > 0 && i_index < stts->i_entry_count )
     {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
+        const uint32_t i_count = stts->pi_sample_count[i_index] - i_remain;
+        if( i_nb_samples >= i_count )
         {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
+            i_duration += (stime_t)i_count * stts->pi_sample_delta[i_index];
+            i_nb_samples -= i_count;
             i_index++;
             i_remain = 0;
         }
         else
         {
-            i_duration += (stime_t)i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
+            i_duration += (stime_t)i_nb_samples * stts->pi_sample_delta[i_index];
             break;
         }
     }
@@ -666,7 +669,8 @@ static stime_t MP4_GetChunkSamplesDuration( const mp4_chunk_t *p_chunk,
 static inline vlc_tick_t MP4_GetSamplesDuration( const mp4_track_t *p_track,
                                                  uint32_t i_nb_samples )
 {
-    stime_t i_duration = MP4_GetChunkSamplesDuration( &p_track->chunk[p_track->i_chunk],
+    stime_t i_duration = MP4_GetChunkSamplesDuration( p_track,
+                                                      &p_track->chunk[p_track->i_chunk],
                                                       p_track->i_sample,
                                                       i_nb_samples );
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
@@ -1942,6 +1946,38 @@ static uint32_t FragGetMoofSequenceNumber( MP4_Box_t *p_moof )
     return 0;
 }
 
+/* Returns the moof at the current position if it was recently demuxed,
+ * within a virtual root as MP4_BoxGetNextChunk() does, and skips it */
+static MP4_Box_t * FragGetCachedChunk( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+
+    for( unsigned i = 0; i < MP4_MOOF_CACHE_SIZE; i++ )
+    {
+        MP4_Box_t *p_moof = p_sys->moofcache.p_moofs[i];
+        if( !p_moof || p_moof->i_pos != i_pos )
+            continue;
+
+        MP4_Box_t *p_vroot = MP4_BoxNew( ATOM_root );
+        if( !p_vroot ||
+            vlc_stream_Seek( p_demux->s, p_moof->i_pos + p_moof->i_size ) != VLC_SUCCESS )
+        {
+            MP4_BoxFree( p_vroot );
+            return NULL;
+        }
+
+        p_sys->moofcache.p_moofs[i] = NULL;
+        p_vroot->i_shortsize = 1;
+        p_vroot->i_size = p_moof->i_size;
+        p_vroot->p_first = p_vroot->p_last = p_moof;
+        p_moof->p_father = p_vroot;
+        return p_vroot;
+    }
+
+    return NULL;
+}
+
 static int FragSeekLoadFragment( demux_t *p_demux, uint32_t i_moox, stime_t i_moox_time )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -1960,7 +1996,9 @@ static int FragSeekLoadFragment( demux_t *p_demux, uint32_t i_moox, stime_t i_mo
         if( ATOM_moof != VLC_FOURCC( p_peek[4], p_peek[5], p_peek[6], p_peek[7] ) )
             return VLC_EGENERIC;
 
-        MP4_Box_t *p_vroot = MP4_BoxGetNextChunk( p_demux->s );
+        MP4_Box_t *p_vroot = FragGetCachedChunk( p_demux );
+        if( !p_vroot )
+            p_vroot = MP4_BoxGetNextChunk( p_demux->s );
         if(!p_vroot)
             return VLC_EGENERIC;
         p_moox = MP4_BoxExtract( &p_vroot->p_first, ATOM_moof );
@@ -2440,6 +2478,10 @@ static void Close ( vlc_object_t * p_this )
         vlc_meta_Delete( p_sys->p_meta );
 
     MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+    MP4_Fragments_Index_Delete( p_sys->p_sidxindex );
+
+    for( unsigned i = 0; i < MP4_MOOF_CACHE_SIZE; i++ )
+        MP4_BoxFree( p_sys->moofcache.p_moofs[i] );
 
     for( i_track = 0; i_track < p_sys->i_tracks; i_track++ )
         MP4_TrackClean( p_demux->out, &p_sys->track[i_track] );
@@ -2639,14 +2681,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
 
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
-
-        ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2708,54 +2742,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EINVAL;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2793,18 +2779,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, read from the box */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2818,13 +2795,10 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
 
     /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     * The table is not expanded, so that memory does not grow with the
+     * number of samples: each chunk only stores its first dts and where
+     * its first sample is in the stts and ctts entries. The boxes are
+     * then walked from there on demand. */
 
     int64_t i_next_dts = 0;
     /* Find stts
@@ -2838,100 +2812,44 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
+        p_demux_track->p_stts = stts;
+
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
+            uint32_t i_sample_count = ck->i_sample_count;
 
             /* save first dts */
             ck->i_first_dts = i_next_dts;
+            ck->dts.i_index = i_index;
+            ck->dts.i_skip = i_skip;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocEntries( ck->i_entries_dts,
-                                           ck->small_dts_buf,
-                                           &ck->p_sample_count_dts,
-                                           &ck->p_sample_delta_dts );
-            if( i_ret )
+            while( i_sample_count > 0 && i_index < stts->i_entry_count )
             {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                uint32_t i_count = __MIN( stts->pi_sample_count[i_index] - i_skip,
+                                          i_sample_count );
+                i_next_dts += (int64_t)i_count * stts->pi_sample_delta[i_index];
+                i_sample_count -= i_count;
+                i_skip += i_count;
+                if( i_skip == stts->pi_sample_count[i_index] )
                 {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_skip = 0;
                 }
-
             }
+
+            if( i_sample_count > 0 )
+                msg_Err( p_demux, "invalid index counting total samples, "
+                         "%"PRIu32" missing in chunk %"PRIu32, i_sample_count, i_chunk );
+
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
     }
 
@@ -2942,7 +2860,7 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
@@ -2961,88 +2879,31 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
             }
         }
         p_demux_track->i_cts_shift = i_cts_shift;
+        p_demux_track->p_ctts = ctts;
 
-        /* Create pts-dts table per chunk */
+        /* Locate pts-dts entries per chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* allocate them */
-            i_ret = MP4_ChunkAllocEntries( ck->i_entries_pts,
-                                           ck->small_pts_buf,
-                                           &ck->p_sample_count_pts,
-                                           &ck->p_sample_offset_pts );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->pts.i_index = i_index;
+            ck->pts.i_skip = i_skip;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
+            while( i_sample_count > 0 && i_index < ctts->i_entry_count )
             {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
+                uint32_t i_count = __MIN( ctts->pi_sample_count[i_index] - i_skip,
+                                          i_sample_count );
+                i_sample_count -= i_count;
+                i_skip += i_count;
+                if( i_skip == ctts->pi_sample_count[i_index] )
                 {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_skip = 0;
                 }
-
-
             }
         }
     }
@@ -3436,24 +3297,29 @@ static int STTSToSampleChunk(const mp4_track_t *p_track, uint64_t i_dts,
     }
 
     /* *** find sample in the chunk *** */
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    const uint32_t i_chunk_end = ck->i_sample_first + ck->i_sample_count;
     uint32_t i_sample = ck->i_sample_first;
     uint64_t i_entrydts = ck->i_first_dts;
+    uint32_t i_skip = ck->dts.i_skip;
 
-    for( uint_fast32_t i = 0;
-         i < ck->i_entries_dts && i_sample < ck->i_sample_count;
+    for( uint_fast32_t i = ck->dts.i_index;
+         stts && i < stts->i_entry_count && i_sample < i_chunk_end;
          i++ )
     {
-        uint64_t i_entry_duration = ck->p_sample_count_dts[i] * (uint64_t)
-                                    ck->p_sample_delta_dts[i];
+        const uint32_t i_count = __MIN( stts->pi_sample_count[i] - i_skip,
+                                        i_chunk_end - i_sample );
+        uint64_t i_entry_duration = i_count * (uint64_t) stts->pi_sample_delta[i];
+        i_skip = 0;
         if( i_entrydts + i_entry_duration < i_dts )
         {
             i_entrydts += i_entry_duration;
-            i_sample += ck->p_sample_count_dts[i];
+            i_sample += i_count;
         }
         else
         {
-            if( ck->p_sample_delta_dts[i] > 0 )
-                i_sample += ( i_dts - i_entrydts ) / ck->p_sample_delta_dts[i];
+            if( stts->pi_sample_delta[i] > 0 )
+                i_sample += ( i_dts - i_entrydts ) / stts->pi_sample_delta[i];
             break;
         }
     }
@@ -3697,7 +3563,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
 
     /* Probe the 16 first B frames */
     uint32_t i_chunk = p_track->i_chunk;
-    if( !p_track->chunk[i_chunk].i_entries_pts )
+    if( !p_track->p_ctts )
         return;
 
     stime_t lowest = p_track->i_start_dts;
@@ -3720,9 +3586,11 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             break;
         assert(i_nextsample >= ck->i_sample_first);
         stime_t pts;
-        stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+        stime_t dts = pts = MP4_ChunkGetSampleDTS( p_track, ck,
+                                                   i_nextsample - ck->i_sample_first );
         stime_t delta = UNKNOWN_DELTA;
-        if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+        if( MP4_ChunkGetSampleCTSDelta( p_track, ck,
+                                        i_nextsample - ck->i_sample_first, &delta ) )
             pts += delta;
         if( pts < lowest )
         {
@@ -3738,9 +3606,9 @@ static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
     if( i_chunk_sample > p_chunk->i_sample_count && p_chunk->i_sample_count )
         i_chunk_sample = p_chunk->i_sample_count - 1;
-    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
+    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -4037,16 +3905,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            MP4_ChunkDestroy( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
@@ -4900,7 +4760,13 @@ static void FragResetContext( demux_sys_t *p_sys )
     if( p_sys->context.p_fragment_atom )
     {
         if( p_sys->context.p_fragment_atom != p_sys->p_moov )
-            MP4_BoxFree( p_sys->context.p_fragment_atom );
+        {
+            /* keep it for seeks back, evicting the oldest one */
+            MP4_Box_t **pp_slot = &p_sys->moofcache.p_moofs[p_sys->moofcache.i_next];
+            MP4_BoxFree( *pp_slot );
+            *pp_slot = p_sys->context.p_fragment_atom;
+            p_sys->moofcache.i_next = (p_sys->moofcache.i_next + 1) % MP4_MOOF_CACHE_SIZE;
+        }
         p_sys->context.p_fragment_atom = NULL;
     }
     p_sys->context.i_current_box_type = 0;
@@ -5354,40 +5220,85 @@ static int FragCreateTrunIndex( demux_t *p_demux, MP4_Box_t *p_moof,
     return VLC_SUCCESS;
 }
 
+static mp4_fragments_index_t * FragCreateSidxIndex( const MP4_Box_t *p_sidx )
+{
+    const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
+
+    unsigned i_entries = 0;
+    for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+    {
+        if( p_data->p_items[i].b_reference_type == 0 )
+            i_entries++;
+    }
+
+    mp4_fragments_index_t *p_index = MP4_Fragments_Index_New( 1, i_entries );
+    if( !p_index )
+        return NULL;
+
+    /* sidx refers to offsets from end of sidx pos in the file + first offset */
+    uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
+    stime_t i_time = 0;
+    unsigned i_entry = 0;
+    for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+    {
+        if(p_data->p_items[i].b_reference_type != 0)
+            continue;
+        p_index->pi_pos[i_entry] = i_pos;
+        p_index->p_times[i_entry++] = i_time; /* sidx scaled */
+        i_pos += p_data->p_items[i].i_referenced_size;
+        i_time += p_data->p_items[i].i_subsegment_duration;
+    }
+    p_index->i_last_time = i_time;
+
+    return p_index;
+}
+
+/* Only the first global sidx is indexed: for fragmented files,
+ * MP4_BoxGetRoot() stops reading at it, and the following ones are only
+ * reached through the fragments they index. Times past the subsegments it
+ * references are left to the other lookups. */
 static int FragGetMoofBySidxIndex( demux_t *p_demux, vlc_tick_t target_time,
                                    uint64_t *pi_moof_pos, vlc_tick_t *pi_sampletime )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
     const MP4_Box_t *p_sidx = MP4_BoxGet( p_sys->p_root, "sidx" );
-    for( ; p_sidx ; p_sidx = p_sidx->p_next )
+    if( !p_sidx )
+        return VLC_EGENERIC;
+
+    const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
+    if( !p_data || !p_data->i_timescale )
+        return VLC_EGENERIC;
+
+    /* built once, then looked up in log time */
+    if( !p_sys->p_sidxindex )
     {
-        if( p_sidx->i_type != ATOM_sidx )
-            continue;
+        p_sys->p_sidxindex = FragCreateSidxIndex( p_sidx );
+        if( !p_sys->p_sidxindex )
+            return VLC_EGENERIC;
+    }
 
-        const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
-        if( !p_data || !p_data->i_timescale )
-            break;
+    stime_t i_time = MP4_rescale_qtime( target_time, p_data->i_timescale );
+    if( i_time < 0 || i_time >= p_sys->p_sidxindex->i_last_time )
+        return VLC_EGENERIC; /* past the indexed range */
+    if( !MP4_Fragments_Index_Lookup( p_sys->p_sidxindex, &i_time, pi_moof_pos, 0 ) )
+        return VLC_EGENERIC;
 
-        stime_t i_target_time = MP4_rescale_qtime( target_time, p_data->i_timescale );
+    *pi_sampletime = MP4_rescale_mtime( i_time, p_data->i_timescale );
+    return VLC_SUCCESS;
+}
 
-        /* sidx refers to offsets from end of sidx pos in the file + first offset */
-        uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
-        stime_t i_time = 0;
-        for( uint16_t i=0; i<p_data->i_reference_count; i++ )
-        {
-            if(p_data->p_items[i].b_reference_type != 0)
-                continue;
-            if( i_time + p_data->p_items[i].i_subsegment_duration > i_target_time )
-            {
-                *pi_sampletime = MP4_rescale_mtime( i_time, p_data->i_timescale );
-                *pi_moof_pos = i_pos;
-                return VLC_SUCCESS;
-            }
-            i_pos += p_data->p_items[i].i_referenced_size;
-            i_time += p_data->p_items[i].i_subsegment_duration;
-        }
-    }
-    return VLC_EGENERIC;
+static stime_t FragGetTfraTime( const MP4_Box_data_tfra_t *p_data, uint32_t i )
+{
+    if ( p_data->i_version == 1 )
+        return *((uint64_t *)(p_data->p_time + i * 2));
+    return p_data->p_time[i];
+}
+
+static uint64_t FragGetTfraMoofOffset( const MP4_Box_data_tfra_t *p_data, uint32_t i )
+{
+    if ( p_data->i_version == 1 )
+        return *((uint64_t *)(p_data->p_moof_offset + i * 2));
+    return p_data->p_moof_offset[i];
 }
 
 static int FragGetMoofByTfraIndex( demux_t *p_demux, const vlc_tick_t i_target_time, unsigned i_track_ID,
@@ -5403,39 +5314,30 @@ static int FragGetMoofByTfraIndex( demux_t *p_demux, const vlc_tick_t i_target_t
             if( !p_data || p_data->i_track_ID != i_track_ID )
                 continue;
 
-            uint64_t i_pos = 0;
             mp4_track_t *p_track = MP4_GetTrackByTrackID( p_demux, p_data->i_track_ID );
-            if ( p_track )
+            if ( !p_track )
+                continue;
+
+            /* first entry at or after the target, entries are time ordered */
+            stime_t i_track_target_time = MP4_rescale_qtime( i_target_time, p_track->i_timescale );
+            uint32_t i_low = 0, i_high = p_data->i_number_of_entries;
+            while( i_low < i_high )
             {
-                stime_t i_track_target_time = MP4_rescale_qtime( i_target_time, p_track->i_timescale );
-                for ( uint32_t i = 0; i<p_data->i_number_of_entries; i += ( p_data->i_version == 1 ) ? 2 : 1 )
-                {
-                    stime_t i_time;
-                    uint64_t i_offset;
-                    if ( p_data->i_version == 1 )
-                    {
-                        i_time = *((uint64_t *)(p_data->p_time + i));
-                        i_offset = *((uint64_t *)(p_data->p_moof_offset + i));
-                    }
-                    else
-                    {
-                        i_time = p_data->p_time[i];
-                        i_offset = p_data->p_moof_offset[i];
-                    }
+                uint32_t i_mid = i_low + (i_high - i_low) / 2;
+                if( FragGetTfraTime( p_data, i_mid ) >= i_track_target_time )
+                    i_high = i_mid;
+                else
+                    i_low = i_mid + 1;
+            }
 
-                    if ( i_time >= i_track_target_time )
-                    {
-                        if ( i_pos == 0 ) /* Not in this traf */
-                            break;
+            /* Not in this traf */
+            if( i_low == 0 || i_low == p_data->i_number_of_entries )
+                continue;
 
-                        *pi_moof_pos = i_pos;
-                        *pi_sampletime = MP4_rescale_mtime( i_time, p_track->i_timescale );
-                        return VLC_SUCCESS;
-                    }
-                    else
-                        i_pos = i_offset;
-                }
-            }
+            *pi_moof_pos = FragGetTfraMoofOffset( p_data, i_low - 1 );
+            *pi_sampletime = MP4_rescale_mtime( FragGetTfraTime( p_data, i_low ),
+                                                p_track->i_timescale );
+            return VLC_SUCCESS;
         }
     }
     return VLC_EGENERIC;
@@ -5553,7 +5455,11 @@ static int DemuxFrag( demux_t *p_demux )
         }
         else
         {
-            MP4_Box_t *p_vroot = MP4_BoxGetNextChunk( p_demux->s );
+            MP4_Box_t *p_vroot = NULL;
+            if( p_sys->context.i_current_box_type == ATOM_moof )
+                p_vroot = FragGetCachedChunk( p_demux );
+            if( !p_vroot )
+                p_vroot = MP4_BoxGetNextChunk( p_demux->s );
             if(!p_vroot)
             {
                 i_status = VLC_DEMUXER_EOF;
@@ -30,7 +30,12 @@
 #include "fragments.h"
 #include "../asf/asfpacket.h"
 
-#define MP4_CHUNK_SMALLBUF_ENTRIES 2
+/* Position of the first sample of a chunk in a stts or ctts table */
+typedef struct
+{
+    uint32_t     i_index; /* table entry */
+    uint32_t     i_skip;  /* samples of that entry used by previous chunks */
+} mp4_table_pos_t;
 
 /* Contain all information about a chunk */
 typedef struct
@@ -48,18 +53,9 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-    uint32_t     small_dts_buf[MP4_CHUNK_SMALLBUF_ENTRIES * 2];
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    uint32_t     *p_sample_offset_pts;  /* pts-dts */
-    uint32_t     small_pts_buf[MP4_CHUNK_SMALLBUF_ENTRIES * 2];
-
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
+    /* the tables are decoded from there on demand, never expanded */
+    mp4_table_pos_t dts;
+    mp4_table_pos_t pts;
 
 } mp4_chunk_t;
 
@@ -151,8 +147,11 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* stsz/stz2 entries, owned by the box */
+
+    /* sample -> dts and dts -> pts tables, owned by the boxes */
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts; /* could be NULL */
 
     const MP4_Box_t *p_track;
     const MP4_Box_t *p_stbl;  /* will contain all timing information */
@@ -46,6 +46,8 @@
 #include "ts_hotfixes.h"
 #include "ts_sl.h"
 #include "ts_metadata.h"
+#include "ts_output.h"
+#include "ts_seekindex.h"
 #include "sections.h"
 #include "pes.h"
 #include "timestamps.h"
@@ -123,6 +125,15 @@ static void Close ( vlc_object_t * );
 #define TS_OFFSETFIX_TEXT   "Try to fix too early PCR (or late DTS)"
 #define TS_GENERATED_PCR_OFFSET_TEXT "Offset in ms for generated PCR"
 
+#define OUTPUT_THREAD_TEXT N_("Output from a separate thread")
+#define OUTPUT_THREAD_LONGTEXT N_("Hand the demuxed data over to the decoders " \
+    "or stream output from a dedicated thread, so reading and reassembly of " \
+    "large multiplexes is not slowed down by the output.")
+
+#define SEEK_INDEX_TEXT N_("Keep the seek index of played files")
+#define SEEK_INDEX_LONGTEXT N_("Store the positions found while playing " \
+    "seekable files, and reuse them for seeking the next time the file is opened.")
+
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
@@ -163,6 +174,8 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL )
+    add_bool( "ts-output-thread", false, OUTPUT_THREAD_TEXT, OUTPUT_THREAD_LONGTEXT )
+    add_bool( "ts-seek-index-cache", true, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
 
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
@@ -194,9 +207,11 @@ static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static void SkipDroppedTSPackets( demux_t *p_demux );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
-static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
+static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t, bool );
+static void SeekIndexAdd( demux_t *p_demux, ts_pmt_t *, stime_t, bool );
 static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
 
 #define TS_PACKET_SIZE_188 188
@@ -205,6 +220,14 @@ static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
 #define TS_PACKET_SIZE_MAX 204
 #define TS_HEADER_SIZE 4
 
+/* how many packets are looked at for bulk skipping */
+#define SKIP_PACKETS_COUNT 64
+
+/* largest gap between two seek points still considered played continuously */
+#define SEEK_INDEX_MAX_GAP  TO_SCALE_NZ(VLC_TICK_FROM_SEC(2))
+/* how far before the target an indexed random access point is still used */
+#define SEEK_INDEX_MAX_RAI_DISTANCE TO_SCALE_NZ(VLC_TICK_FROM_SEC(5))
+
 #define PROBE_CHUNK_COUNT 500
 #define PROBE_MAX         (PROBE_CHUNK_COUNT * 10)
 
@@ -537,11 +560,23 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    p_sys->p_seekindex = ts_seekindex_New( p_demux );
+
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
     else
         p_sys->es_creation = CREATE_ES;
 
+    if( !p_demux->b_preparsing && var_InheritBool( p_demux, "ts-output-thread" ) )
+    {
+        p_sys->p_output = ts_output_New( p_this, p_demux->out );
+        if( p_sys->p_output )
+        {
+            p_sys->p_out = p_demux->out;
+            p_demux->out = p_sys->p_output;
+        }
+    }
+
     /* Preparse time */
     if( p_demux->b_preparsing && p_sys->b_canseek )
     {
@@ -567,6 +602,9 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( p_sys->p_seekindex )
+        ts_seekindex_Delete( p_demux, p_sys->p_seekindex, GetPID(p_sys, 0)->u.p_pat );
+
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -597,6 +635,12 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    if( p_sys->p_output )
+    {
+        ts_output_Delete( p_sys->p_output );
+        p_demux->out = p_sys->p_out;
+    }
+
     free( p_sys->record_dir_path );
     free( p_sys );
 }
@@ -646,8 +690,14 @@ static int Demux( demux_t *p_demux )
         bool         b_frame = false;
         int          i_header = 0;
         block_t     *p_pkt;
+
+        SkipDroppedTSPackets( p_demux );
+
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
+            /* EOF is only reached once everything has been output */
+            if( p_sys->p_output )
+                ts_output_Drain( p_sys->p_output );
             return VLC_DEMUXER_EOF;
         }
 
@@ -699,8 +749,8 @@ static int Demux( demux_t *p_demux )
 
         /* Adaptation field cannot be scrambled */
         stime_t i_pcr = GetPCR( p_pkt );
-        if( i_pcr >= 0 )
-            PCRHandle( p_demux, p_pid, i_pcr );
+        if( i_pcr >= 0 ) /* then the adaptation field flags are present */
+            PCRHandle( p_demux, p_pid, i_pcr, p_pkt->p_buffer[5] & 0x40 );
 
         /* Probe streams to build PAT/PMT after MIN_PAT_INTERVAL in case we don't see any PAT */
         if( !SEEN( GetPID( p_sys, 0 ) ) &&
@@ -903,6 +953,29 @@ void UpdatePESFilters( demux_t *p_demux, bool b_all )
     }
 }
 
+/* Queries after which the input flushes or reconfigures the es_out */
+static bool ControlChangesState( int i_query )
+{
+    switch( i_query )
+    {
+    case DEMUX_SET_POSITION:
+    case DEMUX_SET_TIME:
+    case DEMUX_SET_GROUP_DEFAULT:
+    case DEMUX_SET_GROUP_ALL:
+    case DEMUX_SET_GROUP_LIST:
+    case DEMUX_SET_ES:
+    case DEMUX_SET_ES_LIST:
+    case DEMUX_SET_TITLE:
+    case DEMUX_SET_SEEKPOINT:
+    case DEMUX_SET_PAUSE_STATE:
+    case DEMUX_SET_NEXT_DEMUX_TIME:
+    case DEMUX_SET_RECORD_STATE:
+        return true;
+    default:
+        return false;
+    }
+}
+
 static int Control( demux_t *p_demux, int i_query, va_list args )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -919,6 +992,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
     }
 
+    /* The input flushes the es_out itself after seeks and selection
+     * changes, nothing queued from before must come after it */
+    if( p_sys->p_output && ControlChangesState( i_query ) )
+        ts_output_Drain( p_sys->p_output );
+
     switch( i_query )
     {
     case DEMUX_CAN_SEEK:
@@ -1882,6 +1960,62 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     return p_pkt;
 }
 
+/* Skips in one read the upcoming packets the demux loop would drop
+ * without doing anything: null packets and unselected ES packets not
+ * carrying a PCR or a scrambling change. Only headers of the peeked
+ * data are looked at, so nothing is allocated nor copied for them. */
+static void SkipDroppedTSPackets( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const uint8_t *p_peek;
+
+    if( p_sys->b_access_control || p_sys->es_creation == DELAY_ES ||
+        !SEEN( GetPID( p_sys, 0 ) ) )
+        return;
+
+    const size_t i_packet_size = p_sys->i_packet_size;
+    ssize_t i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
+                                      i_packet_size * SKIP_PACKETS_COUNT );
+    if( i_peek < (ssize_t) i_packet_size )
+        return;
+
+    size_t i_skip = 0;
+    for( ; i_skip + i_packet_size <= (size_t) i_peek; i_skip += i_packet_size )
+    {
+        const uint8_t *p = &p_peek[i_skip + p_sys->i_packet_header_size];
+
+        /* Lost sync and errors are left to the regular path */
+        if( p[0] != 0x47 || (p[1] & 0x80) )
+            break;
+
+        const uint16_t i_pid = ( (p[1] & 0x1f) << 8 ) | p[2];
+        if( i_pid == 0x1FFF )
+            continue;
+
+        ts_pid_t *p_pid = GetPID( p_sys, i_pid );
+        if( !SEEN(p_pid) || p_pid->type != TYPE_STREAM ||
+            (p_pid->i_flags & FLAG_FILTERED) )
+            break;
+
+        if( (p[3] & 0x20) && p[4] > 0 && (p[5] & 0x10) )
+            break;
+
+        if( !SCRAMBLED(*p_pid) != !(p[3] & 0xc0) && (p[1] & 0x40) )
+            break;
+
+        /* Keep continuity in case the ES gets selected */
+        if( (p[3] & 0x10) && p_sys->b_cc_check )
+        {
+            p_pid->i_cc = p[3] & 0x0f;
+            p_pid->i_dup = 0;
+        }
+    }
+
+    if( i_skip > 0 &&
+        vlc_stream_Read( p_sys->stream, NULL, i_skip ) != (ssize_t) i_skip )
+        msg_Warn( p_demux, "could not skip %zu dropped bytes", i_skip );
+}
+
 static stime_t GetPCR( const block_t *p_pkt )
 {
     const uint8_t *p = p_pkt->p_buffer;
@@ -2004,6 +2138,25 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
     }
 }
 
+/*****************************************************************************
+ * Seek index: records the position of the program PCR packets
+ * while playing, and keeps them for the next playbacks of the file,
+ * so seeking into already played parts does not search the file again.
+ *****************************************************************************/
+static void SeekIndexAdd( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr, bool b_rai )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_canseek || p_sys->b_access_control )
+        return;
+
+    const uint64_t i_pos = vlc_stream_Tell( p_sys->stream ) - p_sys->i_packet_size;
+    i_pcr = TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr );
+
+    ts_seekindex_Merge( p_sys->p_seekindex, p_pmt );
+    ts_seekindex_Insert( p_pmt, i_pcr, i_pos, b_rai );
+}
+
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaledtime )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -2012,15 +2165,34 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
         return vlc_stream_Seek( p_sys->stream, 0 );
 
+    /* Already played through, go straight to the previous PCR */
+    const ts_seek_point_t *p_prev, *p_next;
+    ts_seekindex_Lookup( p_pmt, i_scaledtime, &p_prev, &p_next );
+    if( p_prev && p_next && p_next->i_pcr - p_prev->i_pcr <= SEEK_INDEX_MAX_GAP )
+    {
+        /* Rather start decoding from a random access point */
+        const ts_seek_point_t *p_rai =
+            ts_seekindex_LookupRAI( p_pmt, p_prev, SEEK_INDEX_MAX_GAP,
+                                    SEEK_INDEX_MAX_RAI_DISTANCE );
+        if( p_rai )
+            p_prev = p_rai;
+        msg_Dbg( p_demux, "seeking to indexed %sposition %"PRIu64,
+                 p_prev->b_rai ? "random access " : "", p_prev->i_pos );
+        return vlc_stream_Seek( p_sys->stream, p_prev->i_pos );
+    }
+
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
     const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
 
-    /* Find the time position by using binary search algorithm. */
-    uint64_t i_head_pos = 0;
+    /* Find the time position by using binary search algorithm,
+     * within the closest known positions */
+    uint64_t i_head_pos = p_prev ? p_prev->i_pos : 0;
     uint64_t i_tail_pos = (uint64_t) i_stream_size - p_sys->i_packet_size;
+    if( p_next && p_next->i_pos < i_tail_pos )
+        i_tail_pos = p_next->i_pos;
     if( i_head_pos >= i_tail_pos )
         return VLC_EGENERIC;
 
@@ -2430,7 +2602,7 @@ static void PCRCheckDTS( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr)
     }
 }
 
-static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
+static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr, bool b_rai )
 {
     demux_sys_t   *p_sys = p_demux->p_sys;
 
@@ -2457,6 +2629,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
             {
                 /* ? update PCR for the whole group program ? */
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                SeekIndexAdd( p_demux, p_pmt, i_pcr, b_rai );
             }
         }
         else /* set PCR provided by current pid to program(s) referencing it */
@@ -2467,6 +2640,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                SeekIndexAdd( p_demux, p_pmt, i_pcr, b_rai );
             }
         }
 
@@ -72,6 +72,13 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* output worker wrapping the demuxer es_out, if enabled */
+    es_out_t   *p_output;
+    es_out_t   *p_out;
+
+    /* PCR positions kept across playbacks, if enabled */
+    struct ts_seekindex_t *p_seekindex;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
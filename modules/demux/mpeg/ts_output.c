@@ -0,0 +1,246 @@
+/*****************************************************************************
+ * ts_output.c: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_es_out.h>
+#include <vlc_block.h>
+#include <vlc_threads.h>
+
+#include "ts_output.h"
+
+#include <assert.h>
+
+/* Past this amount of queued data, the demuxer waits for the worker */
+#define TS_OUTPUT_MAX_PENDING (16 * 1024 * 1024)
+
+typedef struct ts_output_job_t ts_output_job_t;
+
+struct ts_output_job_t
+{
+    ts_output_job_t *p_next;
+    es_out_id_t *id; /* NULL for a group PCR */
+    block_t *p_block;
+    int i_group;
+    vlc_tick_t i_pcr;
+};
+
+typedef struct
+{
+    es_out_t out;
+    es_out_t *p_out;
+
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_cond_t done;
+
+    ts_output_job_t *p_first;
+    ts_output_job_t **pp_last;
+    size_t i_pending;
+    bool b_busy;
+    bool b_abort;
+} ts_output_sys_t;
+
+static void *Run( void *data )
+{
+    ts_output_sys_t *p_sys = data;
+
+    vlc_thread_set_name( "vlc-ts-output" );
+
+    vlc_mutex_lock( &p_sys->lock );
+    for( ;; )
+    {
+        while( !p_sys->p_first && !p_sys->b_abort )
+            vlc_cond_wait( &p_sys->wait, &p_sys->lock );
+        if( !p_sys->p_first )
+            break;
+
+        /* Take the whole queue at once, order is kept */
+        ts_output_job_t *p_job = p_sys->p_first;
+        p_sys->p_first = NULL;
+        p_sys->pp_last = &p_sys->p_first;
+        p_sys->b_busy = true;
+        vlc_mutex_unlock( &p_sys->lock );
+
+        size_t i_done = 0;
+        while( p_job )
+        {
+            ts_output_job_t *p_next = p_job->p_next;
+            if( p_job->id )
+            {
+                i_done += p_job->p_block->i_buffer;
+                es_out_Send( p_sys->p_out, p_job->id, p_job->p_block );
+            }
+            else
+            {
+                es_out_Control( p_sys->p_out, ES_OUT_SET_GROUP_PCR,
+                                p_job->i_group, p_job->i_pcr );
+            }
+            free( p_job );
+            p_job = p_next;
+        }
+
+        vlc_mutex_lock( &p_sys->lock );
+        p_sys->b_busy = false;
+        p_sys->i_pending -= i_done;
+        vlc_cond_broadcast( &p_sys->done );
+    }
+    vlc_mutex_unlock( &p_sys->lock );
+
+    return NULL;
+}
+
+static void Drain( ts_output_sys_t *p_sys )
+{
+    vlc_mutex_lock( &p_sys->lock );
+    while( p_sys->p_first || p_sys->b_busy )
+        vlc_cond_wait( &p_sys->done, &p_sys->lock );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static void Queue( ts_output_sys_t *p_sys, ts_output_job_t *p_job )
+{
+    p_job->p_next = NULL;
+
+    vlc_mutex_lock( &p_sys->lock );
+    while( p_sys->i_pending > TS_OUTPUT_MAX_PENDING )
+        vlc_cond_wait( &p_sys->done, &p_sys->lock );
+    if( p_job->id )
+        p_sys->i_pending += p_job->p_block->i_buffer;
+    *p_sys->pp_last = p_job;
+    p_sys->pp_last = &p_job->p_next;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+}
+
+static es_out_id_t *Add( es_out_t *out, input_source_t *in, const es_format_t *fmt )
+{
+    ts_output_sys_t *p_sys = container_of( out, ts_output_sys_t, out );
+    Drain( p_sys );
+    return p_sys->p_out->cbs->add( p_sys->p_out, in, fmt );
+}
+
+static int Send( es_out_t *out, es_out_id_t *id, block_t *p_block )
+{
+    ts_output_sys_t *p_sys = container_of( out, ts_output_sys_t, out );
+
+    ts_output_job_t *p_job = malloc( sizeof(*p_job) );
+    if( unlikely(!p_job) )
+    {
+        block_Release( p_block );
+        return VLC_ENOMEM;
+    }
+    p_job->id = id;
+    p_job->p_block = p_block;
+    Queue( p_sys, p_job );
+
+    return VLC_SUCCESS;
+}
+
+static void Del( es_out_t *out, es_out_id_t *id )
+{
+    ts_output_sys_t *p_sys = container_of( out, ts_output_sys_t, out );
+    Drain( p_sys );
+    p_sys->p_out->cbs->del( p_sys->p_out, id );
+}
+
+static int Control( es_out_t *out, input_source_t *in, int i_query, va_list args )
+{
+    ts_output_sys_t *p_sys = container_of( out, ts_output_sys_t, out );
+
+    if( i_query == ES_OUT_SET_GROUP_PCR )
+    {
+        ts_output_job_t *p_job = malloc( sizeof(*p_job) );
+        if( unlikely(!p_job) )
+            return VLC_ENOMEM;
+        p_job->id = NULL;
+        p_job->i_group = va_arg( args, int );
+        p_job->i_pcr = va_arg( args, vlc_tick_t );
+        Queue( p_sys, p_job );
+        return VLC_SUCCESS;
+    }
+
+    Drain( p_sys );
+    return p_sys->p_out->cbs->control( p_sys->p_out, in, i_query, args );
+}
+
+static void Destroy( es_out_t *out )
+{
+    ts_output_Delete( out );
+}
+
+static const struct es_out_callbacks ts_output_cbs =
+{
+    .add = Add,
+    .send = Send,
+    .del = Del,
+    .control = Control,
+    .destroy = Destroy,
+};
+
+es_out_t * ts_output_New( vlc_object_t *p_obj, es_out_t *p_out )
+{
+    ts_output_sys_t *p_sys = malloc( sizeof(*p_sys) );
+    if( !p_sys )
+        return NULL;
+
+    p_sys->out.cbs = &ts_output_cbs;
+    p_sys->p_out = p_out;
+    vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait );
+    vlc_cond_init( &p_sys->done );
+    p_sys->p_first = NULL;
+    p_sys->pp_last = &p_sys->p_first;
+    p_sys->i_pending = 0;
+    p_sys->b_busy = false;
+    p_sys->b_abort = false;
+
+    if( vlc_clone( &p_sys->thread, Run, p_sys ) )
+    {
+        msg_Err( p_obj, "can't create output thread" );
+        free( p_sys );
+        return NULL;
+    }
+
+    return &p_sys->out;
+}
+
+void ts_output_Drain( es_out_t *out )
+{
+    Drain( container_of( out, ts_output_sys_t, out ) );
+}
+
+void ts_output_Delete( es_out_t *out )
+{
+    ts_output_sys_t *p_sys = container_of( out, ts_output_sys_t, out );
+
+    /* The worker outputs anything still queued before leaving */
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->b_abort = true;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+
+    vlc_join( p_sys->thread, NULL );
+    assert( !p_sys->p_first );
+    free( p_sys );
+}
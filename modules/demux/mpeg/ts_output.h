@@ -0,0 +1,32 @@
+/*****************************************************************************
+ * ts_output.h: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_OUTPUT_H
+#define VLC_TS_OUTPUT_H
+
+/* es_out wrapper moving data output to a worker thread.
+ * Blocks and PCR are queued and replayed in order by the worker,
+ * any other call waits for the queue to be empty then goes through. */
+es_out_t * ts_output_New( vlc_object_t *, es_out_t * );
+void ts_output_Delete( es_out_t * );
+
+/* Waits until all queued blocks and PCR have been output */
+void ts_output_Drain( es_out_t * );
+
+#endif
@@ -0,0 +1,454 @@
+/*****************************************************************************
+ * ts_seekindex.c: Transport Stream persistent seek index
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_block.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+
+#include "timestamps.h"
+
+#include "ts_pid.h"
+#include "ts_streams.h"
+#include "ts_streams_private.h"
+#include "ts.h"
+#include "ts_seekindex.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+/* spacing of the recorded points */
+#define SEEK_INDEX_INTERVAL TO_SCALE_NZ(VLC_TICK_FROM_MS(500))
+
+/* index file: magic, then big endian tables
+ *  programs: count, { number, first pcr, count, { pcr, pos } }
+ * with the top bit of pos set on random access points */
+static const char index_magic[8] = { 'V','L','C','T','S','I','X','1' };
+#define INDEX_POS_RAI      UINT64_C(0x8000000000000000)
+#define INDEX_MAX_SIZE     (4 << 20)
+/* all index files together, the least recently used are removed first */
+#define INDEX_DIR_MAX_SIZE (32 << 20)
+
+struct ts_seekindex_t
+{
+    char    *psz_path;
+    block_t *p_saved;   /* validated content of the index file */
+    size_t   i_saved;   /* number of points in that file */
+};
+
+static size_t FindPoint( const ts_pmt_t *p_pmt, stime_t i_pcr )
+{
+    size_t i_low = 0, i_high = p_pmt->seekpoints.i_size;
+    while( i_low < i_high )
+    {
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_pmt->seekpoints.p_elems[i_mid].i_pcr <= i_pcr )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low; /* first point past that time */
+}
+
+void ts_seekindex_Lookup( const ts_pmt_t *p_pmt, stime_t i_pcr,
+                          const ts_seek_point_t **pp_prev,
+                          const ts_seek_point_t **pp_next )
+{
+    const size_t i = FindPoint( p_pmt, i_pcr );
+
+    *pp_prev = i > 0 ? &p_pmt->seekpoints.p_elems[i - 1] : NULL;
+    *pp_next = i < (size_t)p_pmt->seekpoints.i_size ? &p_pmt->seekpoints.p_elems[i] : NULL;
+}
+
+void ts_seekindex_Insert( ts_pmt_t *p_pmt, stime_t i_pcr, uint64_t i_pos, bool b_rai )
+{
+    const ts_seek_point_t *p_elems = p_pmt->seekpoints.p_elems;
+    const size_t i_count = p_pmt->seekpoints.i_size;
+
+    /* The new point goes between i_prev - 1 and i_next, replacing the
+     * regular points in between */
+    size_t i_prev = FindPoint( p_pmt, i_pcr );
+    size_t i_next = i_prev;
+    if( b_rai )
+    {
+        while( i_prev > 0 && !p_elems[i_prev - 1].b_rai &&
+               i_pcr - p_elems[i_prev - 1].i_pcr < SEEK_INDEX_INTERVAL )
+            i_prev--;
+        while( i_next < i_count && !p_elems[i_next].b_rai &&
+               p_elems[i_next].i_pcr - i_pcr < SEEK_INDEX_INTERVAL )
+            i_next++;
+    }
+
+    const ts_seek_point_t *p_prev = i_prev > 0 ? &p_elems[i_prev - 1] : NULL;
+    const ts_seek_point_t *p_next = i_next < i_count ? &p_elems[i_next] : NULL;
+
+    if( (p_prev && i_pcr - p_prev->i_pcr < SEEK_INDEX_INTERVAL) ||
+        (p_next && p_next->i_pcr - i_pcr < SEEK_INDEX_INTERVAL) )
+        return;
+
+    /* Positions must grow along with time, or PCR went backwards */
+    if( (p_prev && p_prev->i_pos >= i_pos) || (p_next && p_next->i_pos <= i_pos) )
+        return;
+
+    for( ; i_next > i_prev; i_next-- )
+        ARRAY_REMOVE( p_pmt->seekpoints, i_prev );
+
+    ts_seek_point_t point = { .i_pcr = i_pcr, .i_pos = i_pos, .b_rai = b_rai };
+    ARRAY_INSERT( p_pmt->seekpoints, point, i_prev );
+}
+
+const ts_seek_point_t * ts_seekindex_LookupRAI( const ts_pmt_t *p_pmt,
+                                                const ts_seek_point_t *p_point,
+                                                stime_t i_max_gap,
+                                                stime_t i_max_distance )
+{
+    const ts_seek_point_t *p_first = p_pmt->seekpoints.p_elems;
+
+    const ts_seek_point_t *p = p_point;
+    while( !p->b_rai )
+    {
+        if( p == p_first || p->i_pcr - p[-1].i_pcr > i_max_gap ||
+            p_point->i_pcr - p[-1].i_pcr > i_max_distance )
+            return NULL;
+        p--;
+    }
+    return p;
+}
+
+/*****************************************************************************
+ * Index file
+ *****************************************************************************/
+static char * IndexPath( demux_t *p_demux, uint64_t *pi_size )
+{
+    stream_t *s = p_demux->s;
+    uint64_t i_mtime = 0;
+
+    if( s->psz_url == NULL || vlc_stream_GetSize( s, pi_size ) || *pi_size == 0 )
+        return NULL;
+    /* files modified in place do not keep their points */
+    if( vlc_stream_GetMTime( s, &i_mtime ) )
+        i_mtime = 0;
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( psz_cachedir == NULL )
+        return NULL;
+
+    uint8_t key[16];
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, s->psz_url, strlen( s->psz_url ) );
+    SetQWBE( &key[0], *pi_size );
+    SetQWBE( &key[8], i_mtime );
+    vlc_hash_md5_Update( &md5, key, sizeof(key) );
+
+    uint8_t digest[VLC_HASH_MD5_DIGEST_SIZE];
+    char hex[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_Finish( &md5, digest, sizeof(digest) );
+    vlc_hex_encode_binary( digest, sizeof(digest), hex );
+
+    char *psz_path;
+    if( asprintf( &psz_path, "%s"DIR_SEP"ts"DIR_SEP"%s.idx", psz_cachedir, hex ) == -1 )
+        psz_path = NULL;
+    free( psz_cachedir );
+    return psz_path;
+}
+
+/* Checks the whole file, returns the number of points or -1 */
+static ssize_t IndexValidate( const block_t *p_block, uint64_t i_size )
+{
+    const uint8_t *p = &p_block->p_buffer[sizeof(index_magic)];
+    size_t i_left = p_block->i_buffer - sizeof(index_magic);
+    size_t i_points = 0;
+
+    if( i_left < 4 )
+        return -1;
+    uint32_t i_programs = GetDWBE( p );
+    p += 4; i_left -= 4;
+
+    for( ; i_programs > 0; i_programs-- )
+    {
+        if( i_left < 16 )
+            return -1;
+        uint32_t i_count = GetDWBE( &p[12] );
+        p += 16; i_left -= 16;
+        if( i_left / 16 < i_count )
+            return -1;
+
+        for( uint32_t i = 0; i < i_count; i++, p += 16, i_left -= 16 )
+        {
+            int64_t i_pcr = GetQWBE( p );
+            uint64_t i_pos = GetQWBE( &p[8] ) & ~INDEX_POS_RAI;
+            if( i_pcr < 0 || i_pos >= i_size )
+                return -1;
+            if( i > 0 && (i_pcr <= (int64_t)GetQWBE( p - 16 ) ||
+                          i_pos <= (GetQWBE( p - 8 ) & ~INDEX_POS_RAI)) )
+                return -1;
+        }
+        i_points += i_count;
+    }
+
+    return i_left == 0 ? (ssize_t)i_points : -1;
+}
+
+struct ts_seekindex_t * ts_seekindex_New( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_size;
+
+    /* live and access filtered inputs are not played again the same way */
+    if( p_demux->b_preparsing || !p_sys->b_canseek || p_sys->b_access_control ||
+        !var_InheritBool( p_demux, "ts-seek-index-cache" ) )
+        return NULL;
+
+    struct ts_seekindex_t *p_index = malloc( sizeof(*p_index) );
+    if( unlikely(p_index == NULL) )
+        return NULL;
+    p_index->p_saved = NULL;
+    p_index->i_saved = 0;
+
+    p_index->psz_path = IndexPath( p_demux, &i_size );
+    if( p_index->psz_path == NULL )
+    {
+        free( p_index );
+        return NULL;
+    }
+
+    block_t *p_block = block_FilePath( p_index->psz_path, false );
+    if( p_block == NULL )
+        return p_index;
+
+    ssize_t i_points = -1;
+    if( p_block->i_buffer > sizeof(index_magic) && p_block->i_buffer <= INDEX_MAX_SIZE &&
+        !memcmp( p_block->p_buffer, index_magic, sizeof(index_magic) ) )
+        i_points = IndexValidate( p_block, i_size );
+
+    if( i_points < 0 )
+    {
+        msg_Warn( p_demux, "ignoring invalid seek index %s", p_index->psz_path );
+        block_Release( p_block );
+        vlc_unlink( p_index->psz_path );
+        return p_index;
+    }
+
+#ifdef HAVE_UTIMENSAT
+    /* keep recently used indexes when trimming the directory */
+    utimensat( AT_FDCWD, p_index->psz_path, NULL, 0 );
+#endif
+
+    p_index->p_saved = p_block;
+    p_index->i_saved = i_points;
+    msg_Dbg( p_demux, "loaded seek index with %zu points", p_index->i_saved );
+    return p_index;
+}
+
+void ts_seekindex_Merge( struct ts_seekindex_t *p_index, ts_pmt_t *p_pmt )
+{
+    if( p_pmt->b_seekindex_merged || p_pmt->pcr.i_first == TS_TICK_UNKNOWN )
+        return;
+    p_pmt->b_seekindex_merged = true;
+
+    if( p_index == NULL || p_index->p_saved == NULL )
+        return;
+
+    /* already validated */
+    const uint8_t *p = &p_index->p_saved->p_buffer[sizeof(index_magic)];
+    uint32_t i_programs = GetDWBE( p );
+    p += 4;
+
+    for( ; i_programs > 0; i_programs-- )
+    {
+        const int i_number = GetDWBE( p );
+        const stime_t i_first = GetQWBE( &p[4] );
+        const uint32_t i_count = GetDWBE( &p[12] );
+        p += 16;
+
+        /* points are relative to the first PCR, which must match */
+        if( i_number == p_pmt->i_number && i_first == p_pmt->pcr.i_first )
+        {
+            for( uint32_t i = 0; i < i_count; i++ )
+            {
+                const uint64_t i_pos = GetQWBE( &p[i * 16 + 8] );
+                ts_seekindex_Insert( p_pmt, GetQWBE( &p[i * 16] ),
+                                     i_pos & ~INDEX_POS_RAI, i_pos & INDEX_POS_RAI );
+            }
+        }
+        p += i_count * 16;
+    }
+}
+
+struct index_file
+{
+    char    *psz_path;
+    time_t   i_mtime;
+    uint64_t i_size;
+};
+
+static int IndexFileCmp( const void *a, const void *b )
+{
+    const struct index_file *fa = a, *fb = b;
+    return (fa->i_mtime > fb->i_mtime) - (fa->i_mtime < fb->i_mtime);
+}
+
+/* Removes the least recently used files past the directory size limit */
+static void IndexTrim( demux_t *p_demux, const char *psz_dir )
+{
+    vlc_DIR *dir = vlc_opendir( psz_dir );
+    if( dir == NULL )
+        return;
+
+    DECL_ARRAY(struct index_file) files;
+    ARRAY_INIT( files );
+    uint64_t i_total = 0;
+
+    const char *psz_name;
+    while( (psz_name = vlc_readdir( dir )) != NULL )
+    {
+        const size_t i_len = strlen( psz_name );
+        if( i_len < 4 || strcmp( &psz_name[i_len - 4], ".idx" ) )
+            continue;
+
+        struct index_file file;
+        struct stat st;
+        if( asprintf( &file.psz_path, "%s"DIR_SEP"%s", psz_dir, psz_name ) == -1 )
+            continue;
+        if( vlc_stat( file.psz_path, &st ) )
+        {
+            free( file.psz_path );
+            continue;
+        }
+        file.i_mtime = st.st_mtime;
+        file.i_size = st.st_size;
+        i_total += file.i_size;
+        ARRAY_APPEND( files, file );
+    }
+    vlc_closedir( dir );
+
+    if( i_total > INDEX_DIR_MAX_SIZE )
+        qsort( files.p_elems, files.i_size, sizeof(*files.p_elems), IndexFileCmp );
+
+    for( int i = 0; i < files.i_size; i++ )
+    {
+        if( i_total > INDEX_DIR_MAX_SIZE && !vlc_unlink( files.p_elems[i].psz_path ) )
+        {
+            msg_Dbg( p_demux, "removed seek index %s", files.p_elems[i].psz_path );
+            i_total -= files.p_elems[i].i_size;
+        }
+        free( files.p_elems[i].psz_path );
+    }
+    ARRAY_RESET( files );
+}
+
+static void IndexSave( demux_t *p_demux, const char *psz_path,
+                       const ts_pat_t *p_pat, size_t i_points )
+{
+    size_t i_size = sizeof(index_magic) + 4 + p_pat->programs.i_size * 16 + i_points * 16;
+    if( i_size > INDEX_MAX_SIZE )
+        return;
+
+    uint8_t *p_data = malloc( i_size );
+    if( unlikely(p_data == NULL) )
+        return;
+
+    uint8_t *p = p_data;
+    memcpy( p, index_magic, sizeof(index_magic) );
+    p += sizeof(index_magic);
+    SetDWBE( p, p_pat->programs.i_size );
+    p += 4;
+    for( int i = 0; i < p_pat->programs.i_size; i++ )
+    {
+        const ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+        SetDWBE( p, p_pmt->i_number );
+        SetQWBE( &p[4], p_pmt->pcr.i_first );
+        SetDWBE( &p[12], p_pmt->seekpoints.i_size );
+        p += 16;
+        for( int j = 0; j < p_pmt->seekpoints.i_size; j++, p += 16 )
+        {
+            const ts_seek_point_t *p_point = &p_pmt->seekpoints.p_elems[j];
+            SetQWBE( p, p_point->i_pcr );
+            SetQWBE( &p[8], p_point->i_pos | (p_point->b_rai ? INDEX_POS_RAI : 0) );
+        }
+    }
+
+    char *psz_dir = strdup( psz_path );
+    char *psz_sep = psz_dir ? strrchr( psz_dir, DIR_SEP_CHAR ) : NULL;
+    if( psz_sep == NULL )
+        goto end;
+    *psz_sep = '\0';
+    if( vlc_mkdir_parent( psz_dir, 0700 ) && errno != EEXIST )
+    {
+        msg_Warn( p_demux, "cannot create seek index directory" );
+        goto end;
+    }
+
+    char *psz_temp;
+    if( asprintf( &psz_temp, "%s.tmp", psz_path ) == -1 )
+        goto end;
+
+    int fd = vlc_open( psz_temp, O_WRONLY | O_CREAT | O_TRUNC, 0600 );
+    if( fd != -1 )
+    {
+        bool b_error = vlc_write( fd, p_data, i_size ) != (ssize_t) i_size;
+        vlc_close( fd );
+
+        if( b_error || vlc_rename( psz_temp, psz_path ) )
+            vlc_unlink( psz_temp );
+        else
+        {
+            msg_Dbg( p_demux, "saved seek index to %s", psz_path );
+            IndexTrim( p_demux, psz_dir );
+        }
+    }
+    free( psz_temp );
+
+end:
+    free( psz_dir );
+    free( p_data );
+}
+
+void ts_seekindex_Delete( demux_t *p_demux, struct ts_seekindex_t *p_index,
+                          const ts_pat_t *p_pat )
+{
+    if( p_pat )
+    {
+        size_t i_points = 0;
+        for( int i = 0; i < p_pat->programs.i_size; i++ )
+        {
+            ts_pmt_t *p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+            ts_seekindex_Merge( p_index, p_pmt );
+            i_points += p_pmt->seekpoints.i_size;
+        }
+
+        /* nothing new was played */
+        if( i_points > p_index->i_saved )
+            IndexSave( p_demux, p_index->psz_path, p_pat, i_points );
+    }
+
+    if( p_index->p_saved )
+        block_Release( p_index->p_saved );
+    free( p_index->psz_path );
+    free( p_index );
+}
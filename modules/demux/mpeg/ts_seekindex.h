@@ -0,0 +1,47 @@
+/*****************************************************************************
+ * ts_seekindex.h: Transport Stream input module for VLC.
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_SEEKINDEX_H
+#define VLC_TS_SEEKINDEX_H
+
+/* PCR positions of the already played parts of a file, kept in the
+ * user cache directory so they can be reused by the next playbacks.
+ * Returns NULL if the index can't or must not be persisted. */
+struct ts_seekindex_t * ts_seekindex_New( demux_t * );
+/* Saves the points of all programs if more were found, then releases */
+void ts_seekindex_Delete( demux_t *, struct ts_seekindex_t *, const ts_pat_t * );
+
+/* Adds the saved points of that program, once its first PCR is known */
+void ts_seekindex_Merge( struct ts_seekindex_t *, ts_pmt_t * );
+
+/* Inserts a point, unless it is too close to or out of order with others.
+ * Random access points replace the regular points too close to them. */
+void ts_seekindex_Insert( ts_pmt_t *, stime_t i_pcr, uint64_t i_pos, bool b_rai );
+/* Returns the closest points around that time */
+void ts_seekindex_Lookup( const ts_pmt_t *, stime_t i_pcr,
+                          const ts_seek_point_t **pp_prev,
+                          const ts_seek_point_t **pp_next );
+/* Returns the last random access point at or before that point, if the part
+ * in between was played continuously and is not longer than i_max_distance */
+const ts_seek_point_t * ts_seekindex_LookupRAI( const ts_pmt_t *,
+                                                const ts_seek_point_t *,
+                                                stime_t i_max_gap,
+                                                stime_t i_max_distance );
+
+#endif
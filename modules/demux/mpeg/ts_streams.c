@@ -103,6 +103,8 @@ ts_pmt_t *ts_pmt_New( demux_t *p_demux )
     pmt->iod        = NULL;
     pmt->od.i_version = -1;
     ARRAY_INIT( pmt->od.objects );
+    ARRAY_INIT( pmt->seekpoints );
+    pmt->b_seekindex_merged = false;
 
     pmt->i_last_dts = TS_TICK_UNKNOWN;
     pmt->i_last_dts_byte = 0;
@@ -142,6 +144,7 @@ void ts_pmt_Del( demux_t *p_demux, ts_pmt_t *pmt )
     for( int i=0; i<pmt->od.objects.i_size; i++ )
         ODFree( pmt->od.objects.p_elems[i] );
     ARRAY_RESET( pmt->od.objects );
+    ARRAY_RESET( pmt->seekpoints );
     if( pmt->i_number > -1 )
         es_out_Control( p_demux->out, ES_OUT_DEL_GROUP, pmt->i_number );
 
@@ -39,6 +39,13 @@ struct ts_pat_t
 
 };
 
+typedef struct
+{
+    stime_t  i_pcr;
+    uint64_t i_pos;
+    bool     b_rai; /* the PCR packet had the random access indicator */
+} ts_seek_point_t;
+
 struct ts_pmt_t
 {
     ts_psi_context_t *p_ctx;
@@ -77,6 +84,10 @@ struct ts_pmt_t
     stime_t i_last_dts;
     uint64_t i_last_dts_byte;
 
+    /* PCR positions seen while playing, sorted by time */
+    DECL_ARRAY(ts_seek_point_t) seekpoints;
+    bool            b_seekindex_merged; /* with the saved ones */
+
     /* CA */
     //en50221_capmt_info_t *capmt;
 
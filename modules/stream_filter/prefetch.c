@@ -35,6 +35,23 @@
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
 
+/* Number of ranges retained around the last seek positions */
+#define PREFETCH_RANGES 4
+/* Smallest adaptive read-ahead window */
+#define PREFETCH_MIN_WINDOW (256 << 10)
+/* Minimum measurement period for the source and consumer rates */
+#define PREFETCH_RATE_PERIOD VLC_TICK_FROM_MS(500)
+/* Consecutive short seeks denoting an interleaved access pattern */
+#define PREFETCH_INTERLEAVE_SEEKS 3
+
+struct prefetch_range
+{
+    uint64_t   offset;
+    size_t     length;
+    char      *data;
+    vlc_tick_t last_use;
+};
+
 struct stream_ctrl
 {
     struct stream_ctrl *next;
@@ -76,9 +93,180 @@ typedef struct
     char        *buffer;
     size_t       seek_threshold;
 
+    /* Adaptive read-ahead, rates are in bytes per second (0 if unknown) */
+    vlc_tick_t   readahead;
+    size_t       window;
+    uint64_t     source_rate;
+    uint64_t     source_bytes;
+    vlc_tick_t   source_time;
+    uint64_t     consumer_rate;
+    uint64_t     consumer_bytes;
+    vlc_tick_t   consumer_start;
+
+    /* Access pattern */
+    uint64_t     departure; /* offset before the last seek */
+    unsigned     short_seeks;
+    size_t       interleave_span;
+
+    /* Data retained around previous seek positions */
+    size_t       retain_size;
+    struct prefetch_range ranges[PREFETCH_RANGES];
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
+static uint64_t RateUpdate(uint64_t rate, uint64_t bytes, vlc_tick_t duration)
+{
+    uint64_t sample = bytes * CLOCK_FREQ / duration;
+
+    return (rate == 0) ? sample : (3 * rate + sample) / 4;
+}
+
+/**
+ * Computes how much unread data the thread should keep buffered.
+ *
+ * The window covers the configured read-ahead duration at the consumer
+ * rate, with more margin if the source is barely faster than the consumer.
+ */
+static size_t ReadAheadWindow(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    uint64_t window;
+
+    if (sys->source_rate == 0 || sys->consumer_rate == 0)
+        window = sys->buffer_size; /* not measured yet */
+    else
+    {
+        window = sys->consumer_rate * sys->readahead / CLOCK_FREQ;
+        if (sys->source_rate < 2 * sys->consumer_rate)
+            window *= 2;
+        if (window < PREFETCH_MIN_WINDOW)
+            window = PREFETCH_MIN_WINDOW;
+        if (window > sys->buffer_size)
+            window = sys->buffer_size;
+    }
+
+    if (window > sys->window + sys->window / 4
+     || window < sys->window - sys->window / 4)
+    {
+        msg_Dbg(stream, "read-ahead window: %"PRIu64" bytes (source %"PRIu64
+                " B/s, consumer %"PRIu64" B/s)", window, sys->source_rate,
+                sys->consumer_rate);
+        sys->window = window;
+    }
+    return sys->window;
+}
+
+static bool IsInterleaved(const stream_sys_t *sys)
+{
+    return sys->short_seeks >= PREFETCH_INTERLEAVE_SEEKS;
+}
+
+static size_t SeekThreshold(const stream_sys_t *sys)
+{
+    /* Read through the gaps of interleaved accesses rather than seeking */
+    if (IsInterleaved(sys) && sys->interleave_span > sys->seek_threshold)
+        return sys->interleave_span;
+    return sys->seek_threshold;
+}
+
+static struct prefetch_range *RangeFind(stream_sys_t *sys, uint64_t offset)
+{
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+    {
+        struct prefetch_range *range = &sys->ranges[i];
+
+        if (range->length > 0 && offset >= range->offset
+         && offset - range->offset < range->length)
+            return range;
+    }
+    return NULL;
+}
+
+static bool BufferHas(const stream_sys_t *sys, uint64_t offset)
+{
+    return offset >= sys->buffer_offset
+        && offset - sys->buffer_offset < sys->buffer_length;
+}
+
+/**
+ * Returns the first offset the thread needs to fetch for the reader.
+ *
+ * Data that the reader will get from retained ranges is skipped over.
+ */
+static uint64_t NextOffset(stream_sys_t *sys)
+{
+    uint64_t offset = sys->stream_offset;
+    struct prefetch_range *range;
+
+    if (BufferHas(sys, offset))
+        return offset;
+
+    while ((range = RangeFind(sys, offset)) != NULL)
+        offset = range->offset + range->length;
+    return offset;
+}
+
+/**
+ * Retains the buffered data around the position the reader seeked from,
+ * before the buffer gets discarded.
+ */
+static void RangeSave(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    uint64_t end = sys->buffer_offset + sys->buffer_length;
+    uint64_t center = sys->departure;
+
+    if (sys->retain_size == 0 || center < sys->buffer_offset || center > end)
+        return;
+
+    uint64_t start = sys->buffer_offset;
+    if (center - start > sys->retain_size / 2)
+        start = center - sys->retain_size / 2;
+
+    size_t length = end - start;
+    if (length > sys->retain_size)
+        length = sys->retain_size;
+    if (length == 0)
+        return;
+
+    /* Replace a range covered by the new one, or else the least recent */
+    struct prefetch_range *range = &sys->ranges[0];
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+    {
+        struct prefetch_range *r = &sys->ranges[i];
+
+        if (r->length == 0 || (r->offset >= start
+                            && r->offset + r->length <= start + length))
+        {
+            range = r;
+            break;
+        }
+        if (r->last_use < range->last_use)
+            range = r;
+    }
+
+    if (range->data == NULL)
+    {
+        range->data = malloc(sys->retain_size);
+        if (unlikely(range->data == NULL))
+            return;
+    }
+
+    size_t offset = start % sys->buffer_size;
+    size_t copy = length;
+    /* Do not step past the sharp edge of the circular buffer */
+    if (offset + copy > sys->buffer_size)
+        copy = sys->buffer_size - offset;
+    memcpy(range->data, sys->buffer + offset, copy);
+    memcpy(range->data + copy, sys->buffer, length - copy);
+
+    range->offset = start;
+    range->length = length;
+    range->last_use = vlc_tick_now();
+    msg_Dbg(stream, "retaining %zu bytes at offset %"PRIu64, length, start);
+}
+
 static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -162,10 +350,11 @@ static void *Thread(void *data)
             continue;
         }
 
-        uint_fast64_t stream_offset = sys->stream_offset;
+        uint_fast64_t stream_offset = NextOffset(sys);
 
         if (stream_offset < sys->buffer_offset)
         {   /* Need to seek backward */
+            RangeSave(stream);
             if (ThreadSeek(stream, stream_offset) == 0)
             {
                 sys->buffer_offset = stream_offset;
@@ -200,8 +389,9 @@ static void *Thread(void *data)
          * seek is a no-op, and continue as if seeking was not supported.
          * WARNING: Except problems with misbehaving access plug-ins. */
         if (sys->can_seek
-         && history >= (sys->buffer_length + sys->seek_threshold))
+         && history >= (sys->buffer_length + SeekThreshold(sys)))
         {
+            RangeSave(stream);
             if (ThreadSeek(stream, stream_offset) == 0)
             {
                 sys->buffer_offset = stream_offset;
@@ -223,17 +413,30 @@ static void *Thread(void *data)
 
         assert(sys->buffer_size >= sys->buffer_length);
 
+        size_t ahead = (history < sys->buffer_length)
+                       ? sys->buffer_length - history : 0;
+        if (ahead >= ReadAheadWindow(stream))
+        {   /* Enough data ahead of the reader, wait for it to be read */
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
+
         size_t len = sys->buffer_size - sys->buffer_length;
         if (len == 0)
         {   /* Buffer is full */
-            if (history == 0)
+            /* Keep the data that interleaved accesses will seek back to. */
+            size_t keep = IsInterleaved(sys) ? sys->interleave_span : 0;
+
+            if (history <= keep)
             {   /* Wait for data to be read */
                 vlc_cond_wait(&sys->wait_space, &sys->lock);
                 continue;
             }
 
             /* Discard some historical data to make room. */
-            len = history > sys->buffer_length ? sys->buffer_length : history;
+            len = history - keep;
+            if (len > sys->buffer_length)
+                len = sys->buffer_length;
 
             sys->buffer_offset += len;
             sys->buffer_length -= len;
@@ -245,9 +448,21 @@ static void *Thread(void *data)
         if (offset + len > sys->buffer_size)
             len = sys->buffer_size - offset;
 
+        vlc_tick_t start = vlc_tick_now();
         ssize_t val = ThreadRead(stream, sys->buffer + offset, len);
         if (val < 0)
             continue;
+
+        sys->source_bytes += val;
+        sys->source_time += vlc_tick_now() - start;
+        if (sys->source_time >= PREFETCH_RATE_PERIOD)
+        {
+            sys->source_rate = RateUpdate(sys->source_rate, sys->source_bytes,
+                                          sys->source_time);
+            sys->source_bytes = 0;
+            sys->source_time = 0;
+        }
+
         if (val == 0)
         {
             assert(len > 0);
@@ -274,6 +489,30 @@ static int Seek(stream_t *stream, uint64_t offset)
     stream_sys_t *sys = stream->p_sys;
 
     vlc_mutex_lock(&sys->lock);
+    if (offset != sys->stream_offset)
+    {
+        uint64_t delta = (offset > sys->stream_offset)
+                         ? offset - sys->stream_offset
+                         : sys->stream_offset - offset;
+
+        /* Short seeks back and forth denote an interleaved file read from
+         * several positions, e.g. a badly interleaved AVI or MP4 file. */
+        if (delta <= sys->buffer_size / 2)
+        {
+            if (sys->short_seeks < PREFETCH_INTERLEAVE_SEEKS
+             && ++sys->short_seeks == PREFETCH_INTERLEAVE_SEEKS)
+                msg_Dbg(stream, "interleaved access detected");
+            sys->interleave_span -= sys->interleave_span / 8;
+            if (sys->interleave_span < delta)
+                sys->interleave_span = delta;
+        }
+        else
+        {
+            sys->short_seeks = 0;
+            sys->interleave_span = 0;
+        }
+        sys->departure = sys->stream_offset;
+    }
     sys->stream_offset = offset;
     sys->error = false;
     vlc_cond_signal(&sys->wait_space);
@@ -314,6 +553,23 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_cond_signal(&sys->wait_space);
     }
 
+    if (!BufferHas(sys, sys->stream_offset))
+    {   /* Serve recently read data from the retained ranges */
+        struct prefetch_range *range = RangeFind(sys, sys->stream_offset);
+
+        if (range != NULL)
+        {
+            offset = sys->stream_offset - range->offset;
+            copy = range->length - offset;
+            if (copy > buflen)
+                copy = buflen;
+
+            memcpy(buf, range->data + offset, copy);
+            range->last_use = vlc_tick_now();
+            goto out;
+        }
+    }
+
     while ((copy = BufferLevel(stream, &eof)) == 0 && !eof)
     {
         void *data[2];
@@ -337,7 +593,19 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         copy = sys->buffer_size - offset;
 
     memcpy(buf, sys->buffer + offset, copy);
+out:
     sys->stream_offset += copy;
+
+    sys->consumer_bytes += copy;
+    vlc_tick_t now = vlc_tick_now();
+    if (now - sys->consumer_start >= PREFETCH_RATE_PERIOD)
+    {
+        sys->consumer_rate = RateUpdate(sys->consumer_rate,
+                                        sys->consumer_bytes,
+                                        now - sys->consumer_start);
+        sys->consumer_bytes = 0;
+        sys->consumer_start = now;
+    }
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -394,6 +662,9 @@ static int Control(stream_t *stream, int query, va_list args)
 
             vlc_mutex_lock(&sys->lock);
             sys->paused = paused;
+            /* Do not account the pause in the consumer rate */
+            sys->consumer_bytes = 0;
+            sys->consumer_start = vlc_tick_now();
             vlc_cond_signal(&sys->wait_space);
             vlc_mutex_unlock (&sys->lock);
             break;
@@ -472,6 +743,24 @@ static int Open(vlc_object_t *obj)
     sys->buffer_length = 0;
     sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
+    sys->readahead = VLC_TICK_FROM_SEC(var_InheritInteger(obj,
+                                                          "prefetch-readahead"));
+    sys->source_rate = 0;
+    sys->source_bytes = 0;
+    sys->source_time = 0;
+    sys->consumer_rate = 0;
+    sys->consumer_bytes = 0;
+    sys->consumer_start = vlc_tick_now();
+    sys->departure = 0;
+    sys->short_seeks = 0;
+    sys->interleave_span = 0;
+    sys->retain_size = var_InheritInteger(obj, "prefetch-seek-retain") << 10u;
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+    {
+        sys->ranges[i].length = 0;
+        sys->ranges[i].data = NULL;
+        sys->ranges[i].last_use = 0;
+    }
     sys->controls = NULL;
 
     uint64_t size = stream_Size(stream->s);
@@ -480,6 +769,9 @@ static int Open(vlc_object_t *obj)
         if (sys->buffer_size > size)
             sys->buffer_size = size;
     }
+    sys->window = sys->buffer_size;
+    if (sys->retain_size > sys->buffer_size)
+        sys->retain_size = sys->buffer_size;
 
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
@@ -537,6 +829,8 @@ static void Close (vlc_object_t *obj)
         sys->controls = ctrl->next;
         free(ctrl);
     }
+    for (size_t i = 0; i < PREFETCH_RANGES; i++)
+        free(sys->ranges[i].data);
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -556,4 +850,12 @@ vlc_module_begin()
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"))
         change_integer_range(0, UINT64_C(1) << 60)
+    add_integer("prefetch-readahead", 10, N_("Read-ahead duration"),
+                N_("Duration of data to read ahead at the consumer rate, "
+                   "within the buffer size (seconds)"))
+        change_integer_range(1, 3600)
+    add_integer("prefetch-seek-retain", 1 << 10, N_("Retained seek data"),
+                N_("Recently read data to keep around each of the last seek "
+                   "positions (KiB)"))
+        change_integer_range(0, 1 << 20)
 vlc_module_end()
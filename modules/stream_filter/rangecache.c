@@ -0,0 +1,338 @@
+/*****************************************************************************
+ * rangecache.c: byte range cache for seekable network streams
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+#include <vlc_vector.h>
+
+/* Largest cached range: reads extend the range they follow up to this size,
+ * and bigger reads bypass the cache. It is also the eviction granularity. */
+#define RANGE_MAX_SIZE (1 << 20)
+
+struct cache_range
+{
+    uint64_t start;
+    size_t   length;
+    uint64_t last_use;
+    uint8_t *data;
+};
+
+typedef struct
+{
+    /* Non-overlapping ranges, sorted by start offset */
+    struct VLC_VECTOR(struct cache_range *) ranges;
+    size_t   cached; /* bytes in all ranges */
+    size_t   max_cached;
+    size_t   read_size;
+    uint64_t use_count; /* LRU clock */
+
+    uint64_t offset; /* downstream position */
+    uint64_t source_offset; /* upstream position */
+    uint64_t size; /* UINT64_MAX if unknown */
+
+    /* Stats */
+    uint64_t hits;
+    uint64_t misses;
+} stream_sys_t;
+
+/**
+ * Finds the index of the last range starting at or before an offset.
+ *
+ * @return the index, or -1 if all ranges start after the offset
+ */
+static ssize_t RangeLookup(const stream_sys_t *sys, uint64_t offset)
+{
+    size_t lo = 0, hi = sys->ranges.size;
+
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+
+        if (sys->ranges.data[mid]->start <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (ssize_t)lo - 1;
+}
+
+static void RangeRemove(stream_sys_t *sys, size_t index)
+{
+    struct cache_range *range = sys->ranges.data[index];
+
+    assert(sys->cached >= range->length);
+    sys->cached -= range->length;
+    vlc_vector_remove(&sys->ranges, index);
+    free(range->data);
+    free(range);
+}
+
+/**
+ * Evicts the least recently used ranges until the cache fits its size,
+ * keeping the given range.
+ */
+static void CacheEvict(stream_sys_t *sys, const struct cache_range *keep)
+{
+    while (sys->cached > sys->max_cached)
+    {
+        size_t victim = SIZE_MAX;
+
+        for (size_t i = 0; i < sys->ranges.size; i++)
+        {
+            const struct cache_range *range = sys->ranges.data[i];
+
+            if (range != keep && (victim == SIZE_MAX
+             || range->last_use < sys->ranges.data[victim]->last_use))
+                victim = i;
+        }
+        if (victim == SIZE_MAX)
+            break;
+        RangeRemove(sys, victim);
+    }
+}
+
+static void CacheFlush(stream_sys_t *sys)
+{
+    while (sys->ranges.size > 0)
+        RangeRemove(sys, sys->ranges.size - 1);
+    assert(sys->cached == 0);
+}
+
+static ssize_t SourceRead(stream_t *stream, void *buf, size_t length)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    if (sys->source_offset != sys->offset)
+    {
+        if (vlc_stream_Seek(stream->s, sys->offset))
+        {
+            msg_Err(stream, "cannot seek (to offset %"PRIu64")", sys->offset);
+            return 0;
+        }
+        sys->source_offset = sys->offset;
+    }
+
+    ssize_t val = vlc_stream_Read(stream->s, buf, length);
+    if (val > 0)
+        sys->source_offset += val;
+    return val;
+}
+
+static ssize_t Read(stream_t *stream, void *buf, size_t length)
+{
+    stream_sys_t *sys = stream->p_sys;
+    uint64_t offset = sys->offset;
+    ssize_t index = RangeLookup(sys, offset);
+    struct cache_range *range = NULL;
+
+    if (length == 0)
+        return 0;
+
+    if (index >= 0)
+    {
+        range = sys->ranges.data[index];
+        if (offset - range->start < range->length)
+        {   /* Cache hit */
+            size_t pos = offset - range->start;
+            size_t copy = range->length - pos;
+
+            if (copy > length)
+                copy = length;
+            memcpy(buf, range->data + pos, copy);
+            range->last_use = ++sys->use_count;
+            sys->offset += copy;
+            sys->hits++;
+            return copy;
+        }
+    }
+
+    sys->misses++;
+
+    if (length >= RANGE_MAX_SIZE)
+    {   /* Too large to be worth caching */
+        ssize_t val = SourceRead(stream, buf, length);
+        if (val > 0)
+            sys->offset += val;
+        return val;
+    }
+
+    /* Read ahead, but not into the next cached range nor past the end */
+    uint64_t fetch = (length > sys->read_size) ? length : sys->read_size;
+    if ((size_t)(index + 1) < sys->ranges.size)
+    {
+        uint64_t gap = sys->ranges.data[index + 1]->start - offset;
+        if (fetch > gap)
+            fetch = gap;
+    }
+    if (sys->size != UINT64_MAX && sys->size > offset
+     && fetch > sys->size - offset)
+        fetch = sys->size - offset;
+    if (fetch > RANGE_MAX_SIZE)
+        fetch = RANGE_MAX_SIZE;
+
+    /* Coalesce with the range ending at the offset, if there is room */
+    if (range == NULL || range->start + range->length != offset
+     || range->length + fetch > RANGE_MAX_SIZE)
+    {
+        range = malloc(sizeof (*range));
+        if (unlikely(range == NULL))
+            return 0;
+
+        range->start = offset;
+        range->length = 0;
+        range->data = NULL;
+        if (!vlc_vector_insert(&sys->ranges, index + 1, range))
+        {
+            free(range);
+            return 0;
+        }
+        index++;
+    }
+
+    uint8_t *data = realloc(range->data, range->length + fetch);
+    if (unlikely(data == NULL))
+        goto error;
+    range->data = data;
+
+    ssize_t val = SourceRead(stream, data + range->length, fetch);
+    if (val <= 0)
+        goto error;
+
+    size_t pos = range->length;
+    range->length += val;
+    range->last_use = ++sys->use_count;
+    sys->cached += val;
+
+    size_t copy = (size_t)val < length ? (size_t)val : length;
+    memcpy(buf, range->data + pos, copy);
+    sys->offset += copy;
+
+    CacheEvict(sys, range);
+    return copy;
+
+error:
+    if (range->length == 0)
+    {   /* Drop the range that was just inserted */
+        vlc_vector_remove(&sys->ranges, index);
+        free(range->data);
+        free(range);
+    }
+    return 0;
+}
+
+static int Seek(stream_t *stream, uint64_t offset)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    /* The upstream stream is seeked lazily, on cache misses */
+    sys->offset = offset;
+    return VLC_SUCCESS;
+}
+
+static int Control(stream_t *stream, int query, va_list args)
+{
+    stream_sys_t *sys = stream->p_sys;
+
+    switch (query)
+    {
+        case STREAM_SET_TITLE:
+        case STREAM_SET_SEEKPOINT:
+        {
+            int ret = vlc_stream_vaControl(stream->s, query, args);
+            if (ret == VLC_SUCCESS)
+            {   /* The byte offsets now refer to other data */
+                CacheFlush(sys);
+                sys->offset = sys->source_offset = vlc_stream_Tell(stream->s);
+            }
+            return ret;
+        }
+    }
+
+    return vlc_stream_vaControl(stream->s, query, args);
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+
+    /* Only seekable streams revisit their data, and local files are cached
+     * by the operating system already. */
+    if (!vlc_stream_CanSeek(stream->s) || vlc_stream_CanFastSeek(stream->s))
+        return VLC_EGENERIC;
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    vlc_vector_init(&sys->ranges);
+    sys->cached = 0;
+    sys->max_cached = var_InheritInteger(obj, "rangecache-size") << 10u;
+    sys->read_size = var_InheritInteger(obj, "rangecache-read-size") << 10u;
+    sys->use_count = 0;
+    sys->offset = sys->source_offset = vlc_stream_Tell(stream->s);
+    if (vlc_stream_GetSize(stream->s, &sys->size) != VLC_SUCCESS)
+        sys->size = UINT64_MAX;
+    sys->hits = 0;
+    sys->misses = 0;
+
+    msg_Dbg(stream, "caching up to %zu bytes in ranges", sys->max_cached);
+    stream->p_sys = sys;
+    stream->pf_read = Read;
+    stream->pf_seek = Seek;
+    stream->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    stream_sys_t *sys = stream->p_sys;
+
+    msg_Dbg(stream, "%"PRIu64" cache hits, %"PRIu64" misses in %zu ranges",
+            sys->hits, sys->misses, sys->ranges.size);
+    CacheFlush(sys);
+    vlc_vector_destroy(&sys->ranges);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    set_capability("stream_filter", 0)
+    add_shortcut("rangecache")
+
+    set_description(N_("Byte range cache"))
+    set_callbacks(Open, Close)
+
+    add_integer("rangecache-size", 1 << 14, N_("Cache size"),
+                N_("Maximum amount of cached data (KiB)"))
+        change_integer_range(64, 1 << 20)
+    add_integer("rangecache-read-size", 64, N_("Read size"),
+                N_("Minimum amount of data requested on cache misses (KiB)"))
+        change_integer_range(1, 1 << 10)
+vlc_module_end()
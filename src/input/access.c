@@ -325,6 +325,11 @@ stream_t *stream_AccessNew(vlc_object_t *parent, input_thread_t *input,
         s->p_sys = access;
 
         s = stream_FilterChainNew(s, "prefetch,cache");
+
+        /* Keep the byte ranges demuxers seek back to (headers, indexes)
+         * when each seek costs a new request. */
+        if (vlc_stream_CanSeek(access) && !vlc_stream_CanFastSeek(access))
+            s = stream_FilterChainNew(s, "rangecache");
     }
     else
         s = access;
@@ -148,6 +148,9 @@ struct vlc_input_decoder_t
 
     /* fifo */
     block_fifo_t *p_fifo;
+    /* Set when the status must be reported through the locked path, see
+     * vlc_input_decoder_DecodeWithStatus() */
+    atomic_bool status_changed;
 
     /* Lock for communication with decoder thread */
     vlc_cond_t  wait_request;
@@ -248,6 +251,9 @@ struct vlc_input_decoder_t
  * a bogus PTS and won't be displayed */
 #define DECODER_BOGUS_VIDEO_DELAY                ((vlc_tick_t)(DEFAULT_PTS_DELAY * 30))
 
+/* Unpaced input beyond this is dropped: 400 MiB, i.e. ~ 50mb/s for 60s */
+#define DECODER_MAX_FIFO_BYTES (400*1024*1024)
+
 /* */
 #define DECODER_SPU_VOUT_WAIT_DURATION   VLC_TICK_FROM_MS(200)
 #define BLOCK_FLAG_CORE_PRIVATE_RELOADED (1 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
@@ -477,6 +483,7 @@ static void DecoderUpdateFormatLocked( vlc_input_decoder_t *p_owner )
     }
 
     p_owner->b_fmt_description = true;
+    atomic_store_explicit(&p_owner->status_changed, true, memory_order_relaxed);
 }
 
 static void MouseEvent( const vlc_mouse_t *newmouse, void *user_data )
@@ -1245,6 +1252,8 @@ static void DecoderPlayCcLocked( vlc_input_decoder_t *p_owner, vlc_frame_t *p_cc
     {
         p_owner->cc.desc = *p_desc;
         p_owner->cc.desc_changed = true;
+        atomic_store_explicit(&p_owner->status_changed, true,
+                              memory_order_relaxed);
     }
 
     if (p_owner->cc.count == 0)
@@ -1964,6 +1973,7 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->p_packetizer = NULL;
 
     p_owner->b_fmt_description = false;
+    atomic_init(&p_owner->status_changed, false);
     p_owner->p_description = NULL;
 
     p_owner->output_delay = p_owner->delay = 0;
@@ -1989,7 +1999,7 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     es_format_Init( &p_owner->fmt, fmt->i_cat, 0 );
 
     /* decoder fifo */
-    p_owner->p_fifo = block_FifoNew();
+    p_owner->p_fifo = vlc_fifo_NewSPSC();
     if( unlikely(p_owner->p_fifo == NULL) )
     {
         vlc_object_delete(p_dec);
@@ -2433,13 +2443,27 @@ void vlc_input_decoder_DecodeWithStatus(vlc_input_decoder_t *p_owner, vlc_frame_
         return;
     }
 
+    /* Without pacing, and unless the decoder has a status to report, the
+     * frame is handed over without locking the decoder. */
+    if( !b_do_pace
+     && !atomic_load_explicit( &p_owner->status_changed, memory_order_relaxed )
+     && vlc_fifo_TryQueue( p_owner->p_fifo, frame, DECODER_MAX_FIFO_BYTES ) )
+    {
+        if( status != NULL )
+        {
+            status->format.changed = false;
+            status->subdec_desc.fmt_array = NULL;
+            status->subdec_desc.fmt_count = 0;
+        }
+        return;
+    }
+
     vlc_fifo_Lock( p_owner->p_fifo );
     if( !b_do_pace )
     {
         /* FIXME: ideally we would check the time amount of data
          * in the FIFO instead of its size. */
-        /* 400 MiB, i.e. ~ 50mb/s for 60s */
-        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > 400*1024*1024 )
+        if( vlc_fifo_GetBytes( p_owner->p_fifo ) > DECODER_MAX_FIFO_BYTES )
         {
             msg_Warn( &p_owner->dec, "decoder/packetizer fifo full (data not "
                       "consumed quickly enough), resetting fifo!" );
@@ -2458,7 +2482,11 @@ void vlc_input_decoder_DecodeWithStatus(vlc_input_decoder_t *p_owner, vlc_frame_
 
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, frame );
     if (status != NULL)
+    {
+        atomic_store_explicit(&p_owner->status_changed, false,
+                              memory_order_relaxed);
         GetStatusLocked(p_owner, status);
+    }
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
 
@@ -1140,6 +1140,12 @@ static const char* const ppsz_restore_playback_desc[] = {
 #define ONEINSTANCEWHENSTARTEDFROMFILE_TEXT N_( \
     "Use only one instance when started from file manager")
 
+#define FRAME_POOL_TEXT N_("Recycle small data frames")
+#define FRAME_POOL_LONGTEXT N_( \
+    "Keep released data frames of up to 64 KiB for reuse instead of " \
+    "returning them to the system allocator. This can reduce allocator " \
+    "contention at high packet rates, at the cost of some memory.")
+
 #define HPRIORITY_TEXT N_("Increase the priority of the process")
 #define HPRIORITY_LONGTEXT N_( \
     "Increasing the priority of the process will very likely improve your " \
@@ -2101,6 +2107,8 @@ vlc_module_begin ()
 
     set_section( N_("Performance options"), NULL )
 
+    add_bool( "frame-pool", false, FRAME_POOL_TEXT, FRAME_POOL_LONGTEXT )
+
 #if defined (LIBVLC_USE_PTHREAD)
     add_obsolete_bool( "rt-priority" ) /* since 4.0.0 */
     add_obsolete_integer( "rt-offset" ) /* since 4.0.0 */
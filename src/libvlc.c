@@ -186,6 +186,10 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     priv->tracer = vlc_tracer_Create(VLC_OBJECT(p_libvlc), tracer_name);
     free(tracer_name);
 
+    priv->frame_pool = var_InheritBool(p_libvlc, "frame-pool");
+    if (priv->frame_pool)
+        vlc_frame_pool_Hold();
+
     /*
      * Support for gettext
      */
@@ -396,6 +400,9 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( p_libvlc );
 
+    if (priv->frame_pool)
+        vlc_frame_pool_Drop(VLC_OBJECT(p_libvlc));
+
     vlc_LogDestroy(p_libvlc->obj.logger);
     if (priv->tracer != NULL)
         vlc_tracer_Destroy(priv->tracer);
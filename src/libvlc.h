@@ -162,6 +162,23 @@ void vlc_objres_clear(vlc_object_t *obj);
 void vlc_objres_remove(vlc_object_t *obj, void *data,
                        bool (*match)(void *, void *));
 
+/*
+ * Frame recycling
+ */
+
+/**
+ * Enables recycling of small frames by size class.
+ *
+ * Each call must be paired with vlc_frame_pool_Drop().
+ */
+void vlc_frame_pool_Hold(void);
+
+/**
+ * Disables recycling once the last holder is gone, then frees the
+ * recycled frames and reports the pool statistics to that object.
+ */
+void vlc_frame_pool_Drop(vlc_object_t *);
+
 /**
  * Private LibVLC instance data.
  */
@@ -189,6 +206,7 @@ typedef struct libvlc_priv_t
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_thumbnailer_t *p_thumbnailer; ///< Lazily instantiated media thumbnailer
     struct vlc_tracer *tracer; ///< Tracer callbacks
+    bool frame_pool; ///< Whether this instance holds the frame pool
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -26,60 +26,154 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
 #include <vlc_block.h>
 #include "libvlc.h"
 
+/* Slots of the lock-free ring of single producer FIFOs, a power of two */
+#define VLC_FIFO_RING_SIZE 64
+
 /**
  * Internal state for block queues
  */
 struct vlc_fifo_t
 {
     vlc_queue_t         q;
-    size_t              i_depth;
-    size_t              i_size;
+    /* counts include the blocks still in the ring */
+    atomic_size_t       i_depth;
+    atomic_size_t       i_size;
+
+    /* Single producer ring, NULL for regular FIFOs.
+     * The producer writes the tail without the lock. Consumers read the
+     * head with the lock held, and move the ring blocks to the queue. */
+    vlc_frame_t       **ring;
+    atomic_size_t       ring_head;
+    atomic_size_t       ring_tail;
+    atomic_bool         ring_waiting;
 };
 
 static_assert (offsetof (block_fifo_t, q) == 0, "Problems in <vlc_block.h>");
 
+static void vlc_fifo_Spill(block_fifo_t *fifo)
+{
+    if (fifo->ring == NULL)
+        return;
+
+    size_t head = atomic_load_explicit(&fifo->ring_head, memory_order_relaxed);
+    /* sequentially consistent, pairs with the ring_waiting check */
+    size_t tail = atomic_load(&fifo->ring_tail);
+    if (head == tail)
+        return;
+
+    block_t *first = fifo->ring[head % VLC_FIFO_RING_SIZE];
+    block_t *last = first;
+    while (++head != tail)
+    {
+        last->p_next = fifo->ring[head % VLC_FIFO_RING_SIZE];
+        last = last->p_next;
+    }
+    last->p_next = NULL;
+    atomic_store_explicit(&fifo->ring_head, tail, memory_order_release);
+
+    vlc_queue_EnqueueUnlocked(&fifo->q, first);
+}
+
 bool vlc_fifo_Held(const block_fifo_t *fifo)
 {
     return vlc_mutex_held(&fifo->q.lock);
 }
 
+bool vlc_fifo_IsEmpty(const block_fifo_t *fifo)
+{
+    return atomic_load_explicit(&fifo->i_depth, memory_order_relaxed) == 0;
+}
+
 size_t vlc_fifo_GetCount(const block_fifo_t *fifo)
 {
     vlc_mutex_assert(&fifo->q.lock);
-    return fifo->i_depth;
+    return atomic_load_explicit(&fifo->i_depth, memory_order_relaxed);
 }
 
 size_t vlc_fifo_GetBytes(const block_fifo_t *fifo)
 {
     vlc_mutex_assert(&fifo->q.lock);
-    return fifo->i_size;
+    return atomic_load_explicit(&fifo->i_size, memory_order_relaxed);
 }
 
 void vlc_fifo_QueueUnlocked(block_fifo_t *fifo, block_t *block)
 {
+    /* blocks already in the ring come first */
+    vlc_fifo_Spill(fifo);
+
     for (block_t *b = block; b != NULL; b = b->p_next) {
-        fifo->i_depth++;
-        fifo->i_size += b->i_buffer;
+        atomic_fetch_add_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&fifo->i_size, b->i_buffer,
+                                  memory_order_relaxed);
     }
 
     vlc_queue_EnqueueUnlocked(&fifo->q, block);
 }
 
+bool vlc_fifo_TryQueue(block_fifo_t *fifo, block_t *block, size_t max_bytes)
+{
+    assert(block->p_next == NULL);
+
+    if (fifo->ring == NULL)
+        return false;
+
+    size_t tail = atomic_load_explicit(&fifo->ring_tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&fifo->ring_head, memory_order_acquire);
+    if (tail - head >= VLC_FIFO_RING_SIZE)
+        return false;
+
+    if (atomic_load_explicit(&fifo->i_size, memory_order_relaxed)
+        + block->i_buffer > max_bytes)
+        return false;
+
+    /* Count before publishing, so that consumers never see a block they
+     * could not account for. */
+    atomic_fetch_add_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fifo->i_size, block->i_buffer,
+                              memory_order_relaxed);
+
+    fifo->ring[tail % VLC_FIFO_RING_SIZE] = block;
+    atomic_store(&fifo->ring_tail, tail + 1);
+
+    /* Only wake the consumer up if it found the FIFO empty. */
+    if (atomic_exchange(&fifo->ring_waiting, false))
+    {
+        vlc_fifo_Lock(fifo);
+        vlc_fifo_Signal(fifo);
+        vlc_fifo_Unlock(fifo);
+    }
+    return true;
+}
+
 block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
 {
     block_t *block = vlc_queue_DequeueUnlocked(&fifo->q);
 
+    if (block == NULL && fifo->ring != NULL) {
+        vlc_fifo_Spill(fifo);
+        block = vlc_queue_DequeueUnlocked(&fifo->q);
+        if (block == NULL) {
+            /* Ask the producer for a signal, then check again in case it
+             * queued a block in between. */
+            atomic_store(&fifo->ring_waiting, true);
+            vlc_fifo_Spill(fifo);
+            block = vlc_queue_DequeueUnlocked(&fifo->q);
+        }
+    }
+
     if (block != NULL) {
-        assert(fifo->i_depth > 0);
-        assert(fifo->i_size >= block->i_buffer);
-        fifo->i_depth--;
-        fifo->i_size -= block->i_buffer;
+        assert(vlc_fifo_GetCount(fifo) > 0);
+        assert(vlc_fifo_GetBytes(fifo) >= block->i_buffer);
+        atomic_fetch_sub_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&fifo->i_size, block->i_buffer,
+                                  memory_order_relaxed);
     }
 
     return block;
@@ -87,27 +181,63 @@ block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
 
 block_t *vlc_fifo_DequeueAllUnlocked(block_fifo_t *fifo)
 {
-    fifo->i_depth = 0;
-    fifo->i_size = 0;
-    return vlc_queue_DequeueAllUnlocked(&fifo->q);
+    if (fifo->ring == NULL) {
+        atomic_store_explicit(&fifo->i_depth, 0, memory_order_relaxed);
+        atomic_store_explicit(&fifo->i_size, 0, memory_order_relaxed);
+        return vlc_queue_DequeueAllUnlocked(&fifo->q);
+    }
+
+    /* The producer may be counting a block it did not publish yet */
+    vlc_fifo_Spill(fifo);
+
+    block_t *block = vlc_queue_DequeueAllUnlocked(&fifo->q);
+    for (block_t *b = block; b != NULL; b = b->p_next) {
+        atomic_fetch_sub_explicit(&fifo->i_depth, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&fifo->i_size, b->i_buffer,
+                                  memory_order_relaxed);
+    }
+    return block;
 }
 
-block_fifo_t *vlc_fifo_New( void )
+static block_fifo_t *vlc_fifo_Create(bool spsc)
 {
     block_fifo_t *p_fifo = malloc( sizeof( block_fifo_t ) );
 
     if (likely(p_fifo != NULL)) {
         vlc_queue_Init(&p_fifo->q, offsetof (block_t, p_next));
-        p_fifo->i_depth = 0;
-        p_fifo->i_size = 0;
+        atomic_init(&p_fifo->i_depth, 0);
+        atomic_init(&p_fifo->i_size, 0);
+        p_fifo->ring = NULL;
+        atomic_init(&p_fifo->ring_head, 0);
+        atomic_init(&p_fifo->ring_tail, 0);
+        atomic_init(&p_fifo->ring_waiting, false);
+
+        if (spsc) {
+            p_fifo->ring = vlc_alloc(VLC_FIFO_RING_SIZE, sizeof (block_t *));
+            if (unlikely(p_fifo->ring == NULL)) {
+                free(p_fifo);
+                return NULL;
+            }
+        }
     }
 
     return p_fifo;
 }
 
+block_fifo_t *vlc_fifo_New( void )
+{
+    return vlc_fifo_Create(false);
+}
+
+block_fifo_t *vlc_fifo_NewSPSC( void )
+{
+    return vlc_fifo_Create(true);
+}
+
 void vlc_fifo_Delete( block_fifo_t *p_fifo )
 {
     vlc_fifo_Empty(p_fifo);
+    free( p_fifo->ring );
     free( p_fifo );
 }
 
@@ -118,13 +248,12 @@ block_t *vlc_fifo_Get(block_fifo_t *fifo)
     vlc_testcancel();
 
     vlc_fifo_Lock(fifo);
-    while (vlc_fifo_IsEmpty(fifo))
+    while ((block = vlc_fifo_DequeueUnlocked(fifo)) == NULL)
     {
         vlc_fifo_CleanupPush(fifo);
         vlc_fifo_Wait(fifo);
         vlc_cleanup_pop();
     }
-    block = vlc_fifo_DequeueUnlocked(fifo);
     vlc_fifo_Unlock(fifo);
 
     return block;
@@ -135,6 +264,12 @@ block_t *vlc_fifo_Show( block_fifo_t *p_fifo )
     block_t *b;
 
     vlc_fifo_Lock(p_fifo);
+    vlc_fifo_Spill(p_fifo);
+    /* The producer counts a block before it publishes it. If the caller saw
+     * that count, the block reaches the ring without waiting on anything. */
+    while (p_fifo->q.first == NULL && p_fifo->ring != NULL
+        && atomic_load_explicit(&p_fifo->i_depth, memory_order_relaxed) > 0)
+        vlc_fifo_Spill(p_fifo);
     assert(p_fifo->q.first != NULL);
     b = (block_t *)p_fifo->q.first;
     vlc_fifo_Unlock(p_fifo);
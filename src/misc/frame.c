@@ -39,7 +39,10 @@
 #include <vlc_frame.h>
 #include <vlc_fs.h>
 
+#include <vlc_tracer.h>
+
 #include "ancillary.h"
+#include "../libvlc.h"
 
 #ifndef NDEBUG
 static void vlc_frame_Check (vlc_frame_t *frame)
@@ -112,6 +115,199 @@ vlc_frame_t *vlc_frame_Init(vlc_frame_t *restrict f, const struct vlc_frame_call
 /** Initial reserved header and footer size. */
 #define VLC_FRAME_PADDING      32
 
+/*
+ * Frame recycling
+ *
+ * When enabled, small frames are taken from and given back to free lists,
+ * one per power of two size class, instead of going through the heap.
+ */
+#define VLC_FRAME_POOL_MIN_SHIFT 9 /* 512 bytes */
+#define VLC_FRAME_POOL_CLASSES   8 /* up to 64 KiB */
+#define VLC_FRAME_POOL_DEPTH     256 /* frames kept per class */
+
+struct vlc_frame_pool_class
+{
+    vlc_mutex_t lock;
+    vlc_frame_t *first;
+    unsigned count;
+};
+
+#define VLC_FRAME_POOL_CLASS { VLC_STATIC_MUTEX, NULL, 0 }
+
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned users;
+    atomic_bool enabled;
+    atomic_ullong hits;
+    atomic_ullong misses;
+    struct vlc_frame_pool_class classes[VLC_FRAME_POOL_CLASSES];
+} frame_pool = {
+    VLC_STATIC_MUTEX, 0, false, 0, 0,
+    {
+        VLC_FRAME_POOL_CLASS, VLC_FRAME_POOL_CLASS,
+        VLC_FRAME_POOL_CLASS, VLC_FRAME_POOL_CLASS,
+        VLC_FRAME_POOL_CLASS, VLC_FRAME_POOL_CLASS,
+        VLC_FRAME_POOL_CLASS, VLC_FRAME_POOL_CLASS,
+    },
+};
+
+static size_t vlc_frame_pool_Capacity(unsigned i)
+{
+    size_t capacity = (2 * VLC_FRAME_PADDING)
+                    + ((size_t)1 << (VLC_FRAME_POOL_MIN_SHIFT + i));
+#ifndef HAVE_ALIGNED_ALLOC
+    capacity += VLC_FRAME_ALIGN;
+#endif
+    return capacity;
+}
+
+static void vlc_frame_pool_Free(vlc_frame_t *frame)
+{
+    free(frame->p_start);
+    free(frame);
+}
+
+static void vlc_frame_pool_Release(vlc_frame_t *frame)
+{
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        if (frame->i_size != vlc_frame_pool_Capacity(i))
+            continue;
+
+        struct vlc_frame_pool_class *class = &frame_pool.classes[i];
+
+        vlc_mutex_lock(&class->lock);
+        if (atomic_load_explicit(&frame_pool.enabled, memory_order_relaxed)
+         && class->count < VLC_FRAME_POOL_DEPTH)
+        {
+            frame->p_next = class->first;
+            class->first = frame;
+            class->count++;
+            vlc_mutex_unlock(&class->lock);
+            return;
+        }
+        vlc_mutex_unlock(&class->lock);
+        break;
+    }
+
+    vlc_frame_pool_Free(frame);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_pool_cbs =
+{
+    vlc_frame_pool_Release,
+};
+
+static vlc_frame_t *vlc_frame_pool_Alloc(size_t size)
+{
+    unsigned i = 0;
+    while (size > ((size_t)1 << (VLC_FRAME_POOL_MIN_SHIFT + i)))
+        if (++i == VLC_FRAME_POOL_CLASSES)
+            return NULL;
+
+    struct vlc_frame_pool_class *class = &frame_pool.classes[i];
+
+    vlc_mutex_lock(&class->lock);
+    vlc_frame_t *f = class->first;
+    if (f != NULL)
+    {
+        class->first = f->p_next;
+        class->count--;
+    }
+    vlc_mutex_unlock(&class->lock);
+
+    unsigned char *buf;
+    if (f != NULL)
+    {
+        atomic_fetch_add_explicit(&frame_pool.hits, 1, memory_order_relaxed);
+        buf = f->p_start;
+        vlc_frame_Init(f, &vlc_frame_pool_cbs, buf, f->i_size);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&frame_pool.misses, 1, memory_order_relaxed);
+        size_t capacity = vlc_frame_pool_Capacity(i);
+#ifdef HAVE_ALIGNED_ALLOC
+        buf = aligned_alloc(VLC_FRAME_ALIGN, capacity);
+#else
+        buf = malloc(capacity);
+#endif
+        if (unlikely(buf == NULL))
+            return NULL;
+
+        f = vlc_frame_New(&vlc_frame_pool_cbs, buf, capacity);
+        if (unlikely(f == NULL))
+        {
+            free(buf);
+            return NULL;
+        }
+    }
+
+#ifndef HAVE_ALIGNED_ALLOC
+    buf += (-(uintptr_t)(void *)buf) % (uintptr_t)VLC_FRAME_ALIGN;
+#endif
+    f->p_buffer = buf + VLC_FRAME_PADDING;
+    f->i_buffer = size;
+    return f;
+}
+
+void vlc_frame_pool_Hold(void)
+{
+    vlc_mutex_lock(&frame_pool.lock);
+    if (frame_pool.users++ == 0)
+        atomic_store_explicit(&frame_pool.enabled, true, memory_order_relaxed);
+    vlc_mutex_unlock(&frame_pool.lock);
+}
+
+void vlc_frame_pool_Drop(vlc_object_t *obj)
+{
+    vlc_mutex_lock(&frame_pool.lock);
+    assert(frame_pool.users > 0);
+    if (--frame_pool.users > 0)
+    {
+        vlc_mutex_unlock(&frame_pool.lock);
+        return;
+    }
+
+    atomic_store_explicit(&frame_pool.enabled, false, memory_order_relaxed);
+
+    /* Frames released from now on go back to the heap */
+    for (unsigned i = 0; i < VLC_FRAME_POOL_CLASSES; i++)
+    {
+        struct vlc_frame_pool_class *class = &frame_pool.classes[i];
+
+        vlc_mutex_lock(&class->lock);
+        vlc_frame_t *f = class->first;
+        class->first = NULL;
+        class->count = 0;
+        vlc_mutex_unlock(&class->lock);
+
+        while (f != NULL)
+        {
+            vlc_frame_t *next = f->p_next;
+            vlc_frame_pool_Free(f);
+            f = next;
+        }
+    }
+
+    int64_t hits = atomic_exchange_explicit(&frame_pool.hits, 0,
+                                            memory_order_relaxed);
+    int64_t misses = atomic_exchange_explicit(&frame_pool.misses, 0,
+                                              memory_order_relaxed);
+    vlc_mutex_unlock(&frame_pool.lock);
+
+    msg_Dbg(obj, "frame pool: %" PRId64 " frames recycled, %" PRId64
+            " allocated", hits, misses);
+
+    struct vlc_tracer *tracer = vlc_object_get_tracer(obj);
+    if (tracer != NULL)
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "frame_pool"),
+                         VLC_TRACE("recycled", hits),
+                         VLC_TRACE("allocated", misses),
+                         VLC_TRACE_END);
+}
+
 vlc_frame_t *vlc_frame_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -120,6 +316,13 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
         return NULL;
     }
 
+    if (atomic_load_explicit(&frame_pool.enabled, memory_order_relaxed))
+    {
+        vlc_frame_t *f = vlc_frame_pool_Alloc(size);
+        if (f != NULL)
+            return f;
+    }
+
     static_assert ((VLC_FRAME_PADDING % VLC_FRAME_ALIGN) == 0,
                    "VLC_FRAME_PADDING must be a multiple of VLC_FRAME_ALIGN");
 
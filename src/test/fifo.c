@@ -0,0 +1,206 @@
+/*****************************************************************************
+ * fifo.c: Test for block FIFOs and their lock-free input
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_block.h>
+#include <vlc_tick.h>
+
+#ifdef BENCHMARK
+# define HANDOFFS 200000
+#else
+# define HANDOFFS 10000
+#endif
+
+static block_t *NewBlock(unsigned i, size_t size)
+{
+    block_t *block = block_Alloc(size);
+    assert(block != NULL);
+    block->i_dts = i;
+    return block;
+}
+
+static void test_fifo_accounting(void)
+{
+    block_fifo_t *fifo = vlc_fifo_New();
+    assert(fifo != NULL);
+
+    /* regular FIFOs have no lock-free input */
+    block_t *block = NewBlock(0, 10);
+    assert(!vlc_fifo_TryQueue(fifo, block, SIZE_MAX));
+    block_Release(block);
+    vlc_fifo_Delete(fifo);
+
+    fifo = vlc_fifo_NewSPSC();
+    assert(fifo != NULL);
+    assert(vlc_fifo_IsEmpty(fifo));
+
+    /* locked and lock-free inputs keep the order */
+    unsigned count = 0;
+    size_t bytes = 0;
+    for (unsigned i = 0; i < 40; i++)
+    {
+        block = NewBlock(i, i);
+        if (i % 3 == 0)
+            vlc_fifo_Put(fifo, block);
+        else
+            assert(vlc_fifo_TryQueue(fifo, block, SIZE_MAX));
+        count++;
+        bytes += i;
+    }
+    assert(!vlc_fifo_IsEmpty(fifo));
+
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_GetCount(fifo) == count);
+    assert(vlc_fifo_GetBytes(fifo) == bytes);
+    for (unsigned i = 0; i < 20; i++)
+    {
+        block = vlc_fifo_DequeueUnlocked(fifo);
+        assert(block != NULL && block->i_dts == i);
+        block_Release(block);
+        count--;
+        bytes -= i;
+    }
+    assert(vlc_fifo_GetCount(fifo) == count);
+    assert(vlc_fifo_GetBytes(fifo) == bytes);
+    vlc_fifo_Unlock(fifo);
+
+    /* the size limit applies to the whole queue */
+    block = NewBlock(40, 100);
+    assert(!vlc_fifo_TryQueue(fifo, block, bytes + 99));
+    assert(vlc_fifo_TryQueue(fifo, block, bytes + 100));
+
+    /* the ring is bounded, the caller keeps the block when it is full */
+    unsigned queued = 0;
+    for (;;)
+    {
+        block = NewBlock(41 + queued, 0);
+        if (!vlc_fifo_TryQueue(fifo, block, SIZE_MAX))
+        {
+            block_Release(block);
+            break;
+        }
+        queued++;
+    }
+    assert(queued > 0);
+
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_GetCount(fifo) == count + 1 + queued);
+    block = vlc_fifo_DequeueAllUnlocked(fifo);
+    assert(vlc_fifo_GetCount(fifo) == 0);
+    assert(vlc_fifo_GetBytes(fifo) == 0);
+    vlc_fifo_Unlock(fifo);
+    assert(vlc_fifo_IsEmpty(fifo));
+
+    unsigned i = 20;
+    for (block_t *b = block; b != NULL; b = b->p_next)
+        assert(b->i_dts == i++);
+    assert(i == 41 + queued);
+    block_ChainRelease(block);
+
+    vlc_fifo_Delete(fifo);
+}
+
+struct handoff
+{
+    block_fifo_t *fifo;
+    block_t **blocks;
+    bool lockfree;
+};
+
+static void *Producer(void *data)
+{
+    struct handoff *h = data;
+
+    for (unsigned i = 0; i < HANDOFFS; i++)
+    {
+        block_t *block = h->blocks[i];
+        if (!h->lockfree || !vlc_fifo_TryQueue(h->fifo, block, SIZE_MAX))
+            vlc_fifo_Put(h->fifo, block);
+    }
+    return NULL;
+}
+
+static vlc_tick_t test_fifo_handoff(bool lockfree)
+{
+    struct handoff h;
+
+    h.fifo = lockfree ? vlc_fifo_NewSPSC() : vlc_fifo_New();
+    assert(h.fifo != NULL);
+    h.lockfree = lockfree;
+    h.blocks = malloc(HANDOFFS * sizeof (*h.blocks));
+    assert(h.blocks != NULL);
+    for (unsigned i = 0; i < HANDOFFS; i++)
+        h.blocks[i] = NewBlock(i, 188);
+
+    vlc_tick_t start = vlc_tick_now();
+
+    vlc_thread_t th;
+    int ret = vlc_clone(&th, Producer, &h);
+    assert(ret == 0);
+
+    for (unsigned i = 0; i < HANDOFFS; i++)
+    {
+#ifndef BENCHMARK
+        if (i % 64 == 0)
+        {
+            /* a counted block may not be published yet */
+            while (vlc_fifo_IsEmpty(h.fifo));
+            assert(vlc_fifo_Show(h.fifo)->i_dts == i);
+        }
+#endif
+        block_t *block = vlc_fifo_Get(h.fifo);
+        assert(block->i_dts == i);
+        block_Release(block);
+    }
+
+    vlc_join(th, NULL);
+
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    assert(vlc_fifo_IsEmpty(h.fifo));
+    vlc_fifo_Delete(h.fifo);
+    free(h.blocks);
+    return duration;
+}
+
+int main(void)
+{
+    test_fifo_accounting();
+
+    vlc_tick_t locked = test_fifo_handoff(false);
+    vlc_tick_t lockfree = test_fifo_handoff(true);
+#ifdef BENCHMARK
+    printf("%d handoffs: locked %"PRId64" ns/block, lock-free %"PRId64
+           " ns/block\n", HANDOFFS,
+           NS_FROM_VLC_TICK(locked) / HANDOFFS,
+           NS_FROM_VLC_TICK(lockfree) / HANDOFFS);
+#else
+    VLC_UNUSED(locked); VLC_UNUSED(lockfree);
+#endif
+    return 0;
+}
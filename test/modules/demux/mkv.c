@@ -0,0 +1,378 @@
+/*****************************************************************************
+ * mkv.c: Matroska demuxer block reading test
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_block.h>
+#include <vlc_modules.h>
+
+#define BAILOUT(run) { fprintf(stderr, "failed %s line %d\n", run, __LINE__); \
+                        return 1; }
+#define EXPECT(foo) if(!(foo)) BAILOUT(run)
+
+#ifdef BENCHMARK
+/* about 100 MiB, so that the demuxer dominates the setup */
+# define VIDEO_FRAMES     2000
+# define VIDEO_FRAME_SIZE 50000
+#else
+# define VIDEO_FRAMES     60
+# define VIDEO_FRAME_SIZE 1000
+#endif
+#define FRAMES_PER_CLUSTER 25
+/* every third video frame is stored in a BlockGroup */
+#define GROUP_EVERY      3
+#define SUB_EVERY        10
+/* audio frames are stored in fixed-size laced blocks */
+#define AUDIO_LACE       4
+#define AUDIO_FRAME_SIZE 100
+
+struct writer
+{
+    uint8_t *p;
+    size_t   size;
+    size_t   alloc;
+};
+
+static void put(struct writer *w, const void *p, size_t size)
+{
+    if(w->size + size > w->alloc)
+    {
+        w->alloc = (w->size + size) * 2;
+        w->p = realloc(w->p, w->alloc);
+        assert(w->p);
+    }
+    memcpy(&w->p[w->size], p, size);
+    w->size += size;
+}
+
+static void put_id(struct writer *w, uint32_t id)
+{
+    uint8_t b[4];
+    size_t n = id > 0xFFFFFF ? 4 : id > 0xFFFF ? 3 : id > 0xFF ? 2 : 1;
+    for(size_t i = 0; i < n; i++)
+        b[i] = id >> (8 * (n - 1 - i));
+    put(w, b, n);
+}
+
+/* sizes are always coded on 8 bytes, and patched once known */
+static size_t start(struct writer *w, uint32_t id)
+{
+    put_id(w, id);
+    uint8_t b[8] = { 0x01 };
+    put(w, b, 8);
+    return w->size;
+}
+
+static void end(struct writer *w, size_t data)
+{
+    uint64_t size = w->size - data;
+    for(int i = 1; i < 8; i++)
+        w->p[data - 8 + i] = size >> (8 * (7 - i));
+}
+
+static void put_uint(struct writer *w, uint32_t id, uint64_t v)
+{
+    size_t data = start(w, id);
+    uint8_t b[8];
+    SetQWBE(b, v);
+    put(w, b, 8);
+    end(w, data);
+}
+
+static void put_string(struct writer *w, uint32_t id, const char *s)
+{
+    size_t data = start(w, id);
+    put(w, s, strlen(s));
+    end(w, data);
+}
+
+static void put_block(struct writer *w, uint32_t id, unsigned track,
+                      int16_t rel, uint8_t flags, const void *p, size_t size)
+{
+    size_t data = start(w, id);
+    uint8_t header[4] = { 0x80 | track, (uint16_t)rel >> 8, rel & 0xFF, flags };
+    put(w, header, 4);
+    put(w, p, size);
+    end(w, data);
+}
+
+static void fill_frame(uint8_t *p, size_t size, unsigned i)
+{
+    SetDWBE(p, i);
+    for(size_t j = 4; j < size; j++)
+        p[j] = i + j;
+}
+
+static void put_track(struct writer *w, unsigned num, unsigned type,
+                      const char *codec)
+{
+    size_t entry = start(w, 0xAE);
+    put_uint(w, 0xD7, num);    /* TrackNumber */
+    put_uint(w, 0x73C5, num);  /* TrackUID */
+    put_uint(w, 0x83, type);   /* TrackType */
+    put_string(w, 0x86, codec);
+    if(type == 1)
+    {
+        size_t video = start(w, 0xE0);
+        put_uint(w, 0xB0, 320);
+        put_uint(w, 0xBA, 240);
+        end(w, video);
+    }
+    end(w, entry);
+}
+
+static uint8_t *generate(size_t *size)
+{
+    struct writer w = { NULL, 0, 0 };
+    uint8_t frame[VIDEO_FRAME_SIZE];
+
+    size_t ebml = start(&w, 0x1A45DFA3);
+    put_uint(&w, 0x4286, 1);  /* EBMLVersion */
+    put_uint(&w, 0x42F7, 1);  /* EBMLReadVersion */
+    put_string(&w, 0x4282, "matroska");
+    put_uint(&w, 0x4287, 4);  /* DocTypeVersion */
+    put_uint(&w, 0x4285, 2);  /* DocTypeReadVersion */
+    end(&w, ebml);
+
+    size_t segment = start(&w, 0x18538067);
+
+    size_t info = start(&w, 0x1549A966);
+    put_uint(&w, 0x2AD7B1, 1000000); /* TimestampScale, 1ms */
+    end(&w, info);
+
+    size_t tracks = start(&w, 0x1654AE6B);
+    put_track(&w, 1, 0x01, "V_MPEG2");
+    put_track(&w, 2, 0x11, "S_TEXT/UTF8");
+    put_track(&w, 3, 0x02, "A_MPEG/L2");
+    end(&w, tracks);
+
+    size_t cluster = 0;
+    for(unsigned i = 0; i < VIDEO_FRAMES; i++)
+    {
+        if(i % FRAMES_PER_CLUSTER == 0)
+        {
+            if(cluster)
+                end(&w, cluster);
+            cluster = start(&w, 0x1F43B675);
+            put_uint(&w, 0xE7, i * 40);
+        }
+        const int16_t rel = (i % FRAMES_PER_CLUSTER) * 40;
+
+        fill_frame(frame, VIDEO_FRAME_SIZE, i);
+        if(i % GROUP_EVERY == GROUP_EVERY - 1)
+        {
+            size_t group = start(&w, 0xA0);
+            put_block(&w, 0xA1, 1, rel, 0x00, frame, VIDEO_FRAME_SIZE);
+            end(&w, group);
+        }
+        else
+            put_block(&w, 0xA3, 1, rel, i % FRAMES_PER_CLUSTER ? 0x00 : 0x80,
+                      frame, VIDEO_FRAME_SIZE);
+
+        /* fixed-size lacing: frame count - 1, then the frames */
+        uint8_t lace[1 + AUDIO_LACE * AUDIO_FRAME_SIZE];
+        lace[0] = AUDIO_LACE - 1;
+        for(unsigned j = 0; j < AUDIO_LACE; j++)
+            fill_frame(&lace[1 + j * AUDIO_FRAME_SIZE], AUDIO_FRAME_SIZE,
+                       i * AUDIO_LACE + j);
+        put_block(&w, 0xA3, 3, rel, 0x80 | 0x04, lace, sizeof(lace));
+
+        if(i % SUB_EVERY == 0)
+        {
+            char text[16];
+            snprintf(text, sizeof(text), "sub %u", i);
+            size_t group = start(&w, 0xA0);
+            put_block(&w, 0xA1, 2, rel, 0x00, text, strlen(text));
+            put_uint(&w, 0x9B, 1000); /* BlockDuration */
+            end(&w, group);
+        }
+    }
+    end(&w, cluster);
+    end(&w, segment);
+
+    *size = w.size;
+    return w.p;
+}
+
+struct results
+{
+    es_out_t out;
+    unsigned video;
+    unsigned audio;
+    unsigned subs;
+    bool     b_error;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in, const es_format_t *fmt)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    return (es_out_id_t *)(intptr_t)fmt->i_cat;
+}
+
+static bool CheckFrame(const block_t *p_block, size_t size, unsigned i)
+{
+    uint8_t frame[VIDEO_FRAME_SIZE];
+
+    fill_frame(frame, size, i);
+    return p_block->i_buffer == size && !memcmp(p_block->p_buffer, frame, size);
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *p_block)
+{
+    struct results *res = container_of(out, struct results, out);
+    switch((intptr_t)id)
+    {
+        case VIDEO_ES:
+            if(!CheckFrame(p_block, VIDEO_FRAME_SIZE, res->video) ||
+               p_block->i_pts != VLC_TICK_0 + VLC_TICK_FROM_MS(res->video * 40))
+                res->b_error = true;
+            res->video++;
+            break;
+        case AUDIO_ES:
+            if(!CheckFrame(p_block, AUDIO_FRAME_SIZE, res->audio))
+                res->b_error = true;
+            res->audio++;
+            break;
+        default:
+        {
+            char text[16];
+            snprintf(text, sizeof(text), "sub %u", res->subs * SUB_EVERY);
+            if(p_block->i_buffer < strlen(text) ||
+               memcmp(p_block->p_buffer, text, strlen(text)))
+                res->b_error = true;
+            res->subs++;
+        }
+    }
+    block_Release(p_block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query, va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    if(query == ES_OUT_GET_ES_STATE)
+    {
+        (void) va_arg(args, es_out_id_t *);
+        *va_arg(args, bool *) = true;
+    }
+    return VLC_SUCCESS;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+static int runtest(const char *run, libvlc_instance_t *vlc,
+                   const uint8_t *data, size_t datasz, bool seekable)
+{
+    struct results res = { .out = { .cbs = &es_out_cbs } };
+    stream_t *s;
+
+    if(seekable)
+        s = vlc_stream_MemoryNew(vlc->p_libvlc_int, (uint8_t *)data, datasz, true);
+    else
+    {
+        vlc_stream_fifo_t *fifo = vlc_stream_fifo_New(VLC_OBJECT(vlc->p_libvlc_int), &s);
+        EXPECT(fifo);
+        EXPECT(vlc_stream_fifo_Write(fifo, data, datasz) == (ssize_t)datasz);
+        vlc_stream_fifo_Close(fifo);
+    }
+    EXPECT(s);
+
+    demux_t *demux = demux_New(VLC_OBJECT(vlc->p_libvlc_int), "mkv",
+                               "vlc://nop", s, &res.out);
+    if(!demux)
+    {
+        vlc_stream_Delete(s);
+        BAILOUT(run);
+    }
+
+#ifdef BENCHMARK
+    vlc_tick_t start_time = vlc_tick_now();
+#endif
+
+    while(demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+
+#ifdef BENCHMARK
+    vlc_tick_t duration = vlc_tick_now() - start_time;
+    /* payloads are compared too, so this is a lower bound */
+    printf("%s: demuxed %zu MiB in %" PRId64 " ms, %.1f MiB/s\n", run,
+           datasz >> 20, MS_FROM_VLC_TICK(duration),
+           (double)datasz / (1 << 20) / ((double)duration / CLOCK_FREQ));
+#endif
+
+    demux_Delete(demux); /* also deletes the source stream */
+
+    EXPECT(!res.b_error);
+    EXPECT(res.video == VIDEO_FRAMES);
+    EXPECT(res.audio == VIDEO_FRAMES * AUDIO_LACE);
+    EXPECT(res.subs == VIDEO_FRAMES / SUB_EVERY);
+    return 0;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if(!vlc)
+        return 1;
+
+    if(!module_exists("mkv"))
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    size_t size;
+    uint8_t *data = generate(&size);
+
+    int ret = runtest("seekable", vlc, data, size, true);
+    if(ret == 0)
+        ret = runtest("non seekable", vlc, data, size, false);
+
+    free(data);
+    libvlc_release(vlc);
+    return ret;
+}
@@ -0,0 +1,728 @@
+/*****************************************************************************
+ * ts.c: MPEG-TS demuxer packet filtering test
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_block.h>
+#include <vlc_modules.h>
+#include <vlc_fs.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../../../modules/demux/mpeg/timestamps.h"
+#include "../../../modules/demux/mpeg/ts_pid.h"
+#include "../../../modules/demux/mpeg/ts_streams.h"
+#include "../../../modules/demux/mpeg/ts_streams_private.h"
+#include "../../../modules/demux/mpeg/ts.h"
+#include "../../../modules/demux/mpeg/ts_seekindex.h"
+
+const char vlc_module_name[] = "test_modules_demux_ts";
+
+#define BAILOUT(run) { fprintf(stderr, "failed %s line %d\n", run, __LINE__); \
+                        return 1; }
+#define EXPECT(foo) if(!(foo)) BAILOUT(run)
+
+/* about 400 packets: 2 programs with 6 packets per frame, and padding */
+#define PROGRAMS         2
+#define FRAMES           24
+#define FRAME_SIZE       1000
+#define NULLS_PER_FRAME  4
+#define PSI_EVERY        8
+
+#define PMT_PID(prg)     (0x100 + (prg))
+#define VIDEO_PID(prg)   (0x200 + (prg))
+
+struct mux
+{
+    uint8_t *p;
+    size_t   size;
+    size_t   alloc;
+    uint8_t  cc[8192];
+};
+
+static uint8_t *put_packet(struct mux *m)
+{
+    if(m->size + 188 > m->alloc)
+    {
+        m->alloc = (m->size + 188) * 2;
+        m->p = realloc(m->p, m->alloc);
+        assert(m->p);
+    }
+    m->size += 188;
+    return &m->p[m->size - 188];
+}
+
+static void put_null(struct mux *m)
+{
+    uint8_t *pkt = put_packet(m);
+    pkt[0] = 0x47;
+    pkt[1] = 0x1F;
+    pkt[2] = 0xFF;
+    pkt[3] = 0x10;
+    memset(&pkt[4], 0xFF, 184);
+}
+
+/* splits a payload unit into packets, with a PCR on the first one if set */
+static void packetize(struct mux *m, uint16_t pid, const uint8_t *p, size_t size,
+                      int64_t pcr)
+{
+    bool b_start = true;
+    while(size > 0)
+    {
+        uint8_t *pkt = put_packet(m);
+        const bool b_pcr = b_start && pcr >= 0;
+        size_t af = b_pcr ? 8 : 0; /* adaptation field with its length byte */
+        size_t room = 184 - af;
+        if(size < room)
+        {
+            af += room - size;
+            room = size;
+        }
+
+        pkt[0] = 0x47;
+        pkt[1] = (b_start ? 0x40 : 0x00) | (pid >> 8);
+        pkt[2] = pid & 0xFF;
+        pkt[3] = (af ? 0x30 : 0x10) | (m->cc[pid]++ & 0x0F);
+        if(af)
+        {
+            pkt[4] = af - 1;
+            if(af > 1)
+            {
+                pkt[5] = b_pcr ? 0x10 : 0x00;
+                memset(&pkt[6], 0xFF, af - 2);
+            }
+            if(b_pcr)
+            {
+                pkt[6] = pcr >> 25;
+                pkt[7] = pcr >> 17;
+                pkt[8] = pcr >> 9;
+                pkt[9] = pcr >> 1;
+                pkt[10] = ((pcr & 1) << 7) | 0x7E;
+                pkt[11] = 0x00;
+            }
+        }
+        memcpy(&pkt[4 + af], p, room);
+
+        p += room;
+        size -= room;
+        b_start = false;
+    }
+}
+
+static uint32_t crc32_mpeg(const uint8_t *p, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for(size_t i = 0; i < size; i++)
+    {
+        crc ^= (uint32_t)p[i] << 24;
+        for(int j = 0; j < 8; j++)
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+    }
+    return crc;
+}
+
+/* pointer field, section header, body and CRC */
+static void put_section(struct mux *m, uint16_t pid, uint8_t table_id,
+                        uint16_t extension, const uint8_t *body, size_t size)
+{
+    uint8_t section[1 + 8 + 64 + 4];
+    assert(size <= 64);
+    const size_t length = 5 + size + 4;
+    section[0] = 0x00;
+    section[1] = table_id;
+    section[2] = 0xB0 | (length >> 8);
+    section[3] = length & 0xFF;
+    section[4] = extension >> 8;
+    section[5] = extension & 0xFF;
+    section[6] = 0xC1; /* version 0, current */
+    section[7] = 0x00;
+    section[8] = 0x00;
+    memcpy(&section[9], body, size);
+    SetDWBE(&section[9 + size], crc32_mpeg(&section[1], 8 + size));
+    packetize(m, pid, section, 1 + 8 + size + 4, -1);
+}
+
+static void put_psi(struct mux *m)
+{
+    uint8_t body[PROGRAMS * 4];
+    for(unsigned i = 0; i < PROGRAMS; i++)
+    {
+        SetWBE(&body[i * 4], i + 1);
+        SetWBE(&body[i * 4 + 2], 0xE000 | PMT_PID(i + 1));
+    }
+    put_section(m, 0x00, 0x00, 1, body, sizeof(body));
+
+    for(unsigned i = 1; i <= PROGRAMS; i++)
+    {
+        uint8_t pmt[9];
+        SetWBE(&pmt[0], 0xE000 | VIDEO_PID(i)); /* PCR PID */
+        SetWBE(&pmt[2], 0xF000);
+        pmt[4] = 0x02; /* MPEG-2 video */
+        SetWBE(&pmt[5], 0xE000 | VIDEO_PID(i));
+        SetWBE(&pmt[7], 0xF000);
+        put_section(m, PMT_PID(i), 0x02, i, pmt, sizeof(pmt));
+    }
+}
+
+static void put_timestamp(uint8_t *p, uint8_t prefix, int64_t ts)
+{
+    p[0] = (prefix << 4) | ((ts >> 29) & 0x0E) | 0x01;
+    p[1] = ts >> 22;
+    p[2] = ((ts >> 14) & 0xFE) | 0x01;
+    p[3] = ts >> 7;
+    p[4] = ((ts << 1) & 0xFE) | 0x01;
+}
+
+static void fill_frame(uint8_t *p, unsigned prg, unsigned i)
+{
+    SetDWBE(p, i);
+    SetDWBE(p + 4, prg);
+    for(size_t j = 8; j < FRAME_SIZE; j++)
+        p[j] = i + prg + j;
+}
+
+static uint8_t *generate(size_t *size)
+{
+    struct mux *m = calloc(1, sizeof(*m));
+    assert(m);
+    uint8_t *pes = malloc(19 + FRAME_SIZE);
+    assert(pes);
+
+    for(unsigned i = 0; i < FRAMES; i++)
+    {
+        if(i % PSI_EVERY == 0)
+            put_psi(m);
+
+        const int64_t dts = 90000 + i * 3600;
+        for(unsigned prg = 1; prg <= PROGRAMS; prg++)
+        {
+            static const uint8_t header[9] =
+                { 0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0xC0, 10 };
+            memcpy(pes, header, 9);
+            put_timestamp(&pes[9], 0x03, dts + 3600);
+            put_timestamp(&pes[14], 0x01, dts);
+            fill_frame(&pes[19], prg, i);
+            packetize(m, VIDEO_PID(prg), pes, 19 + FRAME_SIZE, dts - 9000);
+        }
+
+        for(unsigned j = 0; j < NULLS_PER_FRAME; j++)
+            put_null(m);
+    }
+
+    free(pes);
+    uint8_t *p = m->p;
+    *size = m->size;
+    free(m);
+    return p;
+}
+
+struct results
+{
+    es_out_t out;
+    unsigned frames[PROGRAMS + 1];
+    unsigned next[PROGRAMS + 1]; /* expected frame index, 0 before the first */
+    bool     b_error;
+    uint8_t *frame;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in, const es_format_t *fmt)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    if(fmt->i_group < 1 || fmt->i_group > PROGRAMS)
+        return NULL;
+    return (es_out_id_t *)(intptr_t)fmt->i_group;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *p_block)
+{
+    struct results *res = container_of(out, struct results, out);
+    const unsigned prg = (intptr_t)id;
+    const unsigned i = p_block->i_buffer >= 4 ? GetDWBE(p_block->p_buffer) : 0;
+    /* a program selected late starts at any frame, but none may be missed */
+    if(res->next[prg] != 0 && i != res->next[prg])
+        res->b_error = true;
+    fill_frame(res->frame, prg, i);
+    if(p_block->i_buffer != FRAME_SIZE ||
+       memcmp(p_block->p_buffer, res->frame, FRAME_SIZE))
+        res->b_error = true;
+    res->frames[prg]++;
+    res->next[prg] = i + 1;
+    block_Release(p_block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query, va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    if(query == ES_OUT_GET_ES_STATE)
+    {
+        (void) va_arg(args, es_out_id_t *);
+        *va_arg(args, bool *) = true;
+    }
+    return VLC_SUCCESS;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/* counts the continuity errors reported by the demuxer */
+static void LogCallback(void *data, int level, const libvlc_log_t *ctx,
+                        const char *fmt, va_list args)
+{
+    VLC_UNUSED(ctx); VLC_UNUSED(args);
+    unsigned *discontinuities = data;
+    if(level == LIBVLC_WARNING && strstr(fmt, "discontinuity received"))
+        (*discontinuities)++;
+}
+
+enum selection
+{
+    SELECT_ALL,
+    SELECT_FIRST,
+    SELECT_FIRST_THEN_ALL, /* the second program is skipped, then selected */
+};
+
+static int runtest(const char *run, libvlc_instance_t *vlc,
+                   const uint8_t *data, size_t datasz, enum selection sel,
+                   bool b_thread)
+{
+    struct results res = { .out = { .cbs = &es_out_cbs } };
+    res.frame = malloc(FRAME_SIZE);
+    EXPECT(res.frame);
+
+    unsigned discontinuities = 0;
+    libvlc_log_set(vlc, LogCallback, &discontinuities);
+
+    /* with an output thread, blocks are sent from the worker */
+    var_SetBool(vlc->p_libvlc_int, "ts-output-thread", b_thread);
+
+    stream_t *s = vlc_stream_MemoryNew(vlc->p_libvlc_int, (uint8_t *)data, datasz, true);
+    EXPECT(s);
+
+    demux_t *demux = demux_New(VLC_OBJECT(vlc->p_libvlc_int), "ts",
+                               "vlc://nop", s, &res.out);
+    if(!demux)
+    {
+        vlc_stream_Delete(s);
+        free(res.frame);
+        libvlc_log_unset(vlc);
+        BAILOUT(run);
+    }
+
+    if(sel == SELECT_ALL)
+    {
+        demux_Control(demux, DEMUX_SET_GROUP_ALL);
+    }
+    else
+    {
+        const int first = 1;
+        demux_Control(demux, DEMUX_SET_GROUP_LIST, (size_t)1, &first);
+    }
+
+    bool b_switched = false;
+    while(demux_Demux(demux) == VLC_DEMUXER_SUCCESS)
+    {
+        if(sel == SELECT_FIRST_THEN_ALL && !b_switched &&
+           vlc_stream_Tell(s) >= datasz / 2)
+        {
+            demux_Control(demux, DEMUX_SET_GROUP_ALL);
+            b_switched = true;
+        }
+    }
+
+    demux_Delete(demux); /* also deletes the source stream */
+    free(res.frame);
+    libvlc_log_unset(vlc);
+
+    EXPECT(!res.b_error);
+    /* the CC of skipped packets must be tracked for later selections */
+    EXPECT(discontinuities == 0);
+
+    /* the last PES is only complete on the next unit start */
+    EXPECT(res.frames[1] >= FRAMES - 1);
+    switch(sel)
+    {
+        case SELECT_ALL:
+            EXPECT(res.frames[2] >= FRAMES - 1);
+            break;
+        case SELECT_FIRST:
+            EXPECT(res.frames[2] == 0);
+            break;
+        case SELECT_FIRST_THEN_ALL:
+            EXPECT(b_switched);
+            EXPECT(res.frames[2] > 0 && res.frames[2] < FRAMES);
+            EXPECT(res.next[2] >= FRAMES - 1);
+            break;
+    }
+    return 0;
+}
+
+/*****************************************************************************
+ * Seek index
+ *****************************************************************************/
+#define INDEX_STREAM_SIZE 100000
+#define SECOND            INT64_C(90000)
+
+static void InitProgram(ts_pmt_t *pmt, int number, stime_t first)
+{
+    memset(pmt, 0, sizeof(*pmt));
+    pmt->i_number = number;
+    pmt->pcr.i_first = first;
+    ARRAY_INIT(pmt->seekpoints);
+}
+
+static int test_seekindex_points(void)
+{
+    const char *run = "seek index points";
+    const ts_seek_point_t *prev, *next;
+    ts_pmt_t pmt;
+    InitProgram(&pmt, 1, 0);
+
+    /* one point per second, inserted out of order */
+    for(unsigned i = 0; i < 10; i += 2)
+        ts_seekindex_Insert(&pmt, i * SECOND, i * 1000, false);
+    for(unsigned i = 1; i < 10; i += 2)
+        ts_seekindex_Insert(&pmt, i * SECOND, i * 1000, false);
+    EXPECT(pmt.seekpoints.i_size == 10);
+    for(int i = 0; i < 10; i++)
+        EXPECT(pmt.seekpoints.p_elems[i].i_pcr == i * SECOND);
+
+    /* too close to another point, or going backwards */
+    ts_seekindex_Insert(&pmt, SECOND + SECOND / 10, 1100, false);
+    ts_seekindex_Insert(&pmt, 10 * SECOND, 500, false);
+    EXPECT(pmt.seekpoints.i_size == 10);
+
+    ts_seekindex_Lookup(&pmt, 3 * SECOND + 1, &prev, &next);
+    EXPECT(prev && prev->i_pcr == 3 * SECOND && prev->i_pos == 3000);
+    EXPECT(next && next->i_pcr == 4 * SECOND);
+    ts_seekindex_Lookup(&pmt, -1, &prev, &next);
+    EXPECT(!prev && next == &pmt.seekpoints.p_elems[0]);
+    ts_seekindex_Lookup(&pmt, 20 * SECOND, &prev, &next);
+    EXPECT(prev == &pmt.seekpoints.p_elems[9] && !next);
+
+    /* random access points replace close regular points only */
+    ts_seekindex_Insert(&pmt, 5 * SECOND + SECOND / 10, 5100, true);
+    EXPECT(pmt.seekpoints.i_size == 10);
+    EXPECT(pmt.seekpoints.p_elems[5].b_rai);
+    EXPECT(pmt.seekpoints.p_elems[5].i_pos == 5100);
+    ts_seekindex_Insert(&pmt, 5 * SECOND + SECOND / 5, 5200, true);
+    EXPECT(pmt.seekpoints.i_size == 10);
+    EXPECT(pmt.seekpoints.p_elems[5].i_pos == 5100);
+
+    /* the last random access point played through before a target */
+    ts_seekindex_Lookup(&pmt, 7 * SECOND + 1, &prev, &next);
+    EXPECT(ts_seekindex_LookupRAI(&pmt, prev, 2 * SECOND, 5 * SECOND)
+           == &pmt.seekpoints.p_elems[5]);
+    EXPECT(!ts_seekindex_LookupRAI(&pmt, prev, 2 * SECOND, SECOND));
+    EXPECT(!ts_seekindex_LookupRAI(&pmt, prev, SECOND / 2, 5 * SECOND));
+    ts_seekindex_Lookup(&pmt, 3 * SECOND + 1, &prev, &next);
+    EXPECT(!ts_seekindex_LookupRAI(&pmt, prev, 2 * SECOND, 5 * SECOND));
+
+    ARRAY_RESET(pmt.seekpoints);
+    return 0;
+}
+
+static demux_t *NewIndexDemux(libvlc_instance_t *vlc, uint8_t *data)
+{
+    demux_t *demux = vlc_object_create(vlc->p_libvlc_int, sizeof(*demux));
+    assert(demux);
+    demux->p_sys = calloc(1, sizeof(demux_sys_t));
+    assert(demux->p_sys);
+    demux_sys_t *sys = demux->p_sys;
+    sys->b_canseek = true;
+
+    demux->s = vlc_stream_MemoryNew(demux, data, INDEX_STREAM_SIZE, true);
+    assert(demux->s);
+    demux->s->psz_url = strdup("file:///seekindex.ts");
+    return demux;
+}
+
+static void DeleteIndexDemux(demux_t *demux)
+{
+    vlc_stream_Delete(demux->s);
+    free(demux->p_sys);
+    vlc_object_delete(demux);
+}
+
+/* returns the only index file of the cache directory */
+static char *FindIndexFile(const char *cachedir)
+{
+    char *dirpath, *path = NULL;
+    if(asprintf(&dirpath, "%s/vlc/ts", cachedir) == -1)
+        return NULL;
+    vlc_DIR *dir = vlc_opendir(dirpath);
+    if(dir)
+    {
+        const char *name;
+        while((name = vlc_readdir(dir)) != NULL)
+        {
+            if(name[0] == '.')
+                continue;
+            if(path != NULL) /* not the only one */
+            {
+                free(path);
+                path = NULL;
+                break;
+            }
+            if(asprintf(&path, "%s/%s", dirpath, name) == -1)
+            {
+                path = NULL;
+                break;
+            }
+        }
+        vlc_closedir(dir);
+    }
+    free(dirpath);
+    return path;
+}
+
+static void WriteFile(const char *path, const uint8_t *p, size_t size)
+{
+    FILE *file = vlc_fopen(path, "wb");
+    assert(file);
+    assert(fwrite(p, 1, size, file) == size);
+    fclose(file);
+}
+
+/* corrupts a copy of a valid index file with two programs of 4 points */
+static size_t CorruptIndex(uint8_t *p, size_t size, unsigned i)
+{
+    /* magic, program count, program header, then { pcr, pos } points */
+    uint8_t *point = &p[8 + 4 + 16];
+    switch(i)
+    {
+        case 0: p[0] ^= 0xFF; break;                        /* magic */
+        case 1: return size - 1;                            /* truncated */
+        case 2: return size + 1;                            /* trailing data */
+        case 3: SetDWBE(&p[8], 3); break;                   /* programs */
+        case 4: SetDWBE(&p[8 + 4 + 12], 1000); break;       /* points */
+        case 5: SetQWBE(&point[16], GetQWBE(point)); break; /* time order */
+        case 6: SetQWBE(&point[24], GetQWBE(&point[8])); break; /* positions */
+        case 7: SetQWBE(&point[3 * 16 + 8], INDEX_STREAM_SIZE); break; /* past the end */
+        case 8: SetQWBE(point, UINT64_C(1) << 63); break;   /* negative time */
+        default: return 0;
+    }
+    return size;
+}
+
+static int test_seekindex_file(libvlc_instance_t *vlc, const char *cachedir)
+{
+    const char *run = "seek index file";
+    uint8_t *data = calloc(1, INDEX_STREAM_SIZE);
+    EXPECT(data);
+    demux_t *demux = NewIndexDemux(vlc, data);
+
+    ts_pmt_t pmts[2];
+    ts_pid_t pids[2] = { { .u.p_pmt = &pmts[0] }, { .u.p_pmt = &pmts[1] } };
+    ts_pat_t pat = { 0 };
+    ARRAY_INIT(pat.programs);
+    for(int i = 0; i < 2; i++)
+    {
+        InitProgram(&pmts[i], i + 1, (i + 1) * SECOND);
+        ARRAY_APPEND(pat.programs, &pids[i]);
+    }
+
+    /* nothing saved yet */
+    struct ts_seekindex_t *index = ts_seekindex_New(demux);
+    EXPECT(index);
+    for(int i = 0; i < 2; i++)
+    {
+        ts_seekindex_Merge(index, &pmts[i]);
+        EXPECT(pmts[i].seekpoints.i_size == 0);
+        for(unsigned j = 0; j < 4; j++)
+            ts_seekindex_Insert(&pmts[i], j * SECOND, (i + 1) * 10000 + j * 1000,
+                                j % 2 == 0);
+    }
+    ts_seekindex_Delete(demux, index, &pat);
+
+    char *path = FindIndexFile(cachedir);
+    EXPECT(path);
+    /* copied, as the file is rewritten below */
+    block_t *block = block_FilePath(path, false);
+    EXPECT(block);
+    const size_t saved_size = block->i_buffer;
+    uint8_t *saved = malloc(saved_size);
+    EXPECT(saved);
+    memcpy(saved, block->p_buffer, saved_size);
+    block_Release(block);
+
+    /* merged on the next open, when the first PCR matches */
+    index = ts_seekindex_New(demux);
+    EXPECT(index);
+    for(int i = 0; i < 2; i++)
+    {
+        ts_pmt_t pmt;
+        InitProgram(&pmt, i + 1, (i + 1) * SECOND);
+        ts_seekindex_Merge(index, &pmt);
+        EXPECT(pmt.seekpoints.i_size == 4);
+        for(int j = 0; j < 4; j++)
+        {
+            const ts_seek_point_t *a = &pmt.seekpoints.p_elems[j];
+            const ts_seek_point_t *b = &pmts[i].seekpoints.p_elems[j];
+            EXPECT(a->i_pcr == b->i_pcr && a->i_pos == b->i_pos &&
+                   a->b_rai == b->b_rai);
+        }
+        ARRAY_RESET(pmt.seekpoints);
+
+        InitProgram(&pmt, i + 1, 0);
+        ts_seekindex_Merge(index, &pmt);
+        EXPECT(pmt.seekpoints.i_size == 0);
+    }
+    ts_seekindex_Delete(demux, index, NULL);
+
+    /* invalid files are ignored and removed */
+    uint8_t *copy = malloc(saved_size + 1);
+    EXPECT(copy);
+    for(unsigned i = 0; ; i++)
+    {
+        memcpy(copy, saved, saved_size);
+        copy[saved_size] = 0;
+        size_t size = CorruptIndex(copy, saved_size, i);
+        if(size == 0)
+            break;
+        WriteFile(path, copy, size);
+
+        index = ts_seekindex_New(demux);
+        EXPECT(index);
+        ts_pmt_t pmt;
+        InitProgram(&pmt, 1, SECOND);
+        ts_seekindex_Merge(index, &pmt);
+        ts_seekindex_Delete(demux, index, NULL);
+
+        struct stat st;
+        EXPECT(pmt.seekpoints.i_size == 0);
+        EXPECT(vlc_stat(path, &st) != 0);
+    }
+
+    free(copy);
+    free(saved);
+    free(path);
+    for(int i = 0; i < 2; i++)
+        ARRAY_RESET(pmts[i].seekpoints);
+    ARRAY_RESET(pat.programs);
+    DeleteIndexDemux(demux);
+    free(data);
+    return 0;
+}
+
+static int test_seekindex(libvlc_instance_t *vlc)
+{
+    char cachedir[] = "/tmp/vlc-test-ts-XXXXXX";
+    if(mkdtemp(cachedir) == NULL)
+        return 1;
+    setenv("XDG_CACHE_HOME", cachedir, 1);
+
+    var_Create(vlc->p_libvlc_int, "ts-seek-index-cache", VLC_VAR_BOOL);
+    var_SetBool(vlc->p_libvlc_int, "ts-seek-index-cache", true);
+
+    int ret = test_seekindex_points();
+    if(ret == 0)
+        ret = test_seekindex_file(vlc, cachedir);
+
+    char *path = FindIndexFile(cachedir);
+    if(path)
+        vlc_unlink(path);
+    free(path);
+    char *dir;
+    if(asprintf(&dir, "%s/vlc/ts", cachedir) != -1)
+    {
+        rmdir(dir);
+        dir[strlen(dir) - 3] = '\0';
+        rmdir(dir);
+        free(dir);
+    }
+    rmdir(cachedir);
+    return ret;
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if(!vlc)
+        return 1;
+
+    if(test_seekindex(vlc))
+    {
+        libvlc_release(vlc);
+        return 1;
+    }
+
+    if(!module_exists("ts"))
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    var_Create(vlc->p_libvlc_int, "ts-output-thread", VLC_VAR_BOOL);
+
+    size_t size;
+    uint8_t *data = generate(&size);
+
+    static const struct
+    {
+        const char *run;
+        enum selection sel;
+        bool b_thread;
+    } runs[] = {
+        { "all programs",                 SELECT_ALL,            false },
+        { "one program",                  SELECT_FIRST,          false },
+        { "late selection",               SELECT_FIRST_THEN_ALL, false },
+        { "all programs, output thread",  SELECT_ALL,            true },
+        { "one program, output thread",   SELECT_FIRST,          true },
+        { "late selection, output thread", SELECT_FIRST_THEN_ALL, true },
+    };
+
+    int ret = 0;
+    for(size_t i = 0; i < ARRAY_SIZE(runs) && ret == 0; i++)
+        ret = runtest(runs[i].run, vlc, data, size, runs[i].sel,
+                      runs[i].b_thread);
+
+    free(data);
+    libvlc_release(vlc);
+    return ret;
+}
@@ -49,6 +49,7 @@ struct reader
         stream_t *s;
     } u;
     void *p_data;
+    struct slow_source *p_source;
 
     void        (*pf_close)( struct reader * );
     uint64_t    (*pf_getsize)( struct reader * );
@@ -183,25 +184,29 @@ stream_close( struct reader *p_reader )
     free( p_reader );
 }
 
+static const char * const stream_argv[] = {
+    "-v",
+    "--ignore-config",
+    "-I",
+    "dummy",
+    "--no-media-library",
+    "--vout=dummy",
+    "--aout=dummy",
+    /* Smaller than the test file, so that seeks discard prefetched data */
+    "--prefetch-buffer-size=64",
+    "--prefetch-seek-retain=16",
+};
+
 static struct reader *
 stream_open( const char *psz_url )
 {
     libvlc_instance_t *p_vlc;
     struct reader *p_reader;
-    const char * argv[] = {
-        "-v",
-        "--ignore-config",
-        "-I",
-        "dummy",
-        "--no-media-library",
-        "--vout=dummy",
-        "--aout=dummy",
-    };
 
     p_reader = calloc( 1, sizeof(struct reader) );
     assert( p_reader );
 
-    p_vlc = libvlc_new( ARRAY_SIZE(argv), argv );
+    p_vlc = libvlc_new( ARRAY_SIZE(stream_argv), stream_argv );
     assert( p_vlc != NULL );
 
     p_reader->u.s = vlc_stream_NewURL( p_vlc->p_libvlc_int, psz_url );
@@ -222,6 +227,123 @@ stream_open( const char *psz_url )
     return p_reader;
 }
 
+#ifndef TEST_NET
+/* Seekable file source reporting slow seeks, as network accesses do */
+struct slow_source
+{
+    FILE *f;
+    uint64_t i_size;
+    unsigned int i_reads;
+};
+
+static ssize_t
+slow_source_read( stream_t *s, void *p_buf, size_t i_len )
+{
+    struct slow_source *p_src = s->p_sys;
+
+    p_src->i_reads++;
+    return fread( p_buf, 1, i_len, p_src->f );
+}
+
+static int
+slow_source_seek( stream_t *s, uint64_t i_offset )
+{
+    struct slow_source *p_src = s->p_sys;
+
+    return fseek( p_src->f, (long) i_offset, SEEK_SET ) ? VLC_EGENERIC
+                                                        : VLC_SUCCESS;
+}
+
+static int
+slow_source_control( stream_t *s, int i_query, va_list args )
+{
+    struct slow_source *p_src = s->p_sys;
+
+    switch( i_query )
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg( args, bool * ) = true;
+            break;
+        case STREAM_CAN_FASTSEEK:
+            *va_arg( args, bool * ) = false;
+            break;
+        case STREAM_GET_SIZE:
+            *va_arg( args, uint64_t * ) = p_src->i_size;
+            break;
+        case STREAM_GET_PTS_DELAY:
+            *va_arg( args, vlc_tick_t * ) = DEFAULT_PTS_DELAY;
+            break;
+        case STREAM_SET_PAUSE_STATE:
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void
+slow_source_destroy( stream_t *s )
+{
+    struct slow_source *p_src = s->p_sys;
+
+    fclose( p_src->f );
+    free( p_src );
+}
+
+static struct reader *
+filter_open( const char *psz_file, const char *psz_filter )
+{
+    libvlc_instance_t *p_vlc;
+    struct reader *p_reader;
+    struct slow_source *p_src;
+    struct stat st;
+    stream_t *p_source;
+
+    p_reader = calloc( 1, sizeof(struct reader) );
+    assert( p_reader );
+    p_src = malloc( sizeof(*p_src) );
+    assert( p_src );
+
+    p_src->f = fopen( psz_file, "r" );
+    assert( p_src->f );
+    assert( fstat( fileno( p_src->f ), &st ) != -1 );
+    p_src->i_size = st.st_size;
+    p_src->i_reads = 0;
+
+    p_vlc = libvlc_new( ARRAY_SIZE(stream_argv), stream_argv );
+    assert( p_vlc != NULL );
+
+    p_source = vlc_stream_CommonNew( VLC_OBJECT(p_vlc->p_libvlc_int),
+                                     slow_source_destroy );
+    assert( p_source );
+    p_source->p_sys = p_src;
+    p_source->pf_read = slow_source_read;
+    p_source->pf_seek = slow_source_seek;
+    p_source->pf_control = slow_source_control;
+
+    p_reader->u.s = vlc_stream_FilterNew( p_source, psz_filter );
+    if( !p_reader->u.s )
+    {
+        vlc_stream_Delete( p_source );
+        libvlc_release( p_vlc );
+        free( p_reader );
+        return NULL;
+    }
+    p_reader->pf_close = stream_close;
+    p_reader->pf_getsize = stream_getsize;
+    p_reader->pf_read = stream_read;
+    p_reader->pf_peek = stream_peek;
+    p_reader->pf_tell = stream_tell;
+    p_reader->pf_seek = stream_seek;
+    p_reader->p_data = p_vlc;
+    p_reader->p_source = p_src;
+    p_reader->psz_name = psz_filter;
+    return p_reader;
+}
+#endif
+
 static ssize_t
 read_at( struct reader **pp_readers, unsigned int i_readers,
          void *p_buf, uint64_t i_offset,
@@ -343,6 +465,23 @@ test( struct reader **pp_readers, unsigned int i_readers, const char *psz_md5 )
 }
 
 #ifndef TEST_NET
+static void
+test_oscillating_seeks( struct reader **pp_readers, unsigned int i_readers )
+{
+    uint8_t p_buf[4096];
+    uint64_t i_size = pp_readers[0]->pf_getsize( pp_readers[0] );
+
+    /* Probe the head, the tail and the middle back and forth, as demuxers
+     * looking for headers and indexes do */
+    for( unsigned int i = 0; i < 8; ++i )
+    {
+        read_at( pp_readers, i_readers, p_buf, 0, 4096, i_size );
+        read_at( pp_readers, i_readers, p_buf, i_size - 4096, 4096, i_size );
+        read_at( pp_readers, i_readers, p_buf, i_size / 2 + 8 * i, 42, i_size );
+        read_at( pp_readers, i_readers, p_buf, 4096 + i, 100, i_size );
+    }
+}
+
 static void
 fill_rand( int i_fd, size_t i_size )
 {
@@ -390,10 +529,26 @@ main( void )
     assert( ( pp_readers[0] = libc_open( psz_tmp_path ) ) );
     assert( ( pp_readers[1] = stream_open( psz_url ) ) );
 
+    test( pp_readers, 2, NULL );
+    pp_readers[1]->pf_close( pp_readers[1] );
+    free( psz_url );
+
+    test_log( "Testing random file with libc, and rangecache...\n" );
+    assert( ( pp_readers[1] = filter_open( psz_tmp_path, "rangecache" ) ) );
+    test_oscillating_seeks( pp_readers, 2 );
+    /* Every range is cached now, seeking back does not hit the source */
+    unsigned int i_reads = pp_readers[1]->p_source->i_reads;
+    test_oscillating_seeks( pp_readers, 2 );
+    assert( pp_readers[1]->p_source->i_reads == i_reads );
+    test( pp_readers, 2, NULL );
+    pp_readers[1]->pf_close( pp_readers[1] );
+
+    test_log( "Testing random file with libc, and prefetch...\n" );
+    assert( ( pp_readers[1] = filter_open( psz_tmp_path, "prefetch" ) ) );
+    test_oscillating_seeks( pp_readers, 2 );
     test( pp_readers, 2, NULL );
     for( unsigned int i = 0; i < 2; ++i )
         pp_readers[i]->pf_close( pp_readers[i] );
-    free( psz_url );
 
     close( i_tmp_fd );
 #else